@@ -1,20 +1,21 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <unistd.h>
 #include "src/contexts.h"
 #include "src/utils.h"
 #include "src/random.h"
 #include "src/dec.h"
 #include "src/gf4_matrix.h"
+#include "src/gjs.h"
 
-#define IS_ALPHA_MULT_RIGHT(a, b) ((1 == a && 2 == b) || (2 == a && 3 == b) || (3 == a && 1 == b))
-#define IS_ALPHA_MULT_LEFT(a, b) ((2 == a && 1 == b) || (3 == a && 2 == b) || (1 == a && 3 == b))
 #define ABS_DIFF(a, b) ((a > b) ? a - (b) : b - (a))
 
 const size_t block_size =  2339; // 2293;
 const size_t num_errors = 84; // 96;
 const size_t block_weight = 37;
 size_t M = 1000;
+size_t num_threads = 1; // threads used by the spectrum collection and the linear algebra of the key reconstruction
 
 // compare two size_t values; used for qsort
 int compare_func(const void * a, const void * b) {
@@ -88,53 +89,8 @@ void gen_keys(const char * keys_fname, const char * mults_fname) {
     free(mults_diff);
 }
 
-void collect_syndrome_weights(const size_t id) {
-    size_t half_block_size = (block_size / 2) + 1; // half of the block size rounded up
-
-    size_t * weights_same_e0 = calloc(half_block_size, sizeof(size_t));
-    size_t * weights_alpha_multiple_right_e0 = calloc(half_block_size, sizeof(size_t));
-    size_t * weights_alpha_multiple_left_e0 = calloc(half_block_size, sizeof(size_t));
-    size_t * weights_same_e1 = calloc(half_block_size, sizeof(size_t));
-    size_t * weights_alpha_multiple_right_e1 = calloc(half_block_size, sizeof(size_t));
-    size_t * weights_alpha_multiple_left_e1 = calloc(half_block_size, sizeof(size_t));
-    size_t * attempts_same_e0 = calloc(half_block_size, sizeof(size_t));
-    size_t * attempts_alpha_multiple_right_e0 = calloc(half_block_size, sizeof(size_t));
-    size_t * attempts_alpha_multiple_left_e0 = calloc(half_block_size, sizeof(size_t));
-    size_t * attempts_same_e1 = calloc(half_block_size, sizeof(size_t));
-    size_t * attempts_alpha_multiple_right_e1 = calloc(half_block_size, sizeof(size_t));
-    size_t * attempts_alpha_multiple_left_e1 = calloc(half_block_size, sizeof(size_t));
-    bool * distance_same_e0_written_to = calloc(half_block_size, sizeof(bool));
-    bool * distance_same_e1_written_to = calloc(half_block_size, sizeof(bool));
-    bool * distance_alpha_right_e0_written_to = calloc(half_block_size, sizeof(bool));
-    bool * distance_alpha_right_e1_written_to = calloc(half_block_size, sizeof(bool));
-    bool * distance_alpha_left_e0_written_to = calloc(half_block_size, sizeof(bool));
-    bool * distance_alpha_left_e1_written_to = calloc(half_block_size, sizeof(bool));
-
-    if (NULL == weights_same_e0
-        || NULL == weights_alpha_multiple_right_e0
-        || NULL == weights_alpha_multiple_left_e0
-        || NULL == weights_same_e1
-        || NULL == weights_alpha_multiple_right_e1
-        || NULL == weights_alpha_multiple_left_e1
-        || NULL == attempts_same_e0
-        || NULL == attempts_alpha_multiple_right_e0
-        || NULL == attempts_alpha_multiple_left_e0
-        || NULL == attempts_same_e1
-        || NULL == attempts_alpha_multiple_right_e1
-        || NULL == attempts_alpha_multiple_left_e1
-        || NULL == distance_same_e0_written_to
-        || NULL == distance_same_e1_written_to
-        || NULL == distance_alpha_right_e0_written_to
-        || NULL == distance_alpha_right_e1_written_to
-        || NULL == distance_alpha_left_e0_written_to
-        || NULL == distance_alpha_left_e1_written_to) {
-        fprintf(stderr, "%s (%d): Allocation error!\n", __func__, __LINE__);
-        exit(-1);
-    }
-
-    gf4_array_t err = gf4_array_init(2*block_size, true);
-    gf4_array_t syndrome = gf4_array_init(block_size, true);
-
+// stop early if confidence > 0 and all the distances of h0 are classified with the given confidence
+void collect_syndrome_weights(const size_t id, uint64_t seed, double confidence) {
     encoding_context_t ec;
     decoding_context_t dc;
     contexts_load("keys.txt", &ec, &dc);
@@ -144,178 +100,94 @@ void collect_syndrome_weights(const size_t id) {
         exit(-1);
     }
 
-    for (size_t run = 0; run < M; ++run) {
-        fprintf(stderr, "Progress: %zu/%zu\n", (run+1), M);
-        random_weighted_gf4_array(&err, 2*block_size, num_errors);
-        dec_calculate_syndrome(&syndrome, &err, &dc);
-        size_t syndrome_weight = gf4_array_hamming_weight(&syndrome);
-        // fprintf(stderr, "syndrome weight: %zu\n", syndrome_weight);
-        // fprintf(stderr, "err weight: %zu\n", gf4_array_hamming_weight(&err));
-
-        for (size_t i = 0; i < block_size; ++i) {
-            for (size_t j = i + 1; j < block_size; ++j) {
-                size_t distance = (j - i) < half_block_size ? (j - i) : (block_size - (j - i));
-                // e0
-                if (0 != err.array[i] && 0 != err.array[j]) {
-                    if (err.array[i] == err.array[j]) {
-                        if (!distance_same_e0_written_to[distance]) {
-                            weights_same_e0[distance] += (syndrome_weight);
-                            attempts_same_e0[distance] += 1;
-                            distance_same_e0_written_to[distance] = true;
-                        }
-                    } else if (IS_ALPHA_MULT_RIGHT(err.array[i], err.array[j])) {
-                        if (!distance_alpha_right_e0_written_to[distance]) {
-                            weights_alpha_multiple_right_e0[distance] += syndrome_weight;
-                            attempts_alpha_multiple_right_e0[distance] += 1;
-                            distance_alpha_right_e0_written_to[distance] = true;
-                        }
-                    } else if (IS_ALPHA_MULT_LEFT(err.array[i], err.array[j])) {
-                        if (!distance_alpha_left_e0_written_to[distance]) {
-                            weights_alpha_multiple_left_e0[distance] += syndrome_weight;
-                            attempts_alpha_multiple_left_e0[distance] += 1;
-                            distance_alpha_left_e0_written_to[distance] = true;
-                        }
-                    }
-                }
-
-                // e1
-                if (0 != err.array[block_size + i] && 0 != err.array[block_size + j]) {
-                    if (err.array[block_size + i] == err.array[block_size + j]) {
-                        if (!distance_same_e1_written_to[distance]) {
-                            weights_same_e1[distance] += syndrome_weight;
-                            attempts_same_e1[distance] += 1;
-                            distance_same_e1_written_to[distance] = true;
-                        }
-                    } else if (IS_ALPHA_MULT_RIGHT(err.array[block_size + i], err.array[block_size + j])) {
-                        if (!distance_alpha_right_e1_written_to[distance]) {
-                            weights_alpha_multiple_right_e1[distance] += syndrome_weight;
-                            attempts_alpha_multiple_right_e1[distance] += 1;
-                            distance_alpha_right_e1_written_to[distance] = true;
-                        }
-                    } else if (IS_ALPHA_MULT_LEFT(err.array[block_size + i], err.array[block_size + j])) {
-                        if (!distance_alpha_left_e1_written_to[distance]) {
-                            weights_alpha_multiple_left_e1[distance] += syndrome_weight;
-                            attempts_alpha_multiple_left_e1[distance] += 1;
-                            distance_alpha_left_e1_written_to[distance] = true;
-                        }
-                    }
-                }
-            }
-        }
-        memset(distance_same_e0_written_to, 0, half_block_size * sizeof(bool));
-        memset(distance_same_e1_written_to, 0, half_block_size * sizeof(bool));
-        memset(distance_alpha_right_e0_written_to, 0, half_block_size * sizeof(bool));
-        memset(distance_alpha_right_e1_written_to, 0, half_block_size * sizeof(bool));
-        memset(distance_alpha_left_e0_written_to, 0, half_block_size * sizeof(bool));
-        memset(distance_alpha_left_e1_written_to, 0, half_block_size * sizeof(bool));
-        gf4_array_zero_out(&syndrome);
-        gf4_array_zero_out(&err);
-        for (size_t check = 0; check < block_size; ++check) {
-            if (0 != syndrome.array[check] || 0 != err.array[check] || 0 != err.array[check + block_size]) {
-                fprintf(stderr, "%s: Error! Arrays are not zeroed out!!!\n", __func__);
-                exit(-1);
-            }
-        }
-    }
-
-    char buffer[100] = {0};
-    FILE * file;
+    gjs_spectrum_t spectrum;
+    gjs_spectrum_init(&spectrum, block_size, num_errors, gjs_key_fingerprint(&dc));
+    fprintf(stderr, "Key fingerprint: %016llx\n", (unsigned long long)spectrum.key_fingerprint);
 
-    // same symbols
-    sprintf(buffer, "weights_same_e0_%zu.txt", id);
-    file = fopen(buffer, "w+");
-    if (NULL == file) {
-        fprintf(stderr, "%s (%d): Fopen error!\n", __func__, __LINE__);
-        exit(-1);
-    }
-    for (size_t dist = 1; dist < half_block_size; ++dist) {
-        fprintf(file, "%zu %zu %zu\n", dist, weights_same_e0[dist], attempts_same_e0[dist]);
-    }
-    fclose(file);
-
-    memset(buffer, 0, 100 * sizeof(char));
-    sprintf(buffer, "weights_same_e1_%zu.txt", id);
-    file = fopen(buffer, "w+");
-    if (NULL == file) {
-        fprintf(stderr, "%s (%d): Fopen error!\n", __func__, __LINE__);
-        exit(-1);
-    }
-    for (size_t dist = 1; dist < half_block_size; ++dist) {
-        fprintf(file, "%zu %zu %zu\n", dist, weights_same_e1[dist], attempts_same_e1[dist]);
-    }
-    fclose(file);
-
-    // alpha mult right
-    memset(buffer, 0, 100 * sizeof(char));
-    sprintf(buffer, "weights_alpha_mult_right_e0_%zu.txt", id);
-    file = fopen(buffer, "w+");
-    if (NULL == file) {
-        fprintf(stderr, "%s (%d): Fopen error!\n", __func__, __LINE__);
-        exit(-1);
-    }
-    for (size_t dist = 1; dist < half_block_size; ++dist) {
-        fprintf(file, "%zu %zu %zu\n", dist, weights_alpha_multiple_right_e0[dist], attempts_alpha_multiple_right_e0[dist]);
-    }
-    fclose(file);
-
-    memset(buffer, 0, 100 * sizeof(char));
-    sprintf(buffer, "weights_alpha_mult_right_e1_%zu.txt", id);
-    file = fopen(buffer, "w+");
-    if (NULL == file) {
-        fprintf(stderr, "%s (%d): Fopen error!\n", __func__, __LINE__);
+    size_t * mults[2];
+    mults[GJS_SERIES_SAME] = malloc(spectrum.num_distances * sizeof(size_t));
+    mults[GJS_SERIES_DIFFERENT] = malloc(spectrum.num_distances * sizeof(size_t));
+    if (NULL == mults[GJS_SERIES_SAME] || NULL == mults[GJS_SERIES_DIFFERENT]) {
+        fprintf(stderr, "%s (%d): Allocation error!\n", __func__, __LINE__);
         exit(-1);
     }
-    for (size_t dist = 1; dist < half_block_size; ++dist) {
-        fprintf(file, "%zu %zu %zu\n", dist, weights_alpha_multiple_right_e1[dist], attempts_alpha_multiple_right_e1[dist]);
-    }
-    fclose(file);
-
-    // alpha multiple left
-    memset(buffer, 0, 100 * sizeof(char));
-    sprintf(buffer, "weights_alpha_mult_left_e0_%zu.txt", id);
-    file = fopen(buffer, "w+");
-    if (NULL == file) {
-        fprintf(stderr, "%s (%d): Fopen error!\n", __func__, __LINE__);
-        exit(-1);
+    gjs_multiplicities_h0(&dc, mults[GJS_SERIES_SAME], mults[GJS_SERIES_DIFFERENT]);
+    gjs_classification_t classification;
+    gjs_classification_init(&classification, spectrum.num_distances);
+    // C is the confidence of the whole classification, the 2 * (num_distances - 1) multiplicities share 1 - C (Bonferroni)
+    double z = (0.0 < confidence)
+               ? gjs_confidence_z(1.0 - (1.0 - confidence) / (2.0 * (double)(spectrum.num_distances - 1))) : 0.0;
+    size_t num_pairs = block_weight * (block_weight - 1) / 2;
+    bool classified = false;
+
+    // samples are collected in batches to report progress, the stopping rule is evaluated whenever
+    // the number of samples has grown by 10 % since the distances were classified the last time
+    const uint64_t batch_size = 10000;
+    uint64_t next_classification = batch_size;
+    for (uint64_t begin = 0; begin < M && !classified; begin += batch_size) {
+        uint64_t end = (M - begin < batch_size) ? M : begin + batch_size;
+        gjs_collect(&spectrum, &dc, seed, begin, end, num_threads);
+        if (0.0 < confidence && (end >= next_classification || end == M)) {
+            next_classification = end + UTILS_MAX(batch_size, end / 10);
+            classified = gjs_classify(&classification, &spectrum, num_pairs, mults, z);
+            fprintf(stderr, "Progress: %llu/%zu, classified same %zu/%zu (%zu wrong), different %zu/%zu (%zu wrong)\n",
+                    (unsigned long long)end, M, classification.num_confident[GJS_SERIES_SAME], spectrum.num_distances - 1,
+                    classification.num_wrong[GJS_SERIES_SAME], classification.num_confident[GJS_SERIES_DIFFERENT],
+                    spectrum.num_distances - 1, classification.num_wrong[GJS_SERIES_DIFFERENT]);
+        } else {
+            fprintf(stderr, "Progress: %llu/%zu\n", (unsigned long long)end, M);
+        }
     }
-    for (size_t dist = 1; dist < half_block_size; ++dist) {
-        fprintf(file, "%zu %zu %zu\n", dist, weights_alpha_multiple_left_e0[dist], attempts_alpha_multiple_left_e0[dist]);
+    if (0.0 < confidence) {
+        if (classified) {
+            fprintf(stdout, "All distances classified with confidence %g after %llu samples: %zu wrong same, %zu wrong different\n",
+                    confidence, (unsigned long long)spectrum.num_samples, classification.num_wrong[GJS_SERIES_SAME],
+                    classification.num_wrong[GJS_SERIES_DIFFERENT]);
+        } else {
+            fprintf(stdout, "Not all distances classified with confidence %g after %llu samples\n",
+                    confidence, (unsigned long long)spectrum.num_samples);
+        }
     }
-    fclose(file);
+    char filename[100] = {0};
+    snprintf(filename, sizeof(filename), "spectrum_%zu.bin", id);
+    gjs_spectrum_save(filename, &spectrum);
+
+    gjs_classification_deinit(&classification);
+    free(mults[GJS_SERIES_DIFFERENT]);
+    free(mults[GJS_SERIES_SAME]);
+    gjs_spectrum_deinit(&spectrum);
+    contexts_deinit(&ec, &dc);
+}
 
-    memset(buffer, 0, 100 * sizeof(char));
-    sprintf(buffer, "weights_alpha_mult_left_e1_%zu.txt", id);
-    file = fopen(buffer, "w+");
-    if (NULL == file) {
-        fprintf(stderr, "%s (%d): Fopen error!\n", __func__, __LINE__);
-        exit(-1);
+// sum the spectra of files[0], ..., files[num_files - 1] into spectrum_<id>.bin,
+// write the combined text files and the input of the classifier means_<id>.txt
+void merge_spectra(const size_t id, char ** files, size_t num_files) {
+    gjs_spectrum_t spectrum;
+    gjs_spectrum_load(files[0], &spectrum);
+    for (size_t i = 1; i < num_files; ++i) {
+        gjs_spectrum_t other;
+        gjs_spectrum_load(files[i], &other);
+        if (!gjs_spectrum_merge(&spectrum, &other)) {
+            fprintf(stderr, "%s: Error! %s was collected with another key or number of errors than %s, or shares samples of a seed with the files before it!\n",
+                    __func__, files[i], files[0]);
+            exit(-1);
+        }
+        gjs_spectrum_deinit(&other);
     }
-    for (size_t dist = 1; dist < half_block_size; ++dist) {
-        fprintf(file, "%zu %zu %zu\n", dist, weights_alpha_multiple_left_e1[dist], attempts_alpha_multiple_left_e1[dist]);
+    fprintf(stderr, "Merged %zu file(s): %llu samples, key fingerprint %016llx\n", num_files,
+            (unsigned long long)spectrum.num_samples, (unsigned long long)spectrum.key_fingerprint);
+    for (size_t i = 0; i < spectrum.num_ranges; ++i) {
+        fprintf(stderr, "  seed %llu: samples [%llu, %llu)\n", (unsigned long long)spectrum.ranges[i].seed,
+                (unsigned long long)spectrum.ranges[i].sample_begin, (unsigned long long)spectrum.ranges[i].sample_end);
     }
-    fclose(file);
 
-    contexts_deinit(&ec, &dc);
-    gf4_array_deinit(&syndrome);
-    gf4_array_deinit(&err);
-    free(distance_alpha_left_e1_written_to);
-    free(distance_alpha_left_e0_written_to);
-    free(distance_alpha_right_e1_written_to);
-    free(distance_alpha_right_e0_written_to);
-    free(distance_same_e1_written_to);
-    free(distance_same_e0_written_to);
-    free(attempts_alpha_multiple_left_e1);
-    free(attempts_alpha_multiple_right_e1);
-    free(attempts_same_e1);
-    free(attempts_alpha_multiple_left_e0);
-    free(attempts_alpha_multiple_right_e0);
-    free(attempts_same_e0);
-    free(weights_alpha_multiple_left_e1);
-    free(weights_alpha_multiple_right_e1);
-    free(weights_same_e1);
-    free(weights_alpha_multiple_left_e0);
-    free(weights_alpha_multiple_right_e0);
-    free(weights_same_e0);
+    char filename[100] = {0};
+    snprintf(filename, sizeof(filename), "spectrum_%zu.bin", id);
+    gjs_spectrum_save(filename, &spectrum);
+    gjs_spectrum_write_text(&spectrum, id);
+    snprintf(filename, sizeof(filename), "means_%zu.txt", id);
+    gjs_spectrum_write_means(filename, &spectrum);
+    gjs_spectrum_deinit(&spectrum);
 }
 
 // D0[i] == true => i \in D0. equiv. for D1
@@ -355,37 +227,23 @@ void reconstruct_private_key(bool * D0, bool * D1, size_t s0, size_t s1) {
     // matrix B is the transpose of the second block of G
     // however, transposition is not necessary here as second_block_G was never transposed in the first place
     // see encoding_context_t
-    gf4_matrix_t B = gf4_matrix_init_cyclic_matrix(&ec.second_block_G, block_size);
+    // only the selected rows and columns of B are ever generated
+    gf4_circulant_t B = gf4_circulant_init_view(&ec.second_block_G, block_size);
 
-    // keep only rows whose indices are in Z1'
-    size_t idx = block_size;
-    do {
-        --idx;
-        if (!not_Z1[idx]) {
-            gf4_matrix_remove_row_inplace(&B, idx);
-        }
-    } while (0 != idx);
+    // keep only rows whose indices are in Z1', the rows are eliminated once for all the shifts of Z0
+    gf4_matrix_t B_rows = gf4_circulant_select(&B, not_Z1, NULL);
+    gf4_matrix_kernel_solver_t solver;
+    gf4_matrix_kernel_solver_init(&solver, &B_rows, num_threads);
+    gf4_matrix_deinit(&B_rows);
 
     for (size_t p = 0; p < block_size; ++p) {
-        gf4_matrix_t B_prime = gf4_matrix_clone(&B);
-
-        // keep only cols whose indices are in Z0
-        idx = block_size;
-        do {
-            --idx;
-            if (!Z0[idx]) {
-                gf4_matrix_remove_col_inplace(&B_prime, idx);
-            }
-        } while (0 != idx);
-
-        // solve
-        gf4_matrix_gaussian_elimination_inplace(&B_prime);
-        gf4_matrix_t kernel = gf4_matrix_solve_homogenous_linear_system(&B_prime);
+        // solve for the cols whose indices are in Z0
+        gf4_matrix_t kernel = gf4_matrix_kernel_solver_nullspace(&solver, Z0, num_threads);
         if (1 == kernel.num_rows) {
-            gf4_array_t tmp_do_not_deinit;
-            tmp_do_not_deinit.capacity = kernel.num_cols;
-            tmp_do_not_deinit.array = kernel.rows[0];
-            size_t num_nonzero = gf4_array_hamming_weight(&tmp_do_not_deinit);
+            // one-dimensional kernel, its nonzero vectors are multiples of each other and have the same weight
+            gf4_array_t kernel_row = gf4_array_init(kernel.num_cols, false);
+            gf4_matrix_get_row(&kernel, 0, kernel_row.array);
+            size_t num_nonzero = gf4_array_hamming_weight(&kernel_row);
             if (num_nonzero <= block_weight) {
                 // this is the correct key
 
@@ -394,7 +252,7 @@ void reconstruct_private_key(bool * D0, bool * D1, size_t s0, size_t s1) {
                 size_t col = 0;
                 for (size_t i = 0; i < block_size; ++i) {
                     if (not_Z1[i]) {
-                        h1.array[i] = kernel.rows[0][col];
+                        h1.array[i] = kernel_row.array[col];
                         ++col;
                     }
                 }
@@ -416,6 +274,7 @@ void reconstruct_private_key(bool * D0, bool * D1, size_t s0, size_t s1) {
                 fclose(output);
                 // todo reconstruct h0
             }
+            gf4_array_deinit(&kernel_row);
         }
 
         // cyclically shift Z0 by one position to the right
@@ -427,10 +286,10 @@ void reconstruct_private_key(bool * D0, bool * D1, size_t s0, size_t s1) {
 
         // cleanup
         gf4_matrix_deinit(&kernel);
-        gf4_matrix_deinit(&B_prime);
     }
 
-    gf4_matrix_deinit(&B);
+    gf4_matrix_kernel_solver_deinit(&solver);
+
     contexts_deinit(&ec, &dc);
     free(not_Z1);
     free(Z0);
@@ -439,22 +298,54 @@ void reconstruct_private_key(bool * D0, bool * D1, size_t s0, size_t s1) {
 void print_usage() {
     fprintf(stderr,
             "./mdpc-gf4 gen\n"
-            "./mdpc-gf4 weights <M> <ID>\n"
+            "./mdpc-gf4 weights <M> <ID> [--seed SEED] [--threads N] [--confidence C]\n"
+            "./mdpc-gf4 merge <ID> <FILE>...\n"
             "\n"
+            "weights collects the spectrum of keys.txt into spectrum_<ID>.bin\n"
             "M is number of messages per distance\n"
             "ID is used to identify resulting filenames\n"
-            "example: ./mdpc-gf4 weights 1000 1 --> use 1000 error patterns and use 1 in the resulting files' names\n");
+            "SEED is the base seed of the error patterns (default: current time), results are reproducible\n"
+            "     for the same SEED regardless of N. Runs to be merged must use different seeds, the seed and\n"
+            "     the range of samples are stored in the spectrum file and merge rejects files sharing samples\n"
+            "N is the number of threads (default: number of online processors)\n"
+            "C enables early stopping: M becomes the maximum number of messages and sampling stops once every\n"
+            "  distance of h0 is classified into its multiplicity class with confidence C (e.g. 0.999) of the whole\n"
+            "  classification (Bonferroni corrected). The classes are fitted without the key, keys.txt only counts\n"
+            "  the wrong ones\n"
+            "example: ./mdpc-gf4 weights 1000 1 --> use 1000 error patterns and use 1 in the resulting files' names\n"
+            "\n"
+            "merge sums spectrum files of the same key into spectrum_<ID>.bin and writes the text files\n"
+            "weights_<class>_<ID>.txt and the mean syndrome weights means_<ID>.txt\n"
+            "example: ./mdpc-gf4 merge 0 spectrum_1.bin spectrum_2.bin\n");
 }
 
 int main(int nargs, char ** argv) {
+    long num_online = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = (0 < num_online) ? (size_t)num_online : 1;
     if (2 == nargs && 0 == strcmp(argv[1], "gen")) {
         gen_keys("keys.txt", "mults.txt");
         return 0;
-    } else if (4 == nargs && 0 == strcmp(argv[1], "weights")) {
+    } else if (4 <= nargs && 0 == strcmp(argv[1], "weights")) {
         const size_t id = atoll(argv[3]);
         M = atoll(argv[2]);
-        fprintf(stderr, "Used settings: M=%zu id=%zu\n", M, id);
-        collect_syndrome_weights(id);
+        uint64_t seed = (uint64_t)time(NULL);
+        double confidence = 0.0;
+        for (int i = 4; i < nargs; ++i) {
+            if (0 == strcmp(argv[i], "--seed") && i + 1 < nargs) {
+                seed = strtoull(argv[++i], NULL, 10);
+            } else if (0 == strcmp(argv[i], "--threads") && i + 1 < nargs && 0 < atoll(argv[i + 1])) {
+                num_threads = atoll(argv[++i]);
+            } else if (0 == strcmp(argv[i], "--confidence") && i + 1 < nargs && 0.0 < atof(argv[i + 1]) && atof(argv[i + 1]) < 1.0) {
+                confidence = atof(argv[++i]);
+            } else {
+                print_usage();
+                return 0;
+            }
+        }
+        fprintf(stderr, "Used settings: M=%zu id=%zu seed=%llu threads=%zu\n", M, id, (unsigned long long)seed, num_threads);
+        collect_syndrome_weights(id, seed, confidence);
+    } else if (4 <= nargs && 0 == strcmp(argv[1], "merge")) {
+        merge_spectra(atoll(argv[2]), argv + 3, nargs - 3);
     } else {
         print_usage();
         return 0;
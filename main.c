@@ -1,5 +1,3 @@
-#define GJS
-
 #ifdef RUNTESTS // run unit tests defined in test.h (new tests must be added to run_unit_tests function)
 #include <stdio.h>
 #include "src/tests.h"
@@ -52,112 +50,35 @@ int main() {
 
 #elif defined(TEST_ITERATIONS) // find number of decoder iterations
 
-#include "src/dec.h"
-#include "src/enc.h"
-
-void test_iterations(size_t decoder, size_t opt) {
-    bool (*decode_function)(gf4_poly_t*, gf4_poly_t *, size_t, decoding_context_t *);
-    switch (decoder) {
-        case 0:
-            decode_function = &dec_decode_symbol_flipping;
-            break;
-        case 1:
-            decode_function = &dec_decode_symbol_flipping_2;
-            break;
-        case 2:
-            decode_function = &dec_decode_symbol_flipping_delta;
-            break;
-        case 3:
-            decode_function = &dec_decode_symbol_flipping_threshold;
-            break;
-        case 4:
-            decode_function = &dec_decode_symbol_flipping_bg;
-            break;
-        default:
-            decode_function = NULL;
-            exit(-1);
-    }
-
-    // select threshold if relevant
-    long (*threshold_function)(long) = NULL;
-    if (3 == decoder) {
-        switch (opt) {
-            case 0:
-                threshold_function = &dec_calculate_threshold_0;
-                break;
-            case 1:
-                threshold_function = &dec_calculate_threshold_1;
-                break;
-            case 2:
-                threshold_function = &dec_calculate_threshold_2;
-                break;
-            case 3:
-                threshold_function = &dec_calculate_threshold_3;
-                break;
-            case 4:
-                threshold_function = &dec_calculate_threshold_4;
-                break;
-            case 5:
-                threshold_function = &dec_calculate_threshold_5;
-                break;
-            default:
-                fprintf(stderr, "ERROR: incorrect OPT value!\n");
-                exit(-1);
-        }
-    }
-
-    if (4 == decoder) {
-        threshold_function = &dec_calculate_threshold_3;
+#include <string.h>
+#include <time.h>
+#include "src/sim.h"
+
+void test_iterations(size_t decoder, size_t opt, sim_options_t * options) {
+    sim_params_t params;
+    params.num_keys = 20;
+    params.num_messages = 100;
+    params.block_size = 2339;
+    params.block_weight = 37;
+    params.num_errors = 84;
+    params.num_iterations = 200;
+    params.decoder = decoder;
+    params.opt = opt;
+    params.seed = (uint64_t)time(NULL);
+    params.shard_index = 0;
+    params.shard_count = 1;
+    params.rerun_failures = true;
+
+    sim_result_t result;
+    sim_result_init(&result, &params);
+    sim_run(&params, options, &result);
+    if (NULL != options->sink) {
+        sim_result_print(stderr, &result);
+        sim_result_deinit(&result);
+        return;
     }
 
-    size_t num_keys = 20;
-    size_t num_messages = 100;
-    size_t block_size = 2339;
-    size_t block_weight = 37;
-    size_t num_errors = 84;
-    size_t num_iterations = 200;
-
-    gf4_poly_t plaintext = gf4_poly_init_zero(block_size);
-    gf4_poly_t ciphertext = gf4_poly_init_zero(2 * block_size);
-    gf4_poly_t decrypted = gf4_poly_init_zero(2 * block_size);
-    size_t * iteration_counter = malloc(num_keys*num_messages* sizeof(size_t));
-    size_t pos = 0;
-    for (size_t i = 0; i < num_keys; ++i) {
-        fprintf(stderr, "regen keys!\n");
-        encoding_context_t ec;
-        decoding_context_t dc;
-        contexts_init(&ec, &dc, block_size, block_weight);
-
-        dc.delta_setting = (long)opt;
-        dc.threshold = threshold_function;
-
-        for (size_t j = 0; j < num_messages; ++j) {
-            RERUN:
-            random_gf4_poly(&plaintext, block_size);
-            enc_encrypt(&ciphertext, &plaintext, num_errors, &ec);
-            bool decryption_success = dec_decrypt(&decrypted, &ciphertext, decode_function, num_iterations,
-                                                  &dc);
-            if (decryption_success) {
-                fprintf(stderr, "progress: %zu / %zu,  SUCCESS\n", pos+1, num_messages*num_keys);
-                gf4_poly_zero_out(&plaintext);
-                gf4_poly_zero_out(&ciphertext);
-                gf4_poly_zero_out(&decrypted);
-                iteration_counter[pos] = dc.elapsed_iterations;
-                pos++;
-            } else {
-                gf4_poly_zero_out(&plaintext);
-                gf4_poly_zero_out(&ciphertext);
-                gf4_poly_zero_out(&decrypted);
-                fprintf(stderr, "progress: %zu / %zu,  FAILURE, RERUN\n", pos+1, num_messages*num_keys);
-                goto RERUN;
-            }
-        }
-        contexts_deinit(&ec, &dc);
-    }
-    gf4_poly_deinit(&plaintext);
-    gf4_poly_deinit(&ciphertext);
-    gf4_poly_deinit(&decrypted);
-
+    // legacy output without records
     char fname[100] = {0};
     if (2 == decoder) {
         sprintf(fname, "iteracie-dec_%zu-delta_%zu.txt", decoder, opt);
@@ -167,18 +88,47 @@ void test_iterations(size_t decoder, size_t opt) {
         sprintf(fname, "iteracie-dec_%zu-opt_%zu.txt", decoder, opt);
     }
 
+    // every successful decoding in ascending order of elapsed iterations
     FILE * out = fopen(fname, "w");
-    for (size_t i = 0; i < pos; ++i) {
-        fprintf(out, "%zu;", iteration_counter[i]);
+    for (size_t i = 0; i <= params.num_iterations; ++i) {
+        for (uint64_t j = 0; j < result.iterations[i]; ++j) {
+            fprintf(out, "%zu;", i);
+        }
     }
     fprintf(out, "\n");
     fclose(out);
-    free(iteration_counter);
+    sim_result_print(stderr, &result);
+    sim_result_deinit(&result);
 }
 
 int main(int argc, char ** argv) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: ./mdpc-gf4 DECODER OPT\n");
+    sim_options_t options;
+    sim_options_init(&options);
+    const char * records_fname = NULL;
+    report_format_t records_format = REPORT_FORMAT_CSV;
+    const char * corpus_dirname = NULL;
+    char * positional[2];
+    size_t num_positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--checkpoint") && i + 1 < argc) {
+            options.checkpoint_filename = argv[++i];
+        } else if (0 == strcmp(argv[i], "--corpus") && i + 1 < argc) {
+            corpus_dirname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--records") && i + 1 < argc) {
+            records_fname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--format") && i + 1 < argc && report_parse_format(argv[i + 1], &records_format)) {
+            ++i;
+        } else if (0 == strcmp(argv[i], "--resume")) {
+            options.resume = true;
+        } else if (0 != strncmp(argv[i], "--", 2) && num_positional < 2) {
+            positional[num_positional++] = argv[i];
+        } else {
+            num_positional = 0;
+            break;
+        }
+    }
+    if (2 != num_positional || (options.resume && NULL == options.checkpoint_filename)) {
+        fprintf(stderr, "Usage: ./mdpc-gf4 DECODER OPT [--checkpoint FILE [--resume]] [--records FILE [--format csv|jsonl|binary]] [--corpus DIR]\n");
         fprintf(stderr, "DECODER: 0 --> SF\n");
         fprintf(stderr, "         2 --> SF with DELTA\n");
         fprintf(stderr, "         3 --> SF with threshold\n");
@@ -187,10 +137,26 @@ int main(int argc, char ** argv) {
         fprintf(stderr, "With decoder 3, OPT is used as index of threshold function\n");
         return -1;
     }
-    size_t decoder = atol(argv[1]);
-    size_t delta = atol(argv[2]);
+    size_t decoder = atol(positional[0]);
+    size_t delta = atol(positional[1]);
     fprintf(stderr, "Settings are: %zu %zu\n", decoder, delta);
-    test_iterations(decoder, delta);
+    report_sink_t sink;
+    if (NULL != records_fname) {
+        report_sink_open(&sink, records_fname, records_format, options.resume);
+        options.sink = &sink;
+    }
+    corpus_t corpus;
+    if (NULL != corpus_dirname) {
+        corpus_open(&corpus, corpus_dirname);
+        options.corpus = &corpus;
+    }
+    test_iterations(decoder, delta, &options);
+    if (NULL != records_fname) {
+        report_sink_close(&sink);
+    }
+    if (NULL != corpus_dirname) {
+        corpus_close(&corpus);
+    }
 }
 
 #elif defined(GJS)  // TODO, for the love of god do not run this, bad things will happen, monsters will crawl from under your bed
@@ -249,116 +215,24 @@ int main() {
 #else // DFR tests
 
 #include <stdio.h>
-#include "src/gf4.h"
-#include "src/gf4_poly.h"
-#include "src/contexts.h"
-#include "src/enc.h"
-#include "src/dec.h"
-
-void run_tests(FILE * file, size_t num_keys, size_t num_messages, size_t block_size, size_t block_weight, size_t num_errors, size_t num_iterations, size_t decoder, size_t opt) {
-    // select decoder
-    bool (*decode_function)(gf4_poly_t*, gf4_poly_t *, size_t, decoding_context_t *) = NULL;
-    switch (decoder) {
-        case 0:
-            decode_function = &dec_decode_symbol_flipping;
-            break;
-        case 1:
-            decode_function = &dec_decode_symbol_flipping_2;
-            break;
-        case 2:
-            decode_function = &dec_decode_symbol_flipping_delta;
-            break;
-        case 3:
-            decode_function = &dec_decode_symbol_flipping_threshold;
-            break;
-        case 4:
-            decode_function = &dec_decode_symbol_flipping_bg;
-            break;
-        default:
-            decode_function = NULL;
-            exit(-1);
-    }
-
-    // select threshold if relevant
-    // select threshold if relevant
-    long (*threshold_function)(long) = NULL;
-    if (3 == decoder) {
-        switch (opt) {
-            case 0:
-                threshold_function = &dec_calculate_threshold_0;
-                break;
-            case 1:
-                threshold_function = &dec_calculate_threshold_1;
-                break;
-            case 2:
-                threshold_function = &dec_calculate_threshold_2;
-                break;
-            case 3:
-                threshold_function = &dec_calculate_threshold_3;
-                break;
-            case 4:
-                threshold_function = &dec_calculate_threshold_4;
-                break;
-            case 5:
-                threshold_function = &dec_calculate_threshold_5;
-                break;
-            default:
-                fprintf(stderr, "ERROR: incorrect OPT value!\n");
-                exit(-1);
-        }
-    }
-
-    if (4 == decoder) {
-        threshold_function = &dec_calculate_threshold_3;
-    }
-
-    // tests
-    gf4_poly_t plaintext = gf4_poly_init_zero(block_size);
-    gf4_poly_t ciphertext = gf4_poly_init_zero(2 * block_size);
-    gf4_poly_t decrypted = gf4_poly_init_zero(2 * block_size);
-    size_t failure_counter = 0;
-    size_t pos = 0;
-    for (size_t i = 0; i < num_keys; ++i) {
-        fprintf(stderr, "regen keys! current num failures: %zu / %zu\n", failure_counter, num_keys*num_messages);
-        encoding_context_t ec;
-        decoding_context_t dc;
-        contexts_init(&ec, &dc, block_size, block_weight);
-
-        if (3 == decoder || 4 == decoder) {
-            dc.threshold = threshold_function;
-            if (4 == decoder) {
-                dc.delta_setting = (long)opt;
-            }
-        } else {
-            dc.delta_setting = (long)opt;
-        }
-
-        for (size_t j = 0; j < num_messages; ++j) {
-            random_gf4_poly(&plaintext, block_size);
-            enc_encrypt(&ciphertext, &plaintext, num_errors, &ec);
-            bool decryption_success = dec_decrypt(&decrypted, &ciphertext, decode_function, num_iterations,
-                                                  &dc);
-            if (decryption_success) {
-                fprintf(stderr, "progress: %zu / %zu,  SUCCESS\n", pos+1, num_messages*num_keys);
-            } else {
-                failure_counter += 1;
-                fprintf(stderr, "progress: %zu / %zu,  FAILURE\n", pos+1, num_messages*num_keys);
-            }
-            gf4_poly_zero_out(&plaintext);
-            gf4_poly_zero_out(&ciphertext);
-            gf4_poly_zero_out(&decrypted);
-            pos++;
-        }
-        contexts_deinit(&ec, &dc);
-    }
-    gf4_poly_deinit(&plaintext);
-    gf4_poly_deinit(&ciphertext);
-    gf4_poly_deinit(&decrypted);
-    fprintf(file, "num failures: %zu / %zu\n", failure_counter, num_keys*num_messages);
-}
+#include <string.h>
+#include <time.h>
+#include "src/sim.h"
+#include "src/sweep.h"
 
 void print_usage() {
-    fprintf(stderr, "Usage: ./mdpc-gf4 NUM_KEYS NUM_MSGS BLOCK_SIZE BLOCK_WEIGHT NUM_ERRORS NUM_ITERS DECODER [OPT]\n");
+    fprintf(stderr, "Usage: ./mdpc-gf4 NUM_KEYS NUM_MSGS BLOCK_SIZE BLOCK_WEIGHT NUM_ERRORS NUM_ITERS DECODER [OPT] [--seed SEED] [--shard I/N] [--out FILE]\n");
+    fprintf(stderr, "                 [--checkpoint FILE [--checkpoint-interval SECONDS] [--resume]]\n");
+    fprintf(stderr, "                 [--stop-width W] [--stop-threshold T] [--min-trials N]\n");
+    fprintf(stderr, "                 [--records FILE [--format csv|jsonl|binary]] [--progress-interval SECONDS] [--corpus DIR]\n");
+    fprintf(stderr, "                 [--key-cache DIR] [--keygen-threads N [--keygen-queue SIZE]]\n");
+    fprintf(stderr, "       ./mdpc-gf4 merge FILE...\n");
+    fprintf(stderr, "       ./mdpc-gf4 convert-keys IN... OUT\n");
+    fprintf(stderr, "       ./mdpc-gf4 gen-seeds NUM_KEYS BLOCK_SIZE BLOCK_WEIGHT SEED OUT\n");
+    fprintf(stderr, "       ./mdpc-gf4 expand-keys SEEDS OUT\n");
+    fprintf(stderr, "       ./mdpc-gf4 replay DIR DECODER [OPT] [--iterations N] [--records FILE [--format csv|jsonl|binary]]\n");
+    fprintf(stderr, "       ./mdpc-gf4 sweep NUM_KEYS NUM_MSGS BLOCK_SIZE BLOCK_WEIGHT NUM_ITERS --errors LIST --configs LIST [--seed SEED]\n");
+    fprintf(stderr, "                 [--records FILE [--format csv|jsonl|binary]] [--progress-interval SECONDS]\n");
     fprintf(stderr, "e.g.:  ./mdpc-gf4 10 100 2293 37 88 200 0\n");
     fprintf(stderr, "\nParameter values:\n");
     fprintf(stderr, "NUM_KEYS:     positive integer, number of key pairs to generate\n");
@@ -384,64 +258,442 @@ void print_usage() {
 
     fprintf(stderr, "\nPossible decoders:\n");
     fprintf(stderr, "0 --> SF v1\n");
-    fprintf(stderr, "1 --> SF v2  DEPRECATED! \n");
+    fprintf(stderr, "1 --> SF v2  DEPRECATED! Not available in this build.\n");
     fprintf(stderr, "2 --> SF with delta\n");
     fprintf(stderr, "3 --> SF with thr\n");
-    fprintf(stderr, "4 --> SF BG\n");
+    fprintf(stderr, "4 --> SF BG  Not available in this build.\n");
+
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "--seed SEED:  base seed of the simulation, every key and message has its own stream derived from it\n");
+    fprintf(stderr, "              (default: current time). All shards of one simulation must use the same seed!\n");
+    fprintf(stderr, "--shard I/N:  run only the I-th of N disjoint slices of the NUM_KEYS x NUM_MSGS trials (default: 0/1)\n");
+    fprintf(stderr, "--out FILE:   write the (partial) result to a binary FILE\n");
+    fprintf(stderr, "--checkpoint FILE:   periodically save the progress to FILE, it is replaced atomically\n");
+    fprintf(stderr, "--checkpoint-interval SECONDS: minimum time between two checkpoints (default: 60)\n");
+    fprintf(stderr, "--resume:     continue an interrupted run from the checkpoint FILE, the seed is taken from the checkpoint\n");
+    fprintf(stderr, "--stop-width W:      stop early once the 95%% confidence interval of the DFR is narrower than W\n");
+    fprintf(stderr, "--stop-threshold T:  stop early once the 95%% confidence interval of the DFR lies entirely above or below T\n");
+    fprintf(stderr, "--min-trials N:      do not stop early before N decoding attempts (default: 100)\n");
+    fprintf(stderr, "              Stopping rules apply to every shard separately, merged results of shards stopped early\n");
+    fprintf(stderr, "              are flagged and combine the trials that were actually run.\n");
+    fprintf(stderr, "--records FILE:      write a record of every decoding attempt (key, message, number of errors, decoder, opt,\n");
+    fprintf(stderr, "                     iterations, success, time) to FILE, appended when resuming; records written after\n");
+    fprintf(stderr, "                     the last checkpoint of an interrupted run appear twice\n");
+    fprintf(stderr, "--format F:          format of the records: csv (default), jsonl or binary\n");
+    fprintf(stderr, "--progress-interval SECONDS: minimum time between two progress lines (default: 1)\n");
+    fprintf(stderr, "--corpus DIR:        save the key pair and the error vector of every decoding failure to directory DIR\n");
+    fprintf(stderr, "\nmerge FILE...: combine partial results of all shards and print the final statistics\n");
+    fprintf(stderr, "--key-cache DIR:     store key pairs expanded from their seeds in directory DIR and reuse them\n");
+    fprintf(stderr, "                     (e.g. in other shards or runs with the same seed)\n");
+    fprintf(stderr, "--keygen-threads N:  generate key pairs ahead in N background threads (default: 0, generate when needed)\n");
+    fprintf(stderr, "--keygen-queue SIZE: maximum number of key pairs generated ahead (default: 32), producers expand\n");
+    fprintf(stderr, "                     up to 16 consecutive key pairs at once\n");
+    fprintf(stderr, "\nconvert-keys IN... OUT: convert key files to the binary format, all key pairs are stored in one file OUT\n");
+    fprintf(stderr, "\ngen-seeds NUM_KEYS BLOCK_SIZE BLOCK_WEIGHT SEED OUT: write the 32-byte seeds of the key pairs\n");
+    fprintf(stderr, "              of a simulation with --seed SEED to the text file OUT\n");
+    fprintf(stderr, "\nexpand-keys SEEDS OUT: expand all seeds of file SEEDS to key pairs in the binary key file OUT\n");
+    fprintf(stderr, "\nreplay DIR DECODER [OPT] [--iterations N] [--records FILE [--format F]]:\n");
+    fprintf(stderr, "              decode the failures saved in corpus DIR again using DECODER, N defaults to the stored value\n");
+    fprintf(stderr, "\nsweep: generate every key pair and message once and decode it under every configuration, print one table\n");
+    fprintf(stderr, "--errors LIST:   comma separated numbers of errors, e.g. 84,86,88 (error vectors are nested)\n");
+    fprintf(stderr, "--configs LIST:  comma separated DECODER:OPT pairs, e.g. 2:3,3:0,3:1; the first one is the baseline\n");
+    fprintf(stderr, "                 of the paired comparison\n");
+}
+
+int compare_results(const void * a, const void * b) {
+    const sim_result_t * aa = a;
+    const sim_result_t * bb = b;
+    if (aa->trial_begin > bb->trial_begin) {
+        return 1;
+    } else if (aa->trial_begin == bb->trial_begin) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
+
+int merge_results(size_t num_files, char ** filenames) {
+    if (0 == num_files) {
+        print_usage();
+        return -1;
+    }
+    sim_result_t * results = malloc(num_files * sizeof(sim_result_t));
+    if (NULL == results) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        return -1;
+    }
+    for (size_t i = 0; i < num_files; ++i) {
+        sim_result_load(filenames[i], &results[i]);
+    }
+    qsort(results, num_files, sizeof(sim_result_t), compare_results);
+    int ret_value = 0;
+    for (size_t i = 1; i < num_files; ++i) {
+        if (!sim_result_merge(&results[0], &results[i])) {
+            fprintf(stderr, "ERROR: partial result covering trials %zu-%zu cannot be merged! "
+                            "It is from a different simulation, overlaps or a shard is missing.\n",
+                    (size_t)results[i].trial_begin, (size_t)results[i].trial_end);
+            ret_value = -1;
+            break;
+        }
+    }
+    if (0 == ret_value) {
+        uint64_t total = (uint64_t)results[0].params.num_keys * results[0].params.num_messages;
+        if (0 != results[0].trial_begin || total != results[0].trial_end) {
+            fprintf(stderr, "WARNING: merged results cover only trials %zu-%zu of %zu!\n",
+                    (size_t)results[0].trial_begin, (size_t)results[0].trial_end, (size_t)total);
+        }
+        sim_result_print(stdout, &results[0]);
+    }
+    for (size_t i = 0; i < num_files; ++i) {
+        sim_result_deinit(&results[i]);
+    }
+    free(results);
+    return ret_value;
+}
+
+int run_replay(int argc, char ** argv) {
+    size_t num_iterations = 0;
+    const char * records_fname = NULL;
+    report_format_t records_format = REPORT_FORMAT_CSV;
+    char * positional[3];
+    size_t num_positional = 0;
+    for (int i = 0; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--iterations") && i + 1 < argc) {
+            num_iterations = atol(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--records") && i + 1 < argc) {
+            records_fname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--format") && i + 1 < argc) {
+            if (!report_parse_format(argv[++i], &records_format)) {
+                fprintf(stderr, "ERROR: unknown format %s!\n", argv[i]);
+                return -1;
+            }
+        } else if (0 == strncmp(argv[i], "--", 2) || num_positional >= 3) {
+            print_usage();
+            return 0;
+        } else {
+            positional[num_positional++] = argv[i];
+        }
+    }
+    if (2 != num_positional && 3 != num_positional) {
+        print_usage();
+        return 0;
+    }
+    size_t decoder = atol(positional[1]);
+    size_t opt = (3 == num_positional) ? (size_t)atol(positional[2]) : 0;
+    sim_decode_function_t decode;
+    long (*threshold)(long);
+    if (!sim_select_decoder(decoder, opt, &decode, &threshold)) {
+        fprintf(stderr, "ERROR: decoder %zu with opt %zu is not available!\n", decoder, opt);
+        return -1;
+    }
+
+    report_sink_t sink;
+    if (NULL != records_fname) {
+        report_sink_open(&sink, records_fname, records_format, false);
+    }
+    sim_replay_result_t result;
+    sim_replay(positional[0], decoder, opt, num_iterations, (NULL != records_fname) ? &sink : NULL, &result);
+    if (NULL != records_fname) {
+        report_sink_close(&sink);
+    }
+    printf("replayed failures: %zu, decoded successfully: %zu\n", (size_t)result.num_entries, (size_t)result.num_successes);
+    if (0 != result.num_successes) {
+        printf("mean iterations of successful decodings: %.3f\n", (double)result.iterations_sum / (double)result.num_successes);
+    }
+    return 0;
+}
+
+int run_sweep(int argc, char ** argv) {
+    sweep_params_t params;
+    params.seed = (uint64_t)time(NULL);
+    params.error_counts = NULL;
+    params.configs = NULL;
+    const char * records_fname = NULL;
+    report_format_t records_format = REPORT_FORMAT_CSV;
+    double progress_interval = 1.0;
+    char * positional[5];
+    size_t num_positional = 0;
+    for (int i = 0; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--seed") && i + 1 < argc) {
+            params.seed = strtoull(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "--records") && i + 1 < argc) {
+            records_fname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--format") && i + 1 < argc) {
+            if (!report_parse_format(argv[++i], &records_format)) {
+                fprintf(stderr, "ERROR: unknown format %s!\n", argv[i]);
+                return -1;
+            }
+        } else if (0 == strcmp(argv[i], "--progress-interval") && i + 1 < argc) {
+            progress_interval = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--errors") && i + 1 < argc && NULL == params.error_counts) {
+            if (!sweep_parse_error_counts(argv[++i], &params.error_counts, &params.num_error_counts)) {
+                fprintf(stderr, "ERROR: invalid list of error counts %s!\n", argv[i]);
+                return -1;
+            }
+        } else if (0 == strcmp(argv[i], "--configs") && i + 1 < argc && NULL == params.configs) {
+            if (!sweep_parse_configs(argv[++i], &params.configs, &params.num_configs)) {
+                fprintf(stderr, "ERROR: invalid or unsupported list of configurations %s!\n", argv[i]);
+                return -1;
+            }
+        } else if (0 == strncmp(argv[i], "--", 2) || num_positional >= 5) {
+            print_usage();
+            return 0;
+        } else {
+            positional[num_positional++] = argv[i];
+        }
+    }
+    if (5 != num_positional || NULL == params.error_counts || NULL == params.configs) {
+        print_usage();
+        return 0;
+    }
+    params.num_keys = atol(positional[0]);
+    params.num_messages = atol(positional[1]);
+    params.block_size = atol(positional[2]);
+    params.block_weight = atol(positional[3]);
+    params.num_iterations = atol(positional[4]);
+    for (size_t e = 0; e < params.num_error_counts; ++e) {
+        if (params.error_counts[e] > 2 * params.block_size) {
+            fprintf(stderr, "ERROR: number of errors %zu exceeds the code length!\n", params.error_counts[e]);
+            return -1;
+        }
+    }
+    fprintf(stderr, "Sweep params are: %zu %zu %zu %zu %zu, %zu error counts, %zu configurations\n", params.num_keys, params.num_messages,
+            params.block_size, params.block_weight, params.num_iterations, params.num_error_counts, params.num_configs);
+    fprintf(stderr, "Seed: %llu\n", (unsigned long long)params.seed);
+
+    report_sink_t sink;
+    if (NULL != records_fname) {
+        report_sink_open(&sink, records_fname, records_format, false);
+    }
+    sweep_result_t result;
+    sweep_result_init(&result, &params);
+    sweep_run(&params, (NULL != records_fname) ? &sink : NULL, progress_interval, &result);
+    sweep_result_print(stdout, &result);
+    sweep_result_deinit(&result);
+    if (NULL != records_fname) {
+        report_sink_close(&sink);
+    }
+    free(params.error_counts);
+    free(params.configs);
+    return 0;
+}
+
+int convert_keys(int argc, char ** argv) {
+    if (argc < 2) {
+        print_usage();
+        return -1;
+    }
+    const char * out_fname = argv[argc - 1];
+    for (int i = 0; i < argc - 1; ++i) {
+        contexts_convert_to_binary(argv[i], out_fname, 0 != i);
+    }
+    fprintf(stdout, "%d key pair(s) written to %s\n", argc - 1, out_fname);
+    return 0;
+}
+
+int gen_seeds(int argc, char ** argv) {
+    if (5 != argc) {
+        print_usage();
+        return -1;
+    }
+    size_t num_keys = atol(argv[0]);
+    size_t block_size = atol(argv[1]);
+    size_t block_weight = atol(argv[2]);
+    uint64_t seed = strtoull(argv[3], NULL, 10);
+    contexts_seed_t * seeds = malloc(num_keys * sizeof(contexts_seed_t));
+    if (NULL == seeds) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        return -1;
+    }
+    for (size_t key = 0; key < num_keys; ++key) {
+        contexts_seed_from_u64(&seeds[key], random_derive_seed(seed, key, SIM_KEY_STREAM));
+    }
+    contexts_seeds_save(argv[4], seeds, num_keys, block_size, block_weight);
+    free(seeds);
+    return 0;
+}
+
+int expand_keys(int argc, char ** argv) {
+    if (2 != argc) {
+        print_usage();
+        return -1;
+    }
+    contexts_seed_t * seeds = NULL;
+    size_t num_seeds, block_size, block_weight;
+    contexts_seeds_load(argv[0], &seeds, &num_seeds, &block_size, &block_weight);
+    encoding_context_t enc_ctx[CONTEXTS_BATCH_SIZE];
+    decoding_context_t dec_ctx[CONTEXTS_BATCH_SIZE];
+    for (size_t begin = 0; begin < num_seeds; begin += CONTEXTS_BATCH_SIZE) {
+        size_t count = (num_seeds - begin < CONTEXTS_BATCH_SIZE) ? num_seeds - begin : CONTEXTS_BATCH_SIZE;
+        contexts_init_from_seeds(enc_ctx, dec_ctx, &seeds[begin], count, block_size, block_weight, NULL);
+        for (size_t i = 0; i < count; ++i) {
+            contexts_save_binary(argv[1], &enc_ctx[i], &dec_ctx[i], 0 != begin + i);
+            contexts_deinit(&enc_ctx[i], &dec_ctx[i]);
+        }
+    }
+    fprintf(stdout, "%zu key pair(s) written to %s\n", num_seeds, argv[1]);
+    free(seeds);
+    return 0;
 }
 
 int main(int argc, char ** argv) {
-    if (8 != argc && 9 != argc) {
+    if (2 <= argc && 0 == strcmp(argv[1], "convert-keys")) {
+        return convert_keys(argc - 2, argv + 2);
+    }
+    if (2 <= argc && 0 == strcmp(argv[1], "gen-seeds")) {
+        return gen_seeds(argc - 2, argv + 2);
+    }
+    if (2 <= argc && 0 == strcmp(argv[1], "expand-keys")) {
+        return expand_keys(argc - 2, argv + 2);
+    }
+    if (2 <= argc && 0 == strcmp(argv[1], "merge")) {
+        return merge_results(argc - 2, argv + 2);
+    }
+    if (2 <= argc && 0 == strcmp(argv[1], "sweep")) {
+        return run_sweep(argc - 2, argv + 2);
+    }
+    if (2 <= argc && 0 == strcmp(argv[1], "replay")) {
+        return run_replay(argc - 2, argv + 2);
+    }
+
+    sim_params_t params;
+    params.seed = (uint64_t)time(NULL);
+    params.shard_index = 0;
+    params.shard_count = 1;
+    sim_options_t options;
+    sim_options_init(&options);
+    const char * out_fname = NULL;
+    const char * records_fname = NULL;
+    report_format_t records_format = REPORT_FORMAT_CSV;
+    const char * corpus_dirname = NULL;
+    char * positional[8];
+    size_t num_positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--seed") && i + 1 < argc) {
+            params.seed = strtoull(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "--shard") && i + 1 < argc) {
+            if (!sim_parse_shard(argv[++i], &params.shard_index, &params.shard_count)) {
+                fprintf(stderr, "ERROR: invalid shard %s! Expected I/N with 0 <= I < N.\n", argv[i]);
+                return -1;
+            }
+        } else if (0 == strcmp(argv[i], "--out") && i + 1 < argc) {
+            out_fname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--checkpoint") && i + 1 < argc) {
+            options.checkpoint_filename = argv[++i];
+        } else if (0 == strcmp(argv[i], "--checkpoint-interval") && i + 1 < argc) {
+            options.checkpoint_interval = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--resume")) {
+            options.resume = true;
+        } else if (0 == strcmp(argv[i], "--stop-width") && i + 1 < argc) {
+            options.stop_width = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--stop-threshold") && i + 1 < argc) {
+            options.stop_threshold = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--min-trials") && i + 1 < argc) {
+            options.stop_min_trials = strtoull(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "--records") && i + 1 < argc) {
+            records_fname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--format") && i + 1 < argc) {
+            if (!report_parse_format(argv[++i], &records_format)) {
+                fprintf(stderr, "ERROR: unknown format %s!\n", argv[i]);
+                return -1;
+            }
+        } else if (0 == strcmp(argv[i], "--progress-interval") && i + 1 < argc) {
+            options.progress_interval = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--corpus") && i + 1 < argc) {
+            corpus_dirname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--key-cache") && i + 1 < argc) {
+            options.key_cache_dirname = argv[++i];
+        } else if (0 == strcmp(argv[i], "--keygen-threads") && i + 1 < argc) {
+            options.keygen_threads = atol(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--keygen-queue") && i + 1 < argc) {
+            options.keygen_queue_size = atol(argv[++i]);
+        } else if (0 == strncmp(argv[i], "--", 2) || num_positional >= 8) {
+            print_usage();
+            return 0;
+        } else {
+            positional[num_positional++] = argv[i];
+        }
+    }
+    if (7 != num_positional && 8 != num_positional) {
         print_usage();
         return 0;
     }
-    size_t num_keys;
-    size_t num_messages;
-    size_t block_size;
-    size_t block_weight;
-    size_t num_errors;
-    size_t num_iterations;
-    size_t decoder;
-    size_t opt;
-    num_keys = atol(argv[1]);
-    num_messages = atol(argv[2]);
-    block_size = atol(argv[3]);
-    if (2293 != block_size && 2339 != block_size) {
-        fprintf(stderr, "WARNING: recommended block size is 2293 or 2339! Provided value %zu is untested!\n", block_size);
-    }
-    block_weight = atol(argv[4]);
-    if (37 != block_weight) {
-        fprintf(stderr, "WARNING: recommended block weight is 37! Provided value %zu is untested!\n", block_weight);
-    }
-    num_errors = atol(argv[5]);
-    if (num_errors < 84) {
-        fprintf(stderr, "WARNING: recommended number of errors is 84! Provided value %zu is untested!\n", num_errors);
-    }
-    num_iterations = atol(argv[6]);
-    decoder = atol(argv[7]);
-    if (decoder > 4) {
-        fprintf(stderr, "ERROR: possible decoders are 0-4! Provided value %zu is unsupported!\n", decoder);
+    if (options.resume && NULL == options.checkpoint_filename) {
+        fprintf(stderr, "ERROR: --resume requires --checkpoint FILE!\n");
+        return -1;
+    }
+    if (0 == options.keygen_queue_size) {
+        fprintf(stderr, "ERROR: --keygen-queue must be positive!\n");
         return -1;
     }
-    if (decoder >= 2 && argc == 8) {
+    params.num_keys = atol(positional[0]);
+    params.num_messages = atol(positional[1]);
+    params.block_size = atol(positional[2]);
+    if (2293 != params.block_size && 2339 != params.block_size) {
+        fprintf(stderr, "WARNING: recommended block size is 2293 or 2339! Provided value %zu is untested!\n", params.block_size);
+    }
+    params.block_weight = atol(positional[3]);
+    if (37 != params.block_weight) {
+        fprintf(stderr, "WARNING: recommended block weight is 37! Provided value %zu is untested!\n", params.block_weight);
+    }
+    params.num_errors = atol(positional[4]);
+    if (params.num_errors < 84) {
+        fprintf(stderr, "WARNING: recommended number of errors is 84! Provided value %zu is untested!\n", params.num_errors);
+    }
+    params.num_iterations = atol(positional[5]);
+    params.decoder = atol(positional[6]);
+    if (params.decoder > 4) {
+        fprintf(stderr, "ERROR: possible decoders are 0-4! Provided value %zu is unsupported!\n", params.decoder);
+        return -1;
+    }
+    if (params.decoder >= 2 && 7 == num_positional) {
         fprintf(stderr, "ERROR: decoders 2, 3 and 4 require you to specify OPT! No OPT value was provided!\n");
         return -1;
     }
-    if (1 == decoder) {
-        fprintf(stderr, "WARNING: Decoder SF v2 is deprecated and should not be used!\n");
-    }
-    fprintf(stderr, "Params are: %zu %zu %zu %zu %zu %zu %zu", num_keys, num_messages, block_size, block_weight, num_errors, num_iterations, decoder);
-    if (8 == argc) {
-        fprintf(stderr, "\n");
-        run_tests(stderr, num_keys, num_messages, block_size, block_weight, num_errors, num_iterations, decoder, 0);
-    } else { // opt is provided
-        opt = atol(argv[8]);
-        if (3 == decoder && opt > 5) {
-            fprintf(stderr, "ERROR: possible opt values for decoder 3 are 0-4! Provided value %zu is unsupported!\n", opt);
-        }
-        fprintf(stderr, " %zu\n", opt);
-        run_tests(stderr, num_keys, num_messages, block_size, block_weight, num_errors, num_iterations, decoder, opt);
+    if (1 == params.decoder || 4 == params.decoder) {
+        fprintf(stderr, "ERROR: Decoder %zu is not available in this build!\n", params.decoder);
+        return -1;
+    }
+    params.opt = (8 == num_positional) ? (size_t)atol(positional[7]) : 0;
+    params.rerun_failures = false;
+    if (3 == params.decoder && params.opt > 5) {
+        fprintf(stderr, "ERROR: possible opt values for decoder 3 are 0-5! Provided value %zu is unsupported!\n", params.opt);
+        return -1;
+    }
+    fprintf(stderr, "Params are: %zu %zu %zu %zu %zu %zu %zu", params.num_keys, params.num_messages, params.block_size, params.block_weight, params.num_errors, params.num_iterations, params.decoder);
+    if (8 == num_positional) {
+        fprintf(stderr, " %zu", params.opt);
+    }
+    fprintf(stderr, "\nSeed: %llu, shard: %zu/%zu\n", (unsigned long long)params.seed, params.shard_index, params.shard_count);
+
+    report_sink_t sink;
+    if (NULL != records_fname) {
+        report_sink_open(&sink, records_fname, records_format, options.resume);
+        options.sink = &sink;
+    }
+    corpus_t corpus;
+    if (NULL != corpus_dirname) {
+        corpus_open(&corpus, corpus_dirname);
+        options.corpus = &corpus;
+    }
+    sim_result_t result;
+    sim_result_init(&result, &params);
+    if (sim_run(&params, &options, &result)) {
+        fprintf(stderr, "Stopped early, trials %zu-%zu were run.\n", (size_t)result.trial_begin,
+                (size_t)(result.trial_begin + result.num_run_trials));
+    }
+    sim_result_print(stderr, &result);
+    if (NULL != out_fname) {
+        sim_result_save(out_fname, &result);
+    }
+    sim_result_deinit(&result);
+    if (NULL != records_fname) {
+        report_sink_close(&sink);
+    }
+    if (NULL != corpus_dirname) {
+        fprintf(stderr, "%zu failures saved to corpus %s\n", (size_t)corpus.num_entries, corpus_dirname);
+        corpus_close(&corpus);
     }
     return 0;
 }
-#endif
\ No newline at end of file
+#endif
@@ -18,85 +18,503 @@
 
 #include "contexts.h"
 #include "utils.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-void contexts_init(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, size_t block_size, size_t block_weight) {
-    assert(NULL != out_enc_ctx);
-    assert(NULL != out_dec_ctx);
-    assert(block_weight <= block_size);
+#define CONTEXTS_HEADER_SIZE 48
+#define CONTEXTS_ALIGN(x) (((x) + 7) & ~(size_t)7)
+#define CONTEXTS_PATH_LENGTH 4096
+
+bool contexts_has_exact_precheck(size_t block_size) {
+    // block_size must be an odd prime
+    if (block_size < 3 || 0 == block_size % 2) {
+        return false;
+    }
+    for (size_t d = 3; d * d <= block_size; d += 2) {
+        if (0 == block_size % d) {
+            return false;
+        }
+    }
+    // 2 must be a primitive root modulo block_size
+    size_t order = 1;
+    for (size_t power = 2 % block_size; 1 != power; power = (2 * power) % block_size) {
+        ++order;
+    }
+    return block_size - 1 == order;
+}
+
+bool contexts_invertibility_precheck(gf4_poly_t * h1, size_t block_size) {
+    assert(NULL != h1);
+    assert(h1->degree < block_size);
+    if (0 == gf4_array_sum(&h1->coefficients)) {
+        return false;
+    }
+    if (!contexts_has_exact_precheck(block_size)) {
+        return true;
+    }
+
+    // norm = h1 * conj(h1) mod (x^block_size + 1), conj(a) = a^2 swaps alpha and alpha + 1
+    size_t weight = 0;
+    size_t * support = malloc((h1->degree + 1) * sizeof(size_t));
+    uint8_t * norm = calloc(block_size, sizeof(uint8_t));
+    if (NULL == support || NULL == norm) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t i = 0; i <= h1->degree; ++i) {
+        if (0 != h1->coefficients.array[i]) {
+            support[weight++] = i;
+        }
+    }
+    for (size_t i = 0; i < weight; ++i) {
+        gf4_t a = h1->coefficients.array[support[i]];
+        for (size_t j = 0; j < weight; ++j) {
+            gf4_t b = h1->coefficients.array[support[j]];
+            norm[(support[i] + support[j]) % block_size] ^= gf4_mul(a, gf4_mul(b, b));
+        }
+    }
+
+    // the norm has binary coefficients, its only possible nonzero multiple of Phi below x^block_size is Phi itself
+    bool all_ones = true;
+    for (size_t i = 0; i < block_size && all_ones; ++i) {
+        assert(norm[i] <= 1);
+        all_ones = 1 == norm[i];
+    }
+    free(support);
+    free(norm);
+    return !all_ones;
+}
+
+// draw h1 until it passes contexts_invertibility_precheck
+static void contexts_draw_h1(gf4_poly_t * h1, size_t block_size, size_t block_weight) {
+    do {
+        gf4_poly_zero_out(h1);
+        random_weighted_gf4_array(&h1->coefficients, block_size, block_weight);
+        gf4_poly_adjust_degree(h1, block_size - 1);
+    } while (!contexts_invertibility_precheck(h1, block_size));
+}
+
+// out = (a * b) mod (x^block_size + 1), only nonzero coefficients of a are visited, so a should be the sparser one
+static void contexts_mul_mod(gf4_poly_t * out, gf4_poly_t * a, gf4_poly_t * b, size_t block_size) {
+    assert(out->coefficients.capacity >= block_size);
+    assert(a->degree < block_size && b->degree < block_size);
+    gf4_poly_zero_out(out);
+    gf4_t * out_array = out->coefficients.array;
+    gf4_t * b_array = b->coefficients.array;
+    for (size_t i = 0; i <= a->degree; ++i) {
+        gf4_t a_i = a->coefficients.array[i];
+        if (0 == a_i) {
+            continue;
+        }
+        // x^i * b, indices i + j >= block_size wrap around
+        size_t split = block_size - i;
+        for (size_t j = 0; j <= b->degree && j < split; ++j) {
+            out_array[i + j] ^= gf4_mul(a_i, b_array[j]);
+        }
+        for (size_t j = split; j <= b->degree; ++j) {
+            out_array[j - split] ^= gf4_mul(a_i, b_array[j]);
+        }
+    }
+    gf4_poly_adjust_degree(out, block_size - 1);
+}
+
+// redraw h1 until it is invertible, store the inverse to maybe_inverse
+static void contexts_invert_h1(gf4_poly_t * maybe_inverse, gf4_poly_t * h1, gf4_poly_t * modulus, size_t block_size,
+                               size_t block_weight, gf4_poly_workspace_t * ws) {
+    while (!gf4_poly_invert_ws(maybe_inverse, h1, modulus, ws)) {
+        if (contexts_has_exact_precheck(block_size)) {
+            // WTF???? the precheck guarantees that h1 is invertible
+            fprintf(stderr, "%s: WTF? h1 passed the invertibility precheck, but its inversion failed!\n", __func__);
+            exit(-1);
+        }
+        gf4_poly_zero_out(maybe_inverse);
+        contexts_draw_h1(h1, block_size, block_weight);
+    }
+}
+
+// check that h1 * inverse = 1 mod (x^block_size + 1), the sparse product costs O(weight of h1 * block_size)
+static bool contexts_verify_inverse(gf4_poly_t * h1, gf4_poly_t * inverse, size_t block_size) {
+    gf4_poly_t product = gf4_poly_init_zero(block_size);
+    contexts_mul_mod(&product, h1, inverse, block_size);
+    bool correct_inverse = 0 == gf4_poly_get_degree(&product) && 1 == product.coefficients.array[0];
+    gf4_poly_deinit(&product);
+    return correct_inverse;
+}
+
+// verify the inverse of h1, compute G and move the polynomials to the contexts
+static void contexts_finish(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, gf4_poly_t * h0,
+                            gf4_poly_t * h1, gf4_poly_t * inverse, gf4_poly_t * modulus, size_t block_size) {
+    if (!contexts_verify_inverse(h1, inverse, block_size)) {
+        // WTF???? this means invert function is incorrectly implemented
+        fprintf(stderr, "%s: WTF? invert function is incorrectly implemented!\n", __func__);
+        exit(-1);
+    }
+
+    // second_block_G_poly = (h0_poly * inverse) % modulus ;
+    gf4_poly_t rem = gf4_poly_init_zero(2 * modulus->coefficients.capacity);
+    contexts_mul_mod(&rem, h0, inverse, block_size);
+    out_enc_ctx->block_size = block_size;
+    out_enc_ctx->second_block_G = rem;
+    out_enc_ctx->arena = NULL;
+    out_dec_ctx->block_size = block_size;
+    out_dec_ctx->h0 = *h0;
+    out_dec_ctx->h1 = *h1;
 
     // settings not required by all decoders
     out_dec_ctx->threshold = NULL;
+    out_dec_ctx->arena = NULL;
     out_dec_ctx->elapsed_iterations = 0;
     out_dec_ctx->delta_setting = -1;
+}
 
-    // generate keys
-    size_t capacity = block_size + 1;
-    gf4_poly_t modulus = gf4_poly_init_zero(capacity);
+static gf4_poly_t contexts_modulus(size_t block_size) {
+    gf4_poly_t modulus = gf4_poly_init_zero(block_size + 1);
     gf4_poly_set_coefficient(&modulus, 0, 1);
     gf4_poly_set_coefficient(&modulus, block_size, 1);
+    return modulus;
+}
+
+void contexts_init(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, size_t block_size, size_t block_weight) {
+    assert(NULL != out_enc_ctx);
+    assert(NULL != out_dec_ctx);
+    assert(block_weight <= block_size);
 
+    // generate keys
+    size_t capacity = block_size + 1;
+    gf4_poly_t modulus = contexts_modulus(block_size);
     gf4_poly_t h0 = gf4_poly_init_zero(capacity);
     gf4_poly_t h1 = gf4_poly_init_zero(capacity);
     gf4_poly_t maybe_inverse = gf4_poly_init_zero(2*capacity);
+    gf4_poly_workspace_t ws;
+    gf4_poly_workspace_init(&ws, GF4_POLY_INVERT_WS_POLYS, capacity);
     random_weighted_gf4_array(&h0.coefficients, block_size, block_weight);
     gf4_poly_adjust_degree(&h0, block_size - 1);
-    random_weighted_gf4_array(&h1.coefficients, block_size, block_weight);
-    gf4_poly_adjust_degree(&h1, block_size - 1);
-
-    int repetitions = 0;
-
-    while (true) {
-        while (0 == gf4_array_sum(&h1.coefficients)) {
-            gf4_poly_zero_out(&h1);
-            random_weighted_gf4_array(&h1.coefficients, block_size, block_weight);
-            gf4_poly_adjust_degree(&h1, block_size - 1);
-        }
-        bool inverted = gf4_poly_invert_slow(&maybe_inverse, &h1, &modulus);
-        if (inverted) {
-            gf4_poly_t tmp = gf4_poly_init_zero(2*capacity);
-            gf4_poly_t div = gf4_poly_init_zero(2*capacity);
-            gf4_poly_t rem = gf4_poly_init_zero(2*capacity);
-            gf4_poly_mul(&tmp, &h1, &maybe_inverse);
-            gf4_poly_div_rem(&div, &rem, &tmp, &modulus);
-            bool correct_inverse = 0 == gf4_poly_get_degree(&rem) && 1 == rem.coefficients.array[0];
-            if (!correct_inverse) {
-                // WTF???? this means invert function is incorrectly implemented
-                fprintf(stderr, "%s: WTF? invert function is incorrectly implemented!\n", __func__);
-                gf4_poly_deinit(&tmp);
-                gf4_poly_deinit(&rem);
-                gf4_poly_deinit(&div);
-                gf4_poly_deinit(&modulus);
-                gf4_poly_deinit(&maybe_inverse);
-                gf4_poly_deinit(&h0);
-                gf4_poly_deinit(&h1);
-                exit(-1);
+    contexts_draw_h1(&h1, block_size, block_weight);
+
+    contexts_invert_h1(&maybe_inverse, &h1, &modulus, block_size, block_weight, &ws);
+    contexts_finish(out_enc_ctx, out_dec_ctx, &h0, &h1, &maybe_inverse, &modulus, block_size);
+    gf4_poly_deinit(&modulus);
+    gf4_poly_deinit(&maybe_inverse);
+    gf4_poly_workspace_deinit(&ws);
+}
+
+// a zero seed is the fixed point of xoshiro, its stream is all zeros
+static bool contexts_seed_is_zero(contexts_seed_t * seed) {
+    uint64_t s[4];
+    memcpy(s, seed->bytes, CONTEXTS_SEED_SIZE);
+    return 0 == (s[0] | s[1] | s[2] | s[3]);
+}
+
+void contexts_init_batch(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, contexts_seed_t * seeds,
+                         size_t num_keys, size_t block_size, size_t block_weight) {
+    assert(NULL != out_enc_ctx);
+    assert(NULL != out_dec_ctx);
+    assert(block_weight <= block_size);
+    if (0 == num_keys) {
+        return;
+    }
+
+    size_t capacity = block_size + 1;
+    gf4_poly_t modulus = contexts_modulus(block_size);
+    gf4_poly_t * h0 = malloc(num_keys * sizeof(gf4_poly_t));
+    gf4_poly_t * h1 = malloc(num_keys * sizeof(gf4_poly_t));
+    gf4_poly_t * inverse = malloc(num_keys * sizeof(gf4_poly_t));
+    gf4_poly_t * prefix = malloc(num_keys * sizeof(gf4_poly_t));
+    random_state_t * states = malloc(num_keys * sizeof(random_state_t));
+    if (NULL == h0 || NULL == h1 || NULL == inverse || NULL == prefix || NULL == states) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+
+    // draw candidates, remember the state of the stream of every seed for the fallback
+    random_state_t saved_state;
+    random_get_state(&saved_state);
+    for (size_t i = 0; i < num_keys; ++i) {
+        if (NULL != seeds) {
+            assert(!contexts_seed_is_zero(&seeds[i]));
+            memcpy(states[i].s, seeds[i].bytes, CONTEXTS_SEED_SIZE);
+            random_set_state(&states[i]);
+        }
+        h0[i] = gf4_poly_init_zero(capacity);
+        h1[i] = gf4_poly_init_zero(capacity);
+        inverse[i] = gf4_poly_init_zero(2 * capacity);
+        prefix[i] = gf4_poly_init_zero(2 * capacity);
+        random_weighted_gf4_array(&h0[i].coefficients, block_size, block_weight);
+        gf4_poly_adjust_degree(&h0[i], block_size - 1);
+        contexts_draw_h1(&h1[i], block_size, block_weight);
+        random_get_state(&states[i]);
+    }
+
+    // prefix[i] = h1[0] * ... * h1[i], one inversion of the product of all candidates
+    gf4_poly_copy(&prefix[0], &h1[0]);
+    for (size_t i = 1; i < num_keys; ++i) {
+        contexts_mul_mod(&prefix[i], &h1[i], &prefix[i - 1], block_size);
+    }
+    gf4_poly_t acc = gf4_poly_init_zero(2 * capacity);
+    gf4_poly_workspace_t ws;
+    gf4_poly_workspace_init(&ws, GF4_POLY_INVERT_WS_POLYS, capacity);
+    if (gf4_poly_invert_ws(&acc, &prefix[num_keys - 1], &modulus, &ws)) {
+        // acc = (h1[0] * ... * h1[i])^-1
+        gf4_poly_t tmp = gf4_poly_init_zero(2 * capacity);
+        for (size_t i = num_keys - 1; i > 0; --i) {
+            contexts_mul_mod(&inverse[i], &acc, &prefix[i - 1], block_size);
+            contexts_mul_mod(&tmp, &h1[i], &acc, block_size);
+            gf4_poly_copy(&acc, &tmp);
+        }
+        gf4_poly_copy(&inverse[0], &acc);
+        gf4_poly_deinit(&tmp);
+    } else {
+        // some candidate is not invertible, fall back to inverting every key pair separately
+        for (size_t i = 0; i < num_keys; ++i) {
+            if (NULL != seeds) {
+                random_set_state(&states[i]);
             }
+            contexts_invert_h1(&inverse[i], &h1[i], &modulus, block_size, block_weight, &ws);
+        }
+    }
+    gf4_poly_deinit(&acc);
+    gf4_poly_workspace_deinit(&ws);
+    if (NULL != seeds) {
+        random_set_state(&saved_state);
+    }
+
+    for (size_t i = 0; i < num_keys; ++i) {
+        contexts_finish(&out_enc_ctx[i], &out_dec_ctx[i], &h0[i], &h1[i], &inverse[i], &modulus, block_size);
+        gf4_poly_deinit(&inverse[i]);
+        gf4_poly_deinit(&prefix[i]);
+    }
+    gf4_poly_deinit(&modulus);
+    free(h0);
+    free(h1);
+    free(inverse);
+    free(prefix);
+    free(states);
+}
+
+void contexts_seed_from_u64(contexts_seed_t * out_seed, uint64_t value) {
+    assert(NULL != out_seed);
+    random_state_t state;
+    random_expand_seed(value, &state);
+    memcpy(out_seed->bytes, state.s, CONTEXTS_SEED_SIZE);
+}
+
+void contexts_seed_random(contexts_seed_t * out_seed) {
+    assert(NULL != out_seed);
+    random_state_t state;
+    for (size_t i = 0; i < 4; ++i) {
+        state.s[i] = random_u64();
+    }
+    memcpy(out_seed->bytes, state.s, CONTEXTS_SEED_SIZE);
+}
+
+void contexts_seed_to_hex(contexts_seed_t * seed, char * out_str) {
+    assert(NULL != seed);
+    assert(NULL != out_str);
+    for (size_t i = 0; i < CONTEXTS_SEED_SIZE; ++i) {
+        sprintf(out_str + 2 * i, "%02x", seed->bytes[i]);
+    }
+}
+
+static int contexts_hex_digit(char c) {
+    if ('0' <= c && c <= '9') {
+        return c - '0';
+    } else if ('a' <= c && c <= 'f') {
+        return c - 'a' + 10;
+    } else if ('A' <= c && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool contexts_seed_from_hex(const char * str, contexts_seed_t * out_seed) {
+    assert(NULL != str);
+    assert(NULL != out_seed);
+    if (2 * CONTEXTS_SEED_SIZE != strlen(str)) {
+        return false;
+    }
+    for (size_t i = 0; i < CONTEXTS_SEED_SIZE; ++i) {
+        int high = contexts_hex_digit(str[2 * i]);
+        int low = contexts_hex_digit(str[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out_seed->bytes[i] = (uint8_t)(16 * high + low);
+    }
+    return true;
+}
+
+static void contexts_check_seed(contexts_seed_t * seed, const char * caller) {
+    if (contexts_seed_is_zero(seed)) {
+        fprintf(stderr, "%s: Seed must not be zero!\n", caller);
+        exit(-1);
+    }
+}
+
+static void contexts_cache_path(char * out_path, contexts_seed_t * seed, size_t block_size, size_t block_weight, const char * cache_dirname) {
+    char hex[2 * CONTEXTS_SEED_SIZE + 1];
+    contexts_seed_to_hex(seed, hex);
+    int length = snprintf(out_path, CONTEXTS_PATH_LENGTH, "%s/seed_%s_%zu_%zu.bin", cache_dirname, hex, block_size, block_weight);
+    if (length < 0 || length >= CONTEXTS_PATH_LENGTH) {
+        fprintf(stderr, "%s: Cache path is too long!\n", __func__);
+        exit(-1);
+    }
+}
+
+static void contexts_cache_store(const char * path, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx, const char * cache_dirname) {
+    if (0 != mkdir(cache_dirname, 0755) && EEXIST != errno) {
+        fprintf(stderr, "%s: Cache directory %s couldn't be created!\n", __func__, cache_dirname);
+        exit(-1);
+    }
+    char tmp_path[CONTEXTS_PATH_LENGTH + 32];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%ld", path, (long)getpid());
+    contexts_save_binary(tmp_path, enc_ctx, dec_ctx, false);
+    if (0 != rename(tmp_path, path)) {
+        fprintf(stderr, "%s: Cache file %s couldn't be written!\n", __func__, path);
+        exit(-1);
+    }
+}
 
-            // second_block_G_poly = (h0_poly * inverse) % modulus ;
-            gf4_poly_zero_out(&tmp);
-            gf4_poly_zero_out(&rem);
-            gf4_poly_zero_out(&div);
-            gf4_poly_mul(&tmp, &h0, &maybe_inverse);
-            gf4_poly_div_rem(&div, &rem, &tmp, &modulus);
-            gf4_poly_deinit(&tmp);
-            gf4_poly_deinit(&div);
-            out_enc_ctx->block_size = block_size;
-            out_enc_ctx->second_block_G = rem;
-            out_dec_ctx->block_size = block_size;
-            out_dec_ctx->h0 = h0;
-            out_dec_ctx->h1 = h1;
-            gf4_poly_deinit(&modulus);
-            gf4_poly_deinit(&maybe_inverse);
+void contexts_init_from_seed(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, contexts_seed_t * seed,
+                             size_t block_size, size_t block_weight, const char * cache_dirname) {
+    assert(NULL != out_enc_ctx);
+    assert(NULL != out_dec_ctx);
+    assert(NULL != seed);
+
+    char path[CONTEXTS_PATH_LENGTH];
+    if (NULL != cache_dirname) {
+        contexts_cache_path(path, seed, block_size, block_weight, cache_dirname);
+        if (contexts_is_binary(path)) {
+            contexts_load(path, out_enc_ctx, out_dec_ctx);
             return;
         }
-        gf4_poly_zero_out(&maybe_inverse);
-        gf4_poly_zero_out(&h1);
-        repetitions++;
-        if (repetitions > 20) {
-            random_force_reseed();
-            repetitions = 0;
+    }
+
+    // expand
+    random_state_t saved_state, seed_state;
+    random_get_state(&saved_state);
+    contexts_check_seed(seed, __func__);
+    memcpy(seed_state.s, seed->bytes, CONTEXTS_SEED_SIZE);
+    random_set_state(&seed_state);
+    contexts_init(out_enc_ctx, out_dec_ctx, block_size, block_weight);
+    random_set_state(&saved_state);
+
+    if (NULL != cache_dirname) {
+        contexts_cache_store(path, out_enc_ctx, out_dec_ctx, cache_dirname);
+    }
+}
+
+void contexts_init_from_seeds(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, contexts_seed_t * seeds,
+                              size_t num_keys, size_t block_size, size_t block_weight, const char * cache_dirname) {
+    assert(NULL != out_enc_ctx);
+    assert(NULL != out_dec_ctx);
+    assert(NULL != seeds || 0 == num_keys);
+    if (0 == num_keys) {
+        return;
+    }
+
+    // key pairs missing from the cache are expanded in one batch and moved to their places afterwards
+    size_t * missing = malloc(num_keys * sizeof(size_t));
+    contexts_seed_t * missing_seeds = malloc(num_keys * sizeof(contexts_seed_t));
+    encoding_context_t * enc_ctx = malloc(num_keys * sizeof(encoding_context_t));
+    decoding_context_t * dec_ctx = malloc(num_keys * sizeof(decoding_context_t));
+    if (NULL == missing || NULL == missing_seeds || NULL == enc_ctx || NULL == dec_ctx) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    char path[CONTEXTS_PATH_LENGTH];
+    size_t num_missing = 0;
+    for (size_t i = 0; i < num_keys; ++i) {
+        if (NULL != cache_dirname) {
+            contexts_cache_path(path, &seeds[i], block_size, block_weight, cache_dirname);
+            if (contexts_is_binary(path)) {
+                contexts_load(path, &out_enc_ctx[i], &out_dec_ctx[i]);
+                continue;
+            }
+        }
+        contexts_check_seed(&seeds[i], __func__);
+        missing[num_missing] = i;
+        missing_seeds[num_missing] = seeds[i];
+        ++num_missing;
+    }
+    contexts_init_batch(enc_ctx, dec_ctx, missing_seeds, num_missing, block_size, block_weight);
+    for (size_t j = 0; j < num_missing; ++j) {
+        size_t i = missing[j];
+        out_enc_ctx[i] = enc_ctx[j];
+        out_dec_ctx[i] = dec_ctx[j];
+        if (NULL != cache_dirname) {
+            contexts_cache_path(path, &seeds[i], block_size, block_weight, cache_dirname);
+            contexts_cache_store(path, &out_enc_ctx[i], &out_dec_ctx[i], cache_dirname);
         }
     }
+    free(missing);
+    free(missing_seeds);
+    free(enc_ctx);
+    free(dec_ctx);
+}
+
+void contexts_seeds_save(const char * filename, contexts_seed_t * seeds, size_t num_seeds, size_t block_size, size_t block_weight) {
+    assert(NULL != filename);
+    assert(NULL != seeds || 0 == num_seeds);
+    FILE * output = fopen(filename, "w");
+    if (NULL == output) {
+        fprintf(stderr, "%s: Output file couldn't be created!\n", __func__);
+        exit(-1);
+    }
+    fprintf(output, "%zu %zu\n", block_size, block_weight);
+    char hex[2 * CONTEXTS_SEED_SIZE + 1];
+    for (size_t i = 0; i < num_seeds; ++i) {
+        contexts_seed_to_hex(&seeds[i], hex);
+        fprintf(output, "%s\n", hex);
+    }
+    fclose(output);
+}
+
+void contexts_seeds_load(const char * filename, contexts_seed_t ** out_seeds, size_t * out_num_seeds, size_t * out_block_size, size_t * out_block_weight) {
+    assert(NULL != filename);
+    assert(NULL != out_seeds);
+    assert(NULL != out_num_seeds);
+    assert(NULL != out_block_size);
+    assert(NULL != out_block_weight);
+    FILE * input = fopen(filename, "r");
+    if (NULL == input) {
+        fprintf(stderr, "%s: Input file %s doesn't exist!\n", __func__, filename);
+        exit(-1);
+    }
+    if (2 != fscanf(input, "%zu %zu", out_block_size, out_block_weight)) {
+        fprintf(stderr, "%s: Input file %s is not a seed file!\n", __func__, filename);
+        exit(-1);
+    }
+    size_t capacity = 16;
+    size_t count = 0;
+    contexts_seed_t * seeds = malloc(capacity * sizeof(contexts_seed_t));
+    char hex[2 * CONTEXTS_SEED_SIZE + 2];
+    while (NULL != seeds && 1 == fscanf(input, "%65s", hex)) {
+        if (count == capacity) {
+            capacity *= 2;
+            contexts_seed_t * tmp = realloc(seeds, capacity * sizeof(contexts_seed_t));
+            if (NULL == tmp) {
+                free(seeds);
+                seeds = NULL;
+                break;
+            }
+            seeds = tmp;
+        }
+        if (!contexts_seed_from_hex(hex, &seeds[count]) || contexts_seed_is_zero(&seeds[count])) {
+            fprintf(stderr, "%s: Invalid seed %s in %s!\n", __func__, hex, filename);
+            exit(-1);
+        }
+        ++count;
+    }
+    if (NULL == seeds) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    fclose(input);
+    *out_seeds = seeds;
+    *out_num_seeds = count;
 }
 
 void contexts_deinit(encoding_context_t * enc_ctx, decoding_context_t * dec_ctx) {
@@ -160,6 +578,16 @@ void contexts_load(const char * filename, encoding_context_t * enc_ctx, decoding
     assert(NULL != enc_ctx);
     assert(NULL != dec_ctx);
 
+    if (contexts_is_binary(filename)) {
+        contexts_store_t store;
+        contexts_view_t view;
+        contexts_store_open(&store, filename);
+        contexts_store_get(&store, 0, &view);
+        contexts_load_view(&view, enc_ctx, dec_ctx);
+        contexts_store_close(&store);
+        return;
+    }
+
     FILE * input = fopen(filename, "r");
     if (NULL == input) {
         fprintf(stderr, "contexts_load: Input file doesn't exist!\n");
@@ -170,6 +598,8 @@ void contexts_load(const char * filename, encoding_context_t * enc_ctx, decoding
 
     enc_ctx->block_size = block_size;
     dec_ctx->block_size = block_size;
+    enc_ctx->arena = NULL;
+    dec_ctx->arena = NULL;
     enc_ctx->second_block_G = gf4_poly_init_zero(block_size);
     dec_ctx->h0 = gf4_poly_init_zero(block_size);
     dec_ctx->h1 = gf4_poly_init_zero(block_size);
@@ -208,4 +638,229 @@ void contexts_load(const char * filename, encoding_context_t * enc_ctx, decoding
     }
 
     fclose(input);
-}
\ No newline at end of file
+}
+
+// size of a record of a key pair with the given parameters
+static size_t contexts_record_size(size_t block_size, size_t h0_weight, size_t h1_weight) {
+    return CONTEXTS_HEADER_SIZE
+           + CONTEXTS_ALIGN((block_size + 3) / 4)
+           + CONTEXTS_ALIGN(h0_weight * sizeof(uint32_t)) + CONTEXTS_ALIGN(h0_weight)
+           + CONTEXTS_ALIGN(h1_weight * sizeof(uint32_t)) + CONTEXTS_ALIGN(h1_weight);
+}
+
+// write sparse representation of poly to buffer, return the number of written bytes
+static size_t contexts_write_sparse(uint8_t * buffer, gf4_poly_t * poly, size_t block_size, size_t weight) {
+    uint32_t * indices = (uint32_t *)buffer;
+    uint8_t * values = buffer + CONTEXTS_ALIGN(weight * sizeof(uint32_t));
+    size_t pos = 0;
+    for (size_t i = 0; i < block_size && i < poly->coefficients.capacity; ++i) {
+        if (0 != poly->coefficients.array[i]) {
+            indices[pos] = (uint32_t)i;
+            values[pos] = poly->coefficients.array[i];
+            ++pos;
+        }
+    }
+    assert(pos == weight);
+    return CONTEXTS_ALIGN(weight * sizeof(uint32_t)) + CONTEXTS_ALIGN(weight);
+}
+
+void contexts_save_binary(const char * filename, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx, bool append) {
+    assert(NULL != filename);
+    assert(NULL != enc_ctx);
+    assert(NULL != dec_ctx);
+    assert(enc_ctx->block_size == dec_ctx->block_size);
+    assert(enc_ctx->block_size <= UINT32_MAX);
+
+    size_t block_size = enc_ctx->block_size;
+    size_t h0_weight = gf4_array_hamming_weight(&dec_ctx->h0.coefficients);
+    size_t h1_weight = gf4_array_hamming_weight(&dec_ctx->h1.coefficients);
+    size_t record_size = contexts_record_size(block_size, h0_weight, h1_weight);
+    uint8_t * record = calloc(record_size, 1);
+    if (NULL == record) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+
+    // header
+    uint64_t header[CONTEXTS_HEADER_SIZE / sizeof(uint64_t)] = {0, CONTEXTS_BINARY_VERSION, block_size, h0_weight, h1_weight, record_size};
+    memcpy(header, CONTEXTS_BINARY_MAGIC, strlen(CONTEXTS_BINARY_MAGIC));
+    memcpy(record, header, CONTEXTS_HEADER_SIZE);
+    size_t offset = CONTEXTS_HEADER_SIZE;
+
+    // packed G
+    for (size_t i = 0; i < block_size && i < enc_ctx->second_block_G.coefficients.capacity; ++i) {
+        record[offset + i / 4] |= (uint8_t)((enc_ctx->second_block_G.coefficients.array[i] & 3) << (2 * (i % 4)));
+    }
+    offset += CONTEXTS_ALIGN((block_size + 3) / 4);
+
+    // sparse H
+    offset += contexts_write_sparse(record + offset, &dec_ctx->h0, block_size, h0_weight);
+    offset += contexts_write_sparse(record + offset, &dec_ctx->h1, block_size, h1_weight);
+    assert(offset == record_size);
+
+    FILE * output = fopen(filename, append ? "ab" : "wb");
+    if (NULL == output) {
+        fprintf(stderr, "%s: Output file couldn't be created!\n", __func__);
+        exit(-1);
+    }
+    if (1 != fwrite(record, record_size, 1, output)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+    fclose(output);
+    free(record);
+}
+
+bool contexts_is_binary(const char * filename) {
+    assert(NULL != filename);
+    FILE * input = fopen(filename, "rb");
+    if (NULL == input) {
+        return false;
+    }
+    char magic[8] = {0};
+    bool is_binary = 1 == fread(magic, sizeof(magic), 1, input) && 0 == strncmp(magic, CONTEXTS_BINARY_MAGIC, sizeof(magic));
+    fclose(input);
+    return is_binary;
+}
+
+void contexts_convert_to_binary(const char * in_filename, const char * out_filename, bool append) {
+    assert(NULL != in_filename);
+    assert(NULL != out_filename);
+    encoding_context_t ec;
+    decoding_context_t dc;
+    contexts_load(in_filename, &ec, &dc);
+    contexts_save_binary(out_filename, &ec, &dc, append);
+    contexts_deinit(&ec, &dc);
+}
+
+void contexts_store_open(contexts_store_t * store, const char * filename) {
+    assert(NULL != store);
+    assert(NULL != filename);
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: Input file %s doesn't exist!\n", __func__, filename);
+        exit(-1);
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st) || 0 == st.st_size) {
+        fprintf(stderr, "%s: Input file %s is empty!\n", __func__, filename);
+        exit(-1);
+    }
+    store->size = (size_t)st.st_size;
+    void * data = mmap(NULL, store->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data) {
+        fprintf(stderr, "%s: Input file %s couldn't be mapped!\n", __func__, filename);
+        exit(-1);
+    }
+    store->data = data;
+
+    // walk the record headers
+    size_t capacity = 16;
+    store->num_keys = 0;
+    store->offsets = malloc(capacity * sizeof(size_t));
+    if (NULL == store->offsets) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    size_t offset = 0;
+    while (offset < store->size) {
+        const uint64_t * header = (const uint64_t *)(store->data + offset);
+        if (store->size - offset < CONTEXTS_HEADER_SIZE
+            || 0 != strncmp((const char *)header, CONTEXTS_BINARY_MAGIC, 8)
+            || CONTEXTS_BINARY_VERSION != header[1]
+            || header[5] != contexts_record_size(header[2], header[3], header[4])
+            || header[5] > store->size - offset) {
+            fprintf(stderr, "%s: Input file %s is not a valid binary key file!\n", __func__, filename);
+            exit(-1);
+        }
+        if (store->num_keys == capacity) {
+            capacity *= 2;
+            size_t * offsets = realloc(store->offsets, capacity * sizeof(size_t));
+            if (NULL == offsets) {
+                fprintf(stderr, "%s: Allocation error!\n", __func__);
+                exit(-1);
+            }
+            store->offsets = offsets;
+        }
+        store->offsets[store->num_keys++] = offset;
+        offset += header[5];
+    }
+}
+
+void contexts_store_get(contexts_store_t * store, size_t index, contexts_view_t * out_view) {
+    assert(NULL != store);
+    assert(NULL != out_view);
+    assert(index < store->num_keys);
+    const uint8_t * record = store->data + store->offsets[index];
+    const uint64_t * header = (const uint64_t *)record;
+    out_view->block_size = header[2];
+    out_view->h0_weight = header[3];
+    out_view->h1_weight = header[4];
+    size_t offset = CONTEXTS_HEADER_SIZE;
+    out_view->packed_G = record + offset;
+    offset += CONTEXTS_ALIGN((out_view->block_size + 3) / 4);
+    out_view->h0_indices = (const uint32_t *)(record + offset);
+    offset += CONTEXTS_ALIGN(out_view->h0_weight * sizeof(uint32_t));
+    out_view->h0_values = record + offset;
+    offset += CONTEXTS_ALIGN(out_view->h0_weight);
+    out_view->h1_indices = (const uint32_t *)(record + offset);
+    offset += CONTEXTS_ALIGN(out_view->h1_weight * sizeof(uint32_t));
+    out_view->h1_values = record + offset;
+}
+
+void contexts_store_close(contexts_store_t * store) {
+    assert(NULL != store);
+    munmap((void *)store->data, store->size);
+    free(store->offsets);
+    store->data = NULL;
+    store->offsets = NULL;
+    store->num_keys = 0;
+}
+
+// indices of a valid record are strictly increasing and the values are nonzero symbols of GF(4)
+static void contexts_load_sparse(gf4_poly_t * poly, const uint32_t * indices, const uint8_t * values, size_t weight, size_t block_size) {
+    for (size_t i = 0; i < weight; ++i) {
+        if (indices[i] >= block_size) {
+            fprintf(stderr, "%s: Corrupted key, index %u out of range!\n", __func__, indices[i]);
+            exit(-1);
+        }
+        if (0 < i && indices[i] <= indices[i - 1]) {
+            fprintf(stderr, "%s: Corrupted key, index %u not in increasing order!\n", __func__, indices[i]);
+            exit(-1);
+        }
+        if (0 == values[i] || values[i] > GF4_MAX_VALUE) {
+            fprintf(stderr, "%s: Corrupted key, invalid value %u at index %u!\n", __func__, (unsigned)values[i], indices[i]);
+            exit(-1);
+        }
+        poly->coefficients.array[indices[i]] = values[i];
+        poly->degree = indices[i];
+    }
+}
+
+void contexts_load_view(contexts_view_t * view, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx) {
+    assert(NULL != view);
+    assert(NULL != enc_ctx);
+    assert(NULL != dec_ctx);
+    size_t block_size = view->block_size;
+    enc_ctx->block_size = block_size;
+    enc_ctx->arena = NULL;
+    dec_ctx->block_size = block_size;
+    dec_ctx->threshold = NULL;
+    dec_ctx->arena = NULL;
+    dec_ctx->elapsed_iterations = 0;
+    dec_ctx->delta_setting = -1;
+    enc_ctx->second_block_G = gf4_poly_init_zero(block_size);
+    dec_ctx->h0 = gf4_poly_init_zero(block_size);
+    dec_ctx->h1 = gf4_poly_init_zero(block_size);
+
+    gf4_t * G = enc_ctx->second_block_G.coefficients.array;
+    for (size_t i = 0; i < block_size; ++i) {
+        G[i] = (gf4_t)((view->packed_G[i / 4] >> (2 * (i % 4))) & 3);
+        if (0 != G[i]) {
+            enc_ctx->second_block_G.degree = i;
+        }
+    }
+    contexts_load_sparse(&dec_ctx->h0, view->h0_indices, view->h0_values, view->h0_weight, block_size);
+    contexts_load_sparse(&dec_ctx->h1, view->h1_indices, view->h1_values, view->h1_weight, block_size);
+}
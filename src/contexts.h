@@ -28,6 +28,7 @@
 #define MDPC_GF4_CONTEXTS_H
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <inttypes.h>
 #include "gf4.h"
 #include "gf4_poly.h"
@@ -47,6 +48,7 @@
 typedef struct {
     gf4_poly_t second_block_G; ///< polynomial representing the first row of the second block of matrix G, not transposed
     size_t block_size; ///< size of the circulant block
+    gf4_arena_t * arena; ///< arena for the temporaries of enc_encrypt, not owned, NULL allocates them in every call
 #ifdef WRITE_WEIGHTS
         size_t index; ///< index to distinguish various runs of experiments
 #endif
@@ -67,17 +69,62 @@ typedef struct {
     size_t block_size; ///< size of the circulant block
     long delta_setting; ///< setting for the parameter delta used by some decoders
     long (*threshold)(long); ///< function to calculate the threshold based on syndrome weight used by some decoders
+    gf4_arena_t * arena; ///< arena for the temporaries of the decoders, not owned, NULL allocates them in every call
 #ifdef WRITE_WEIGHTS
     size_t index; ///< index to distinguish various runs of experiments
 #endif
     size_t elapsed_iterations; ///< number of elapsed iterations during decoding, may be set by some decoders
 } decoding_context_t;
 
+#define CONTEXTS_BINARY_MAGIC "MDPCKEY"
+#define CONTEXTS_BINARY_VERSION 1
+#define CONTEXTS_SEED_SIZE 32 ///< size of a compressed private key in bytes
+#define CONTEXTS_BATCH_SIZE 16 ///< number of key pairs sharing one inversion when expanding many seeds, see contexts_init_batch
+
+/**
+ * @brief Compressed key pair.
+ *
+ * The seed is the initial state of the random generator used by contexts_init,
+ * so the key pair can be expanded deterministically from it, see contexts_init_from_seed.
+ */
+typedef struct {
+    uint8_t bytes[CONTEXTS_SEED_SIZE]; ///< state of the random generator in native byte order
+} contexts_seed_t;
+
+/**
+ * @brief Read-only view of a key pair stored in a memory-mapped binary key file.
+ *
+ * All pointers point directly into the mapping, no data is copied.
+ * The view is valid while the store it comes from is open.
+ */
+typedef struct {
+    size_t block_size; ///< size of the circulant block
+    const uint8_t * packed_G; ///< second_block_G, 4 coefficients per byte, coefficient i in bits 2*(i%4), 2*(i%4)+1 of byte i/4
+    size_t h0_weight; ///< number of nonzero coefficients of h0
+    const uint32_t * h0_indices; ///< indices of nonzero coefficients of h0 in ascending order
+    const uint8_t * h0_values; ///< values of nonzero coefficients of h0
+    size_t h1_weight; ///< number of nonzero coefficients of h1
+    const uint32_t * h1_indices; ///< indices of nonzero coefficients of h1 in ascending order
+    const uint8_t * h1_values; ///< values of nonzero coefficients of h1
+} contexts_view_t;
+
+/**
+ * @brief Memory-mapped binary key file containing one or more key pairs.
+ */
+typedef struct {
+    const uint8_t * data; ///< mapped file
+    size_t size; ///< size of the mapped file in bytes
+    size_t num_keys; ///< number of key pairs in the file
+    size_t * offsets; ///< offsets of the records of the key pairs
+} contexts_store_t;
+
 /**
  * @brief Generate contexts for encoding and decoding.
  *
  * generate polynomials h0 and h1 st. hamming weight of h0 (and also h1) is equal to block_weight.
  * generated polynomial h1 will be invertible mod (x^block_size + 1). h0 and h1 are used for decoding.
+ * Candidates for h1 that fail contexts_invertibility_precheck are redrawn without attempting the inversion.
+ * The inverse is verified by computing the whole product h1 * h1^-1.
  * polynomial for encoding is calculated as follows: (h0 * h1^-1) mod (x^block_size + 1).
  * This function will allocate memory for the polynomials. Do not initialize polynomials in out_enc_ctx and
  * out_dec_ctx yourself!
@@ -92,6 +139,155 @@ typedef struct {
  */
 void contexts_init(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, size_t block_size, size_t block_weight);
 
+/**
+ * @brief Check whether contexts_invertibility_precheck decides invertibility exactly for the given block size.
+ *
+ * That is the case if block_size is a prime and 2 is a primitive root modulo block_size (e.g. 2293, 2339).
+ * Then x^block_size + 1 = (x + 1) * Phi(x) over GF(2) with Phi = 1 + x + ... + x^(block_size - 1) irreducible,
+ * and Phi splits into two conjugate irreducible factors over GF(4).
+ *
+ * @param block_size size of the circulant block
+ * @return true if the precheck is exact, false if it only detects divisibility by (x + 1)
+ */
+bool contexts_has_exact_precheck(size_t block_size);
+
+/**
+ * @brief Cheap test of invertibility of h1 modulo (x^block_size + 1).
+ *
+ * h1 is not invertible if the sum of its coefficients is zero. For block sizes accepted by contexts_has_exact_precheck,
+ * h1 is invertible if and only if additionally its norm h1 * conj(h1), which has binary coefficients,
+ * is not divisible by Phi, i.e. it is not 1 + x + ... + x^(block_size - 1) modulo (x^block_size + 1).
+ * The norm of a sparse h1 is computed in O(weight^2) instead of O(block_size^2) needed by the inversion.
+ *
+ * @param h1 polynomial of degree less than block_size
+ * @param block_size size of the circulant block
+ * @return false if h1 is certainly not invertible, true if it is invertible (exact precheck) or may be invertible
+ */
+bool contexts_invertibility_precheck(gf4_poly_t * h1, size_t block_size);
+
+/**
+ * @brief Generate several contexts at once using a single inversion.
+ *
+ * Montgomery's trick: h1 of all key pairs are multiplied together, the product is inverted and the inverses
+ * of the individual h1 are recovered using 3 * (num_keys - 1) multiplications mod (x^block_size + 1).
+ * If the product is not invertible, every h1 is inverted (and redrawn if necessary) separately.
+ *
+ * If seeds is not NULL, key pair i is the same as the one generated by contexts_init_from_seed from seeds[i]
+ * and the state of the random generator is restored afterwards. Otherwise the key pairs are drawn
+ * from the current state of the random generator.
+ *
+ * @see contexts_deinit
+ *
+ * @param out_enc_ctx array of num_keys encoding contexts
+ * @param out_dec_ctx array of num_keys decoding contexts
+ * @param seeds array of num_keys nonzero seeds, may be NULL
+ * @param num_keys number of key pairs to generate
+ * @param block_size size of the circulant block of the matrices H, G
+ * @param block_weight hamming weight of each row/columns of the circulant blocks of H and G
+ */
+void contexts_init_batch(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, contexts_seed_t * seeds,
+                         size_t num_keys, size_t block_size, size_t block_weight);
+
+/**
+ * @brief Set seed to the key pair that contexts_init generates after random_seed(value).
+ *
+ * @param out_seed memory location to store the seed to
+ * @param value 64-bit seed, e.g. derived using random_derive_seed
+ */
+void contexts_seed_from_u64(contexts_seed_t * out_seed, uint64_t value);
+
+/**
+ * @brief Draw a fresh seed from the random generator.
+ *
+ * @param out_seed memory location to store the seed to
+ */
+void contexts_seed_random(contexts_seed_t * out_seed);
+
+/**
+ * @brief Write seed as 64 hexadecimal digits (and a terminating null byte) to out_str.
+ *
+ * @param seed a seed
+ * @param out_str buffer of at least 2 * CONTEXTS_SEED_SIZE + 1 bytes
+ */
+void contexts_seed_to_hex(contexts_seed_t * seed, char * out_str);
+
+/**
+ * @brief Parse a seed written by contexts_seed_to_hex.
+ *
+ * @param str string to parse
+ * @param out_seed memory location to store the seed to
+ * @return true if str consists of exactly 64 hexadecimal digits, false otherwise
+ */
+bool contexts_seed_from_hex(const char * str, contexts_seed_t * out_seed);
+
+/**
+ * @brief Generate contexts deterministically from a seed.
+ *
+ * Same as contexts_init with the random generator set to the seed. The state of the random generator
+ * is restored afterwards, so the caller's random stream is not affected.
+ *
+ * If cache_dirname is not NULL, the expanded key pair is looked up in the directory first
+ * (file seed_HEX_BLOCKSIZE_BLOCKWEIGHT.bin, binary format of contexts_save_binary) and stored there
+ * after expansion otherwise. The cache file is written to a temporary file and renamed,
+ * so several processes may share one cache directory.
+ *
+ * @see contexts_deinit
+ *
+ * @param out_enc_ctx memory location to store encoding polynomials and parameters to
+ * @param out_dec_ctx memory location to store decoding polynomials and parameters to
+ * @param seed seed of the key pair
+ * @param block_size size of the circulant block of the matrices H, G
+ * @param block_weight hamming weight of each row/columns of the circulant blocks of H and G
+ * @param cache_dirname directory of the expansion cache, NULL disables the cache
+ */
+void contexts_init_from_seed(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, contexts_seed_t * seed,
+                             size_t block_size, size_t block_weight, const char * cache_dirname);
+
+/**
+ * @brief Generate contexts deterministically from several seeds.
+ *
+ * Key pair i is the same as the one generated by contexts_init_from_seed from seeds[i], including the use
+ * of the expansion cache. The key pairs missing from the cache are expanded together using contexts_init_batch.
+ *
+ * @see contexts_deinit
+ *
+ * @param out_enc_ctx array of num_keys encoding contexts
+ * @param out_dec_ctx array of num_keys decoding contexts
+ * @param seeds array of num_keys seeds
+ * @param num_keys number of key pairs to generate
+ * @param block_size size of the circulant block of the matrices H, G
+ * @param block_weight hamming weight of each row/columns of the circulant blocks of H and G
+ * @param cache_dirname directory of the expansion cache, NULL disables the cache
+ */
+void contexts_init_from_seeds(encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx, contexts_seed_t * seeds,
+                              size_t num_keys, size_t block_size, size_t block_weight, const char * cache_dirname);
+
+/**
+ * @brief Save seeds of key pairs to a text file.
+ *
+ * The first line contains block size and block weight, every other line one seed in hexadecimal.
+ *
+ * @param filename savefile path
+ * @param seeds array of seeds
+ * @param num_seeds number of seeds
+ * @param block_size size of the circulant block
+ * @param block_weight hamming weight of the circulant block
+ */
+void contexts_seeds_save(const char * filename, contexts_seed_t * seeds, size_t num_seeds, size_t block_size, size_t block_weight);
+
+/**
+ * @brief Load seeds saved by contexts_seeds_save.
+ *
+ * Allocates *out_seeds, free it using free() if no longer needed. Exits on an invalid or zero seed.
+ *
+ * @param filename savefile path
+ * @param out_seeds memory location to store the allocated array of seeds to
+ * @param out_num_seeds memory location to store the number of seeds to
+ * @param out_block_size memory location to store the block size to
+ * @param out_block_weight memory location to store the block weight to
+ */
+void contexts_seeds_load(const char * filename, contexts_seed_t ** out_seeds, size_t * out_num_seeds, size_t * out_block_size, size_t * out_block_weight);
+
 /**
  * @brief Deinit contexts.
  *
@@ -112,8 +308,10 @@ void contexts_deinit(encoding_context_t * enc_ctx, decoding_context_t * dec_ctx)
 void contexts_save(const char * filename, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx);
 
 /**
- * @brief Load matrices G and H to a file.
+ * @brief Load matrices G and H from a file.
  *
+ * Both the text format of contexts_save and the binary format of contexts_save_binary are accepted,
+ * the first key pair of a binary file is loaded.
  * Allocates all the necessary memory for enc_ctx and dec_ctx. Do not allocate them yourself!
  * Do not call contexts_init with the same enc_ctx and dec_ctx!
  *
@@ -124,4 +322,75 @@ void contexts_save(const char * filename, encoding_context_t * enc_ctx, decoding
  * @param dec_ctx memory location of the decoding context
  */
 void contexts_load(const char * filename, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx);
+
+/**
+ * @brief Save matrices G and H to a binary key file.
+ *
+ * The record consists of a 48 byte header (8 byte magic, version, block size, weights of h0 and h1
+ * and size of the record, all 64-bit integers in native byte order), second_block_G packed to 2 bits
+ * per coefficient and sparse lists of 32-bit indices and 8-bit values of h0 and h1.
+ * Every part starts at an offset divisible by 8. A file may contain several records, see contexts_store_open.
+ *
+ * @param filename savefile path
+ * @param enc_ctx memory location of the encoding context
+ * @param dec_ctx memory location of the decoding context
+ * @param append true to append the record to an existing key file, false to overwrite the file
+ */
+void contexts_save_binary(const char * filename, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx, bool append);
+
+/**
+ * @brief Check whether a file is a binary key file.
+ *
+ * @param filename path of the file
+ * @return true if the file starts with CONTEXTS_BINARY_MAGIC, false otherwise
+ */
+bool contexts_is_binary(const char * filename);
+
+/**
+ * @brief Convert a key file in the text format of contexts_save to the binary format.
+ *
+ * @param in_filename text key file
+ * @param out_filename binary key file
+ * @param append true to append the key pair to an existing binary key file, false to overwrite the file
+ */
+void contexts_convert_to_binary(const char * in_filename, const char * out_filename, bool append);
+
+/**
+ * @brief Map a binary key file to memory.
+ *
+ * Only the record headers are read. Opened store must be closed using contexts_store_close function!
+ *
+ * @param store memory location of the store
+ * @param filename binary key file
+ */
+void contexts_store_open(contexts_store_t * store, const char * filename);
+
+/**
+ * @brief Get a view of a key pair without copying it.
+ *
+ * @param store an opened store
+ * @param index index of the key pair, index < store->num_keys
+ * @param out_view memory location to store the view to
+ */
+void contexts_store_get(contexts_store_t * store, size_t index, contexts_view_t * out_view);
+
+/**
+ * @brief Unmap the key file.
+ *
+ * @param store an opened store
+ */
+void contexts_store_close(contexts_store_t * store);
+
+/**
+ * @brief Create contexts from a view.
+ *
+ * Allocates all the necessary memory for enc_ctx and dec_ctx, same as contexts_load.
+ *
+ * @see contexts_deinit
+ *
+ * @param view a valid view
+ * @param enc_ctx memory location of the encoding context
+ * @param dec_ctx memory location of the decoding context
+ */
+void contexts_load_view(contexts_view_t * view, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx);
 #endif // MDPC_GF4_CONTEXTS_H
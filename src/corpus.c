@@ -0,0 +1,190 @@
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "corpus.h"
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CORPUS_ENTRY_FIELDS 8
+
+static void corpus_failures_path(char * out_path, const char * dirname) {
+    int length = snprintf(out_path, CORPUS_PATH_LENGTH, "%s/%s", dirname, CORPUS_FAILURES_FILENAME);
+    if (length < 0 || length >= CORPUS_PATH_LENGTH) {
+        fprintf(stderr, "%s: Corpus path is too long!\n", __func__);
+        exit(-1);
+    }
+}
+
+void corpus_key_path(char * out_path, const char * dirname, uint64_t seed, uint64_t key) {
+    assert(NULL != out_path);
+    assert(NULL != dirname);
+    int length = snprintf(out_path, CORPUS_PATH_LENGTH, "%s/key_%llu_%llu.txt", dirname, (unsigned long long)seed, (unsigned long long)key);
+    if (length < 0 || length >= CORPUS_PATH_LENGTH) {
+        fprintf(stderr, "%s: Corpus path is too long!\n", __func__);
+        exit(-1);
+    }
+}
+
+void corpus_open(corpus_t * corpus, const char * dirname) {
+    assert(NULL != corpus);
+    assert(NULL != dirname);
+    if (strlen(dirname) + 64 > CORPUS_PATH_LENGTH) {
+        fprintf(stderr, "%s: Corpus path is too long!\n", __func__);
+        exit(-1);
+    }
+    if (0 != mkdir(dirname, 0755) && EEXIST != errno) {
+        fprintf(stderr, "%s: Corpus directory %s couldn't be created!\n", __func__, dirname);
+        exit(-1);
+    }
+    strcpy(corpus->dirname, dirname);
+    corpus->num_entries = 0;
+
+    char path[CORPUS_PATH_LENGTH];
+    corpus_failures_path(path, dirname);
+    corpus->failures = fopen(path, "ab");
+    if (NULL == corpus->failures) {
+        fprintf(stderr, "%s: Failures file %s couldn't be opened!\n", __func__, path);
+        exit(-1);
+    }
+    fseek(corpus->failures, 0, SEEK_END);
+    if (0 == ftell(corpus->failures)) {
+        char magic[8] = {0};
+        memcpy(magic, CORPUS_MAGIC, strlen(CORPUS_MAGIC));
+        uint64_t version = CORPUS_VERSION;
+        if (1 != fwrite(magic, sizeof(magic), 1, corpus->failures) || 1 != fwrite(&version, sizeof(version), 1, corpus->failures)) {
+            fprintf(stderr, "%s: Write error!\n", __func__);
+            exit(-1);
+        }
+    }
+}
+
+void corpus_add(corpus_t * corpus, corpus_entry_t * entry, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx) {
+    assert(NULL != corpus);
+    assert(NULL != corpus->failures);
+    assert(NULL != entry);
+    assert(NULL != enc_ctx);
+    assert(NULL != dec_ctx);
+    assert(entry->block_size == dec_ctx->block_size);
+    assert(entry->error.capacity >= 2 * entry->block_size);
+
+    char path[CORPUS_PATH_LENGTH];
+    corpus_key_path(path, corpus->dirname, entry->seed, entry->key);
+    if (0 != access(path, F_OK)) {
+        contexts_save(path, enc_ctx, dec_ctx);
+    }
+
+    uint64_t fields[CORPUS_ENTRY_FIELDS] = {entry->seed, entry->key, entry->message, entry->block_size,
+                                            entry->num_errors, entry->decoder, entry->opt, entry->num_iterations};
+    size_t length = 2 * entry->block_size;
+    size_t num_bytes = (length + 3) / 4;
+    uint8_t * packed = calloc(num_bytes, 1);
+    if (NULL == packed) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t i = 0; i < length; ++i) {
+        packed[i / 4] |= (uint8_t)((entry->error.array[i] & 3) << (2 * (i % 4)));
+    }
+    if (CORPUS_ENTRY_FIELDS != fwrite(fields, sizeof(uint64_t), CORPUS_ENTRY_FIELDS, corpus->failures)
+        || num_bytes != fwrite(packed, 1, num_bytes, corpus->failures)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+    free(packed);
+    // keep the corpus usable if the run is killed
+    fflush(corpus->failures);
+    corpus->num_entries += 1;
+}
+
+void corpus_close(corpus_t * corpus) {
+    assert(NULL != corpus);
+    fclose(corpus->failures);
+    corpus->failures = NULL;
+}
+
+void corpus_reader_open(corpus_reader_t * reader, const char * dirname) {
+    assert(NULL != reader);
+    assert(NULL != dirname);
+    if (strlen(dirname) + 64 > CORPUS_PATH_LENGTH) {
+        fprintf(stderr, "%s: Corpus path is too long!\n", __func__);
+        exit(-1);
+    }
+    strcpy(reader->dirname, dirname);
+    char path[CORPUS_PATH_LENGTH];
+    corpus_failures_path(path, dirname);
+    reader->failures = fopen(path, "rb");
+    if (NULL == reader->failures) {
+        fprintf(stderr, "%s: Failures file %s doesn't exist!\n", __func__, path);
+        exit(-1);
+    }
+    char magic[8] = {0};
+    uint64_t version = 0;
+    if (1 != fread(magic, sizeof(magic), 1, reader->failures) || 1 != fread(&version, sizeof(version), 1, reader->failures)
+        || 0 != strncmp(magic, CORPUS_MAGIC, sizeof(magic)) || CORPUS_VERSION != version) {
+        fprintf(stderr, "%s: %s is not a supported corpus!\n", __func__, path);
+        exit(-1);
+    }
+}
+
+bool corpus_reader_next(corpus_reader_t * reader, corpus_entry_t * entry) {
+    assert(NULL != reader);
+    assert(NULL != entry);
+    uint64_t fields[CORPUS_ENTRY_FIELDS];
+    if (CORPUS_ENTRY_FIELDS != fread(fields, sizeof(uint64_t), CORPUS_ENTRY_FIELDS, reader->failures)) {
+        return false;
+    }
+    entry->seed = fields[0];
+    entry->key = fields[1];
+    entry->message = fields[2];
+    entry->block_size = fields[3];
+    entry->num_errors = fields[4];
+    entry->decoder = fields[5];
+    entry->opt = fields[6];
+    entry->num_iterations = fields[7];
+
+    size_t length = 2 * entry->block_size;
+    size_t num_bytes = (length + 3) / 4;
+    uint8_t * packed = malloc(num_bytes);
+    if (NULL == packed) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    if (num_bytes != fread(packed, 1, num_bytes, reader->failures)) {
+        fprintf(stderr, "%s: Corpus %s is truncated!\n", __func__, reader->dirname);
+        free(packed);
+        return false;
+    }
+    entry->error = gf4_array_init(length, false);
+    for (size_t i = 0; i < length; ++i) {
+        entry->error.array[i] = (gf4_t)((packed[i / 4] >> (2 * (i % 4))) & 3);
+    }
+    free(packed);
+    return true;
+}
+
+void corpus_reader_close(corpus_reader_t * reader) {
+    assert(NULL != reader);
+    fclose(reader->failures);
+    reader->failures = NULL;
+}
+
+void corpus_entry_deinit(corpus_entry_t * entry) {
+    assert(NULL != entry);
+    gf4_array_deinit(&entry->error);
+}
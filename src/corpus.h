@@ -0,0 +1,155 @@
+/**
+ *  @file   corpus.h
+ *  @brief  Corpus of decoding failures for later replay.
+ *  @author Tomáš Vavro
+ *  @date   2026-10-19
+ ***********************************************/
+
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDPC_GF4_CORPUS_H
+#define MDPC_GF4_CORPUS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "gf4_array.h"
+#include "contexts.h"
+
+#define CORPUS_MAGIC "MDPCFLR"
+#define CORPUS_VERSION 1
+#define CORPUS_FAILURES_FILENAME "failures.bin"
+#define CORPUS_PATH_LENGTH 4096
+
+/**
+ * @brief A captured decoding failure.
+ *
+ * The syndrome of a ciphertext depends only on its error vector, so the error vector
+ * together with the key pair is enough to replay the decoding.
+ */
+typedef struct {
+    uint64_t seed; ///< base seed of the simulation the failure comes from
+    uint64_t key; ///< index of the key pair
+    uint64_t message; ///< index of the message
+    uint64_t block_size; ///< size of the circulant block
+    uint64_t num_errors; ///< hamming weight of the error vector
+    uint64_t decoder; ///< index of the decoder that failed
+    uint64_t opt; ///< decoder option
+    uint64_t num_iterations; ///< maximum number of decoding iterations
+    gf4_array_t error; ///< error vector of length 2 * block_size
+} corpus_entry_t;
+
+/**
+ * @brief Corpus directory opened for writing.
+ *
+ * The directory contains one key file per key pair (written by contexts_save, named key_SEED_KEY.txt)
+ * and CORPUS_FAILURES_FILENAME: an 8 byte magic, a 64-bit version and the entries, each consisting
+ * of the 8 64-bit integers of corpus_entry_t followed by the error vector packed to 4 symbols per byte.
+ */
+typedef struct {
+    char dirname[CORPUS_PATH_LENGTH]; ///< path of the corpus directory
+    FILE * failures; ///< opened failures file
+    uint64_t num_entries; ///< number of entries added since opening
+} corpus_t;
+
+/**
+ * @brief Corpus directory opened for reading.
+ */
+typedef struct {
+    char dirname[CORPUS_PATH_LENGTH]; ///< path of the corpus directory
+    FILE * failures; ///< opened failures file
+} corpus_reader_t;
+
+/**
+ * @brief Get path of the key file of a key pair.
+ *
+ * @param out_path buffer of CORPUS_PATH_LENGTH characters to store the path to
+ * @param dirname path of the corpus directory
+ * @param seed base seed of the simulation
+ * @param key index of the key pair
+ */
+void corpus_key_path(char * out_path, const char * dirname, uint64_t seed, uint64_t key);
+
+/**
+ * @brief Open (and create if needed) a corpus directory for adding failures.
+ *
+ * Entries are appended to an existing corpus.
+ * Opened corpus must be closed using corpus_close function!
+ *
+ * @param corpus memory location of the corpus
+ * @param dirname path of the corpus directory
+ */
+void corpus_open(corpus_t * corpus, const char * dirname);
+
+/**
+ * @brief Add a failure to the corpus.
+ *
+ * The key pair is saved if the corpus does not contain it yet.
+ *
+ * @param corpus an opened corpus
+ * @param entry the failure, entry->error must have capacity at least 2 * entry->block_size
+ * @param enc_ctx encoding context of the key pair
+ * @param dec_ctx decoding context of the key pair
+ */
+void corpus_add(corpus_t * corpus, corpus_entry_t * entry, encoding_context_t * enc_ctx, decoding_context_t * dec_ctx);
+
+/**
+ * @brief Flush and close the corpus.
+ *
+ * @param corpus an opened corpus
+ */
+void corpus_close(corpus_t * corpus);
+
+/**
+ * @brief Open a corpus directory for reading.
+ *
+ * Opened reader must be closed using corpus_reader_close function!
+ *
+ * @param reader memory location of the reader
+ * @param dirname path of the corpus directory
+ */
+void corpus_reader_open(corpus_reader_t * reader, const char * dirname);
+
+/**
+ * @brief Read the next failure.
+ *
+ * Allocates entry->error, it must be freed using corpus_entry_deinit.
+ *
+ * @param reader an opened reader
+ * @param entry memory location to store the failure to
+ * @return true if an entry was read, false at the end of the corpus
+ */
+bool corpus_reader_next(corpus_reader_t * reader, corpus_entry_t * entry);
+
+/**
+ * @brief Close the reader.
+ *
+ * @param reader an opened reader
+ */
+void corpus_reader_close(corpus_reader_t * reader);
+
+/**
+ * @brief Free the error vector of an entry.
+ *
+ * @param entry an entry read by corpus_reader_next
+ */
+void corpus_entry_deinit(corpus_entry_t * entry);
+
+#endif //MDPC_GF4_CORPUS_H
@@ -26,24 +26,23 @@ bool dec_decode_symbol_flipping_delta(gf4_array_t *maybe_decoded, gf4_array_t *i
     assert(in_array->capacity >= 2 * ctx->block_size);
     assert(ctx->delta_setting >= 0);
 
-    gf4_array_t syndrome = gf4_array_init(ctx->block_size, true);
+    gf4_arena_t local_arena;
+    gf4_arena_mark_t mark;
+    gf4_arena_t * arena = gf4_arena_scope_begin(ctx->arena, &local_arena, &mark);
+    gf4_array_t syndrome = gf4_array_init_in(arena, ctx->block_size, true);
     dec_calculate_syndrome(&syndrome, in_array, ctx);
     memcpy(maybe_decoded->array, in_array->array, sizeof(gf4_t)*in_array->capacity);
     ctx->elapsed_iterations = 0;
 
-    long * sigmas = calloc(2 * ctx->block_size, sizeof(long));
-    assert(NULL != sigmas);
-    gf4_t * values = calloc(2 * ctx->block_size, sizeof(gf4_t));
-    assert(NULL != values);
+    long * sigmas = gf4_arena_alloc(arena, 2 * ctx->block_size * sizeof(long), true);
+    gf4_t * values = gf4_arena_alloc(arena, 2 * ctx->block_size * sizeof(gf4_t), true);
 
     const long DELTA = ctx->delta_setting;
 
     for (size_t i = 0; i < num_iterations; ++i) {
         long syndrome_weight = (long) gf4_array_hamming_weight(&syndrome);
         if (0 == syndrome_weight) {
-            free(sigmas);
-            free(values);
-            gf4_array_deinit(&syndrome);
+            gf4_arena_scope_end(arena, &local_arena, mark);
             ctx->elapsed_iterations = i;
             return true;
         }
@@ -107,9 +106,7 @@ bool dec_decode_symbol_flipping_delta(gf4_array_t *maybe_decoded, gf4_array_t *i
             maybe_decoded->array[j] ^= values[j];
         }
     }
-    free(sigmas);
-    free(values);
-    gf4_array_deinit(&syndrome);
+    gf4_arena_scope_end(arena, &local_arena, mark);
     ctx->elapsed_iterations = num_iterations;
     return false;
 }
\ No newline at end of file
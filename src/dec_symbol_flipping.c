@@ -26,14 +26,17 @@ bool dec_decode_symbol_flipping(gf4_array_t *maybe_decoded, gf4_array_t *in_arra
     assert(maybe_decoded->capacity >= 2*ctx->block_size);
     assert(in_array->capacity >= 2 * ctx->block_size);
 
-    gf4_array_t syndrome = gf4_array_init(ctx->block_size, true);
+    gf4_arena_t local_arena;
+    gf4_arena_mark_t mark;
+    gf4_arena_t * arena = gf4_arena_scope_begin(ctx->arena, &local_arena, &mark);
+    gf4_array_t syndrome = gf4_array_init_in(arena, ctx->block_size, true);
     dec_calculate_syndrome(&syndrome, in_array, ctx);
     memcpy(maybe_decoded->array, in_array->array, sizeof(gf4_t)*in_array->capacity);
 
     for (size_t i = 0; i < num_iterations; ++i) {
         long syndrome_weight = (long) gf4_array_hamming_weight(&syndrome);
         if (0 == syndrome_weight) {
-            gf4_array_deinit(&syndrome);
+            gf4_arena_scope_end(arena, &local_arena, mark);
             ctx->elapsed_iterations = i;
             return true;
         }
@@ -92,7 +95,7 @@ bool dec_decode_symbol_flipping(gf4_array_t *maybe_decoded, gf4_array_t *in_arra
 
         maybe_decoded->array[pos] ^= a_max;
     }
-    gf4_array_deinit(&syndrome);
+    gf4_arena_scope_end(arena, &local_arena, mark);
     ctx->elapsed_iterations = num_iterations;
     return false;
 }
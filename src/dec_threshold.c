@@ -68,14 +68,17 @@ bool dec_decode_symbol_flipping_threshold(gf4_array_t *maybe_decoded, gf4_array_
     assert(in_array->capacity >= 2 * ctx->block_size);
     assert(NULL != ctx->threshold);
 
-    gf4_array_t syndrome = gf4_array_init(ctx->block_size, true);
+    gf4_arena_t local_arena;
+    gf4_arena_mark_t mark;
+    gf4_arena_t * arena = gf4_arena_scope_begin(ctx->arena, &local_arena, &mark);
+    gf4_array_t syndrome = gf4_array_init_in(arena, ctx->block_size, true);
     dec_calculate_syndrome(&syndrome, in_array, ctx);
     memcpy(maybe_decoded->array, in_array->array, sizeof(gf4_t)*in_array->capacity);
 
     for (size_t i = 0; i < num_iterations; ++i) {
         long syndrome_weight = (long) gf4_array_hamming_weight(&syndrome);
         if (0 == syndrome_weight) {
-            gf4_array_deinit(&syndrome);
+            gf4_arena_scope_end(arena, &local_arena, mark);
             ctx->elapsed_iterations = i;
             return true;
         }
@@ -107,7 +110,7 @@ bool dec_decode_symbol_flipping_threshold(gf4_array_t *maybe_decoded, gf4_array_
         gf4_array_zero_out(&syndrome);
         dec_calculate_syndrome(&syndrome, maybe_decoded, ctx);
     }
-    gf4_array_deinit(&syndrome);
+    gf4_arena_scope_end(arena, &local_arena, mark);
     ctx->elapsed_iterations = num_iterations;
     return false;
 }
\ No newline at end of file
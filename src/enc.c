@@ -42,7 +42,10 @@ void enc_encrypt(gf4_array_t *out_encrypted, gf4_array_t *in_message, size_t num
     assert(out_encrypted->capacity >= 2*ctx->block_size);
     assert(in_message->capacity >= ctx->block_size);
     enc_encode(out_encrypted, in_message, ctx);
-    gf4_array_t err = gf4_array_init(2*ctx->block_size, true);
+    gf4_arena_t local_arena;
+    gf4_arena_mark_t mark;
+    gf4_arena_t * arena = gf4_arena_scope_begin(ctx->arena, &local_arena, &mark);
+    gf4_array_t err = gf4_array_init_in(arena, 2*ctx->block_size, true);
     random_weighted_gf4_array(&err, 2 * ctx->block_size, num_errors);
 #ifdef WRITE_WEIGHTS
     char fname[100] = {0};
@@ -54,8 +57,19 @@ void enc_encrypt(gf4_array_t *out_encrypted, gf4_array_t *in_message, size_t num
     fprintf(outfile, "\n");
     fclose(outfile);
 #endif
+    enc_add_error(out_encrypted, out_encrypted, &err, ctx);
+    gf4_arena_scope_end(arena, &local_arena, mark);
+}
+
+void enc_add_error(gf4_array_t *out_encrypted, gf4_array_t *in_encoded, gf4_array_t *in_error, encoding_context_t * ctx) {
+    assert(NULL != out_encrypted);
+    assert(NULL != in_encoded);
+    assert(NULL != in_error);
+    assert(NULL != ctx);
+    assert(out_encrypted->capacity >= 2*ctx->block_size);
+    assert(in_encoded->capacity >= 2*ctx->block_size);
+    assert(in_error->capacity >= 2*ctx->block_size);
     for (size_t i = 0; i < 2*ctx->block_size; ++i) {
-        out_encrypted->array[i] = gf4_add(out_encrypted->array[i], err.array[i]);
+        out_encrypted->array[i] = gf4_add(in_encoded->array[i], in_error->array[i]);
     }
-    gf4_array_deinit(&err);
 }
\ No newline at end of file
@@ -57,4 +57,17 @@ void enc_encode(gf4_array_t *out_encoded, gf4_array_t *in_message, encoding_cont
  */
 void enc_encrypt(gf4_array_t *out_encrypted, gf4_array_t *in_message, size_t num_errors, encoding_context_t * ctx);
 
+/**
+ * @brief Add an error vector to an encoded message.
+ *
+ * out_encrypted, in_encoded and in_error must have capacity at least 2*ctx->block_size.
+ * Lets the caller encode a message once and encrypt it with several error vectors.
+ *
+ * @param out_encrypted array to store the result in, may be the same as in_encoded
+ * @param in_encoded array containing an encoded message, see enc_encode
+ * @param in_error the error vector
+ * @param ctx a valid encoding context
+ */
+void enc_add_error(gf4_array_t *out_encrypted, gf4_array_t *in_encoded, gf4_array_t *in_error, encoding_context_t * ctx);
+
 #endif //MDPC_GF4_ENC_H
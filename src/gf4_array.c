@@ -25,6 +25,168 @@
 
 #include "gf4_array.h"
 
+// arena
+void gf4_arena_init(gf4_arena_t * arena, size_t block_size) {
+    assert(NULL != arena);
+    if (0 == block_size) {
+        block_size = GF4_ARENA_DEFAULT_BLOCK_SIZE;
+    }
+    arena->blocks = NULL;
+    arena->block_sizes = NULL;
+    arena->num_blocks = 0;
+    arena->max_blocks = 0;
+    arena->block_size = (block_size + GF4_ARENA_ALIGNMENT - 1) / GF4_ARENA_ALIGNMENT * GF4_ARENA_ALIGNMENT;
+    arena->current = 0;
+    arena->used = 0;
+#ifdef _DEBUG
+    arena->num_allocations = 0;
+    arena->bytes_in_use = 0;
+    arena->peak_bytes = 0;
+    arena->total_allocations = 0;
+#endif
+}
+
+void gf4_arena_deinit(gf4_arena_t * arena) {
+    assert(NULL != arena);
+    for (size_t i = 0; i < arena->num_blocks; ++i) {
+        free(arena->blocks[i]);
+    }
+    free(arena->blocks);
+    free(arena->block_sizes);
+    arena->blocks = NULL;
+    arena->block_sizes = NULL;
+    arena->num_blocks = 0;
+    arena->max_blocks = 0;
+    arena->current = 0;
+    arena->used = 0;
+}
+
+static uint8_t * gf4_arena_new_block(size_t size) {
+    uint8_t * block = aligned_alloc(GF4_ARENA_ALIGNMENT, size);
+    if (NULL == block) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    return block;
+}
+
+void * gf4_arena_alloc(gf4_arena_t * arena, size_t size, bool zero_out_new_memory) {
+    assert(NULL != arena);
+    assert(0 < size);
+    size_t padded = (size + GF4_ARENA_ALIGNMENT - 1) / GF4_ARENA_ALIGNMENT * GF4_ARENA_ALIGNMENT;
+    if (arena->current >= arena->num_blocks || arena->used + padded > arena->block_sizes[arena->current]) {
+        // move on to the next block, it is either reused (if large enough) or (re)allocated
+        size_t next = (arena->current < arena->num_blocks && 0 < arena->used) ? arena->current + 1 : arena->current;
+        size_t size_needed = (padded > arena->block_size) ? padded : arena->block_size;
+        if (next == arena->num_blocks) {
+            if (arena->num_blocks == arena->max_blocks) {
+                size_t max_blocks = (0 == arena->max_blocks) ? 4 : 2 * arena->max_blocks;
+                uint8_t ** blocks = realloc(arena->blocks, max_blocks * sizeof(uint8_t *));
+                size_t * block_sizes = realloc(arena->block_sizes, max_blocks * sizeof(size_t));
+                if (NULL == blocks || NULL == block_sizes) {
+                    fprintf(stderr, "%s: Allocation error!\n", __func__);
+                    exit(-1);
+                }
+                arena->blocks = blocks;
+                arena->block_sizes = block_sizes;
+                arena->max_blocks = max_blocks;
+            }
+            arena->blocks[next] = gf4_arena_new_block(size_needed);
+            arena->block_sizes[next] = size_needed;
+            arena->num_blocks += 1;
+        } else if (arena->block_sizes[next] < padded) {
+            // blocks after the current one hold no live allocations
+            free(arena->blocks[next]);
+            arena->blocks[next] = gf4_arena_new_block(size_needed);
+            arena->block_sizes[next] = size_needed;
+        }
+        arena->current = next;
+        arena->used = 0;
+    }
+    uint8_t * out = arena->blocks[arena->current] + arena->used;
+    arena->used += padded;
+    if (zero_out_new_memory) {
+        memset(out, 0, padded);
+    }
+#ifdef _DEBUG
+    arena->num_allocations += 1;
+    arena->total_allocations += 1;
+    arena->bytes_in_use += padded;
+    if (arena->bytes_in_use > arena->peak_bytes) {
+        arena->peak_bytes = arena->bytes_in_use;
+    }
+#endif
+    return out;
+}
+
+gf4_arena_mark_t gf4_arena_mark(gf4_arena_t * arena) {
+    assert(NULL != arena);
+    gf4_arena_mark_t mark;
+    mark.block = arena->current;
+    mark.used = arena->used;
+#ifdef _DEBUG
+    mark.num_allocations = arena->num_allocations;
+    mark.bytes_in_use = arena->bytes_in_use;
+#endif
+    return mark;
+}
+
+void gf4_arena_release(gf4_arena_t * arena, gf4_arena_mark_t mark) {
+    assert(NULL != arena);
+    assert(mark.block < arena->current || (mark.block == arena->current && mark.used <= arena->used));
+#ifdef _DEBUG
+    assert(mark.num_allocations <= arena->num_allocations);
+    for (size_t i = mark.block; i <= arena->current && i < arena->num_blocks; ++i) {
+        size_t begin = (i == mark.block) ? mark.used : 0;
+        size_t end = (i == arena->current) ? arena->used : arena->block_sizes[i];
+        if (begin < end) {
+            memset(arena->blocks[i] + begin, 0xff, end - begin);
+        }
+    }
+    arena->num_allocations = mark.num_allocations;
+    arena->bytes_in_use = mark.bytes_in_use;
+#endif
+    arena->current = mark.block;
+    arena->used = mark.used;
+}
+
+void gf4_arena_print_stats(gf4_arena_t * arena, FILE * stream) {
+    assert(NULL != arena);
+    assert(NULL != stream);
+    size_t reserved = 0;
+    for (size_t i = 0; i < arena->num_blocks; ++i) {
+        reserved += arena->block_sizes[i];
+    }
+#ifdef _DEBUG
+    fprintf(stream, "arena: %zu blocks (%zu B), %zu live allocations (%zu B), peak %zu B, %zu allocations in total\n",
+            arena->num_blocks, reserved, arena->num_allocations, arena->bytes_in_use, arena->peak_bytes,
+            arena->total_allocations);
+#else
+    fprintf(stream, "arena: %zu blocks (%zu B)\n", arena->num_blocks, reserved);
+#endif
+}
+
+gf4_arena_t * gf4_arena_scope_begin(gf4_arena_t * shared, gf4_arena_t * local, gf4_arena_mark_t * out_mark) {
+    assert(NULL != local);
+    assert(NULL != out_mark);
+    gf4_arena_t * arena = shared;
+    if (NULL == arena) {
+        gf4_arena_init(local, 0);
+        arena = local;
+    }
+    *out_mark = gf4_arena_mark(arena);
+    return arena;
+}
+
+void gf4_arena_scope_end(gf4_arena_t * arena, gf4_arena_t * local, gf4_arena_mark_t mark) {
+    assert(NULL != arena);
+    if (arena == local) {
+        gf4_arena_deinit(local);
+    } else {
+        gf4_arena_release(arena, mark);
+    }
+}
+
 gf4_array_t gf4_array_init(size_t capacity, bool zero_out_new_memory) {
     assert(0 < capacity);
     gf4_array_t out;
@@ -41,6 +203,15 @@ gf4_array_t gf4_array_init(size_t capacity, bool zero_out_new_memory) {
     return out;
 }
 
+gf4_array_t gf4_array_init_in(gf4_arena_t * arena, size_t capacity, bool zero_out_new_memory) {
+    assert(NULL != arena);
+    assert(0 < capacity);
+    gf4_array_t out;
+    out.array = gf4_arena_alloc(arena, capacity * sizeof(gf4_t), zero_out_new_memory);
+    out.capacity = capacity;
+    return out;
+}
+
 gf4_array_t gf4_array_clone(gf4_array_t * in_array) {
     gf4_array_t clone;
     clone.capacity = in_array->capacity;
@@ -39,9 +39,140 @@ typedef struct {
     size_t capacity; ///< allocated amount of memory
 } gf4_array_t;
 
+#define GF4_ARENA_ALIGNMENT 64 ///< alignment (and padding granularity) of every arena allocation in bytes
+#define GF4_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024) ///< default size of one arena block in bytes
+
+/**
+ * @brief Bump allocator handing out aligned memory from a list of large blocks.
+ *
+ * Memory is never returned to the system one allocation at a time, instead everything allocated
+ * after a mark is released at once by gf4_arena_release. Released blocks are kept for reuse.
+ */
+typedef struct {
+    uint8_t ** blocks; ///< allocated blocks, each GF4_ARENA_ALIGNMENT aligned
+    size_t * block_sizes; ///< size of every block in bytes
+    size_t num_blocks; ///< number of allocated blocks
+    size_t max_blocks; ///< capacity of blocks and block_sizes
+    size_t block_size; ///< minimum size of a newly allocated block
+    size_t current; ///< index of the block allocations are served from
+    size_t used; ///< number of used bytes of the current block
+#ifdef _DEBUG
+    size_t num_allocations; ///< number of live allocations
+    size_t bytes_in_use; ///< number of live bytes (including padding)
+    size_t peak_bytes; ///< maximum of bytes_in_use
+    size_t total_allocations; ///< number of allocations since initialization
+#endif
+} gf4_arena_t;
+
+/**
+ * @brief Position in an arena to return to, see gf4_arena_mark.
+ */
+typedef struct {
+    size_t block; ///< index of the current block
+    size_t used; ///< number of used bytes of the current block
+#ifdef _DEBUG
+    size_t num_allocations; ///< live allocations at the time of the mark
+    size_t bytes_in_use; ///< live bytes at the time of the mark
+#endif
+} gf4_arena_mark_t;
+
+// arena
+/**
+ * @brief Initialize an empty arena.
+ *
+ * Initialized arena must be cleaned up using gf4_arena_deinit function if no longer needed!
+ *
+ * @param arena memory location of the arena
+ * @param block_size minimum size of one block in bytes, 0 means GF4_ARENA_DEFAULT_BLOCK_SIZE
+ */
+void gf4_arena_init(gf4_arena_t * arena, size_t block_size);
+
+/**
+ * @brief Free all the blocks of an arena, every allocation of the arena becomes invalid.
+ *
+ * @param arena an initialized arena
+ */
+void gf4_arena_deinit(gf4_arena_t * arena);
+
+/**
+ * @brief Allocate memory from an arena.
+ *
+ * The memory is GF4_ARENA_ALIGNMENT aligned and size is rounded up to a multiple of GF4_ARENA_ALIGNMENT,
+ * so vectorized loops may read and write whole vectors past size. Exits when out of memory.
+ *
+ * @param arena an initialized arena
+ * @param size number of bytes, positive
+ * @param zero_out_new_memory true to zero out the memory (including the padding)
+ * @return pointer to the allocated memory
+ */
+void * gf4_arena_alloc(gf4_arena_t * arena, size_t size, bool zero_out_new_memory);
+
+/**
+ * @brief Remember the current position of an arena.
+ *
+ * @param arena an initialized arena
+ * @return mark to be passed to gf4_arena_release
+ */
+gf4_arena_mark_t gf4_arena_mark(gf4_arena_t * arena);
+
+/**
+ * @brief Release everything allocated since mark.
+ *
+ * Marks must be released in the reverse order they were taken (scopes).
+ * In debug builds the released memory is filled with 0xff, which is not an element of GF(4).
+ *
+ * @param arena an initialized arena
+ * @param mark mark returned by gf4_arena_mark
+ */
+void gf4_arena_release(gf4_arena_t * arena, gf4_arena_mark_t mark);
+
+/**
+ * @brief Print allocation statistics of an arena (only available in debug builds).
+ *
+ * @param arena an initialized arena
+ * @param stream stream to be used (e.g. stdout, stderr...)
+ */
+void gf4_arena_print_stats(gf4_arena_t * arena, FILE * stream);
+
+/**
+ * @brief Start a scope of temporary allocations, e.g. of one call of a decoder.
+ *
+ * If shared is not NULL, the temporaries are allocated from it and its blocks are reused by the next scope.
+ * Otherwise local is initialized and used for this scope only.
+ *
+ * @param shared an initialized arena owned by the caller, may be NULL
+ * @param local memory location of an arena used if shared is NULL
+ * @param out_mark memory location to store the beginning of the scope to
+ * @return arena to allocate the temporaries from
+ */
+gf4_arena_t * gf4_arena_scope_begin(gf4_arena_t * shared, gf4_arena_t * local, gf4_arena_mark_t * out_mark);
+
+/**
+ * @brief End a scope started by gf4_arena_scope_begin, every allocation of the scope becomes invalid.
+ *
+ * @param arena arena returned by gf4_arena_scope_begin
+ * @param local the local arena passed to gf4_arena_scope_begin
+ * @param mark mark stored by gf4_arena_scope_begin
+ */
+void gf4_arena_scope_end(gf4_arena_t * arena, gf4_arena_t * local, gf4_arena_mark_t mark);
+
 // initialization
 gf4_array_t gf4_array_init(size_t capacity, bool zero_out_new_memory);
 
+/**
+ * @brief Initialize an array in an arena.
+ *
+ * The array is GF4_ARENA_ALIGNMENT aligned and padded (see gf4_arena_alloc).
+ * It is freed by gf4_arena_release or gf4_arena_deinit, do not call gf4_array_deinit
+ * or gf4_array_resize on it!
+ *
+ * @param arena an initialized arena
+ * @param capacity number of elements, positive
+ * @param zero_out_new_memory true to zero out the array
+ * @return the array
+ */
+gf4_array_t gf4_array_init_in(gf4_arena_t * arena, size_t capacity, bool zero_out_new_memory);
+
 gf4_array_t gf4_array_clone(gf4_array_t * in_array);
 
 void gf4_array_resize(gf4_array_t * array, size_t new_capacity, bool zero_out_new_memory);
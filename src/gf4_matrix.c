@@ -25,57 +25,236 @@
 
 #include "gf4_matrix.h"
 
+static inline uint64_t * gf4_matrix_row(gf4_matrix_t * matrix, size_t row) {
+    return matrix->data + matrix->row_index[row] * matrix->stride;
+}
+
+// packed rows: coefficients of 1 in words [0, num_words), coefficients of alpha in words [num_words, 2 * num_words)
+static inline gf4_t gf4_matrix_packed_get(const uint64_t * row, size_t num_words, size_t col) {
+    return (gf4_t)(((row[col / 64] >> (col % 64)) & 1) | (((row[num_words + col / 64] >> (col % 64)) & 1) << 1));
+}
+
+static inline void gf4_matrix_packed_set(uint64_t * row, size_t num_words, size_t col, gf4_t val) {
+    uint64_t bit = (uint64_t)1 << (col % 64);
+    row[col / 64] = (row[col / 64] & ~bit) | ((uint64_t)(val & 1) << (col % 64));
+    row[num_words + col / 64] = (row[num_words + col / 64] & ~bit) | ((uint64_t)(val >> 1) << (col % 64));
+}
+
+// row += coefficient * other, for the words [from_word, num_words) of both planes
+static void gf4_matrix_packed_add_mul(uint64_t * row, const uint64_t * other, gf4_t coefficient, size_t from_word, size_t num_words) {
+    uint64_t * lo = row, * hi = row + num_words;
+    const uint64_t * other_lo = other, * other_hi = other + num_words;
+    switch (coefficient) {
+        case 1:
+            for (size_t i = from_word; i < num_words; ++i) {
+                lo[i] ^= other_lo[i];
+                hi[i] ^= other_hi[i];
+            }
+            break;
+        case 2: // (l + h*a) * a = h + (l + h)*a
+            for (size_t i = from_word; i < num_words; ++i) {
+                lo[i] ^= other_hi[i];
+                hi[i] ^= other_lo[i] ^ other_hi[i];
+            }
+            break;
+        case 3: // (l + h*a) * (a + 1) = (l + h) + l*a
+            for (size_t i = from_word; i < num_words; ++i) {
+                lo[i] ^= other_lo[i] ^ other_hi[i];
+                hi[i] ^= other_lo[i];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void gf4_matrix_packed_scale(uint64_t * row, gf4_t coefficient, size_t from_word, size_t num_words) {
+    uint64_t * lo = row, * hi = row + num_words;
+    for (size_t i = from_word; i < num_words; ++i) {
+        uint64_t l = lo[i], h = hi[i];
+        if (0 == coefficient) {
+            lo[i] = 0;
+            hi[i] = 0;
+        } else if (2 == coefficient) {
+            lo[i] = h;
+            hi[i] = l ^ h;
+        } else if (3 == coefficient) {
+            lo[i] = l ^ h;
+            hi[i] = l;
+        }
+    }
+}
+
+// sum of row[i] * other[i]
+static inline gf4_t gf4_matrix_packed_dot(const uint64_t * row, const uint64_t * other, size_t num_words) {
+    // (l + h*a) * (l' + h'*a) = (l*l' + h*h') + (l*h' + h*l' + h*h')*a
+    uint64_t lo = 0, hi = 0;
+    for (size_t i = 0; i < num_words; ++i) {
+        uint64_t l = row[i], h = row[num_words + i], other_l = other[i], other_h = other[num_words + i];
+        lo ^= (l & other_l) ^ (h & other_h);
+        hi ^= (l & other_h) ^ (h & other_l) ^ (h & other_h);
+    }
+    return (gf4_t)((__builtin_popcountll(lo) & 1) | ((__builtin_popcountll(hi) & 1) << 1));
+}
+
+// index of the table entry that cancels the pivot columns of row
+static inline size_t gf4_matrix_packed_table_index(const uint64_t * row, size_t num_words, const size_t * pivot_cols, size_t num_pivots) {
+    size_t index = 0;
+    for (size_t j = 0; j < num_pivots; ++j) {
+        index |= (size_t)gf4_matrix_packed_get(row, num_words, pivot_cols[j]) << (2 * j);
+    }
+    return index;
+}
+
+gf4_matrix_t gf4_matrix_init_zero(size_t num_rows, size_t num_cols) {
+    assert(0 < num_cols);
+    gf4_matrix_t matrix;
+    size_t words_per_line = GF4_MATRIX_ALIGNMENT / sizeof(uint64_t);
+    matrix.num_rows = num_rows;
+    matrix.num_cols = num_cols;
+    matrix.num_words = (num_cols + 63) / 64;
+    matrix.stride = (2 * matrix.num_words + words_per_line - 1) / words_per_line * words_per_line;
+    // at least one row is allocated, so a matrix without rows (e.g. a trivial nullspace) is valid as well
+    size_t num_allocated = UTILS_MAX(num_rows, 1);
+    matrix.data = aligned_alloc(GF4_MATRIX_ALIGNMENT, num_allocated * matrix.stride * sizeof(uint64_t));
+    matrix.row_index = malloc(num_allocated * sizeof(size_t));
+    if (NULL == matrix.data || NULL == matrix.row_index) {
+        fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
+        exit(-1);
+    }
+    memset(matrix.data, 0, num_allocated * matrix.stride * sizeof(uint64_t));
+    for (size_t row = 0; row < num_rows; ++row) {
+        matrix.row_index[row] = row;
+    }
+    return matrix;
+}
+
 gf4_matrix_t gf4_matrix_init_cyclic_matrix(gf4_poly_t * first_row, size_t N) {
     assert(NULL != first_row);
     assert(first_row->coefficients.capacity >= N);
     assert(0 != N);
-    gf4_matrix_t matrix;
-    matrix.rows = malloc(N * sizeof(gf4_t *));
-    if (NULL == matrix.rows) {
-        fprintf(stderr, "gf4_matrix_init_cyclic_matrix: Memory allocation failed!\n");
-        exit(-1);
-    }
+    gf4_matrix_t matrix = gf4_matrix_init_zero(N, N);
     for (size_t row = N; row > 0; --row) {
-        matrix.rows[N - row] = malloc(N * sizeof(gf4_t));
-        if (NULL == matrix.rows[N - row]) {
-            fprintf(stderr, "gf4_matrix_init_cyclic_matrix: Memory allocation failed!\n");
-            exit(-1);
-        }
+        uint64_t * packed = gf4_matrix_row(&matrix, N - row);
         for (size_t col = 0; col < N; ++col) {
-            matrix.rows[N - row][col] = first_row->coefficients.array[(row + col) % N];
+            gf4_t val = first_row->coefficients.array[(row + col) % N];
+            packed[col / 64] |= (uint64_t)(val & 1) << (col % 64);
+            packed[matrix.num_words + col / 64] |= (uint64_t)(val >> 1) << (col % 64);
         }
     }
-    matrix.num_rows = N;
-    matrix.num_cols = N;
     return matrix;
 }
 
-gf4_matrix_t gf4_matrix_clone(gf4_matrix_t * matrix) {
-    assert(NULL != matrix);
-    gf4_matrix_t out;
-    out.num_rows = matrix->num_rows;
-    out.num_cols = matrix->num_cols;
-    out.rows = malloc(out.num_rows * sizeof(gf4_t *));
-    if (NULL == out.rows) {
+gf4_circulant_t gf4_circulant_init_view(gf4_poly_t * first_row, size_t N) {
+    assert(NULL != first_row);
+    assert(first_row->coefficients.capacity >= N);
+    assert(0 != N);
+    gf4_circulant_t circulant;
+    circulant.first_row = first_row->coefficients.array;
+    circulant.N = N;
+    return circulant;
+}
+
+gf4_t gf4_circulant_get(gf4_circulant_t * circulant, size_t row, size_t col) {
+    assert(NULL != circulant);
+    assert(row < circulant->N);
+    assert(col < circulant->N);
+    return circulant->first_row[(circulant->N - row + col) % circulant->N];
+}
+
+gf4_matrix_t gf4_circulant_select(gf4_circulant_t * circulant, const bool * row_mask, const bool * col_mask) {
+    assert(NULL != circulant);
+    size_t N = circulant->N;
+    size_t num_rows = 0, num_cols = 0;
+    for (size_t row = 0; row < N; ++row) {
+        num_rows += (NULL == row_mask || row_mask[row]);
+    }
+    size_t * cols = malloc(N * sizeof(size_t));
+    if (NULL == cols) {
         fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
         exit(-1);
     }
-    for (size_t row = 0; row < out.num_rows; ++row) {
-        out.rows[row] = malloc(out.num_cols * sizeof(gf4_t));
-        if (NULL == out.rows[row]) {
-            fprintf(stderr, "gf4_matrix_init_cyclic_matrix: Memory allocation failed!\n");
-            exit(-1);
+    for (size_t col = 0; col < N; ++col) {
+        if (NULL == col_mask || col_mask[col]) {
+            cols[num_cols++] = col;
+        }
+    }
+    gf4_matrix_t out = gf4_matrix_init_zero(num_rows, num_cols);
+    size_t out_row = 0;
+    for (size_t row = 0; row < N; ++row) {
+        if (NULL != row_mask && !row_mask[row]) {
+            continue;
+        }
+        // element (row, col) is first_row[(col + shift) mod N]
+        size_t shift = N - row;
+        uint64_t * out_packed = gf4_matrix_row(&out, out_row++);
+        for (size_t word = 0; word < out.num_words; ++word) {
+            uint64_t lo = 0, hi = 0;
+            size_t end = UTILS_MIN(num_cols, 64 * (word + 1));
+            for (size_t i = 64 * word; i < end; ++i) {
+                size_t index = cols[i] + shift;
+                gf4_t val = circulant->first_row[(index >= N) ? index - N : index];
+                lo |= (uint64_t)(val & 1) << (i % 64);
+                hi |= (uint64_t)(val >> 1) << (i % 64);
+            }
+            out_packed[word] = lo;
+            out_packed[out.num_words + word] = hi;
         }
-        memcpy(out.rows[row], matrix->rows[row], out.num_cols);
+    }
+    free(cols);
+    return out;
+}
+
+gf4_t gf4_matrix_get(gf4_matrix_t * matrix, size_t row, size_t col) {
+    assert(NULL != matrix);
+    assert(row < matrix->num_rows);
+    assert(col < matrix->num_cols);
+    return gf4_matrix_packed_get(gf4_matrix_row(matrix, row), matrix->num_words, col);
+}
+
+void gf4_matrix_set(gf4_matrix_t * matrix, size_t row, size_t col, gf4_t val) {
+    assert(NULL != matrix);
+    assert(row < matrix->num_rows);
+    assert(col < matrix->num_cols);
+    assert(gf4_is_in_range(val));
+    gf4_matrix_packed_set(gf4_matrix_row(matrix, row), matrix->num_words, col, val);
+}
+
+void gf4_matrix_get_row(gf4_matrix_t * matrix, size_t row, gf4_t * out) {
+    assert(NULL != matrix);
+    assert(NULL != out);
+    assert(row < matrix->num_rows);
+    uint64_t * packed = gf4_matrix_row(matrix, row);
+    for (size_t col = 0; col < matrix->num_cols; ++col) {
+        out[col] = gf4_matrix_packed_get(packed, matrix->num_words, col);
+    }
+}
+
+void gf4_matrix_swap_rows(gf4_matrix_t * matrix, size_t row1, size_t row2) {
+    assert(NULL != matrix);
+    assert(row1 < matrix->num_rows);
+    assert(row2 < matrix->num_rows);
+    size_t tmp = matrix->row_index[row1];
+    matrix->row_index[row1] = matrix->row_index[row2];
+    matrix->row_index[row2] = tmp;
+}
+
+gf4_matrix_t gf4_matrix_clone(gf4_matrix_t * matrix) {
+    assert(NULL != matrix);
+    gf4_matrix_t out = gf4_matrix_init_zero(matrix->num_rows, matrix->num_cols);
+    for (size_t row = 0; row < out.num_rows; ++row) {
+        memcpy(gf4_matrix_row(&out, row), gf4_matrix_row(matrix, row), out.stride * sizeof(uint64_t));
     }
     return out;
 }
 
 bool gf4_matrix_find_pivot_index(gf4_matrix_t * matrix, size_t row_index, size_t * out_pivot_index) {
     // find the index of pivot in the given row
-    for (size_t col = 0; col < matrix->num_cols; ++col) {
-        if (0 != matrix->rows[row_index][col]) {
-            *out_pivot_index = col;
+    uint64_t * packed = gf4_matrix_row(matrix, row_index);
+    for (size_t word = 0; word < matrix->num_words; ++word) {
+        uint64_t bits = packed[word] | packed[matrix->num_words + word];
+        if (0 != bits) {
+            *out_pivot_index = 64 * word + (size_t)__builtin_ctzll(bits);
             return true;
         }
     }
@@ -84,11 +263,12 @@ bool gf4_matrix_find_pivot_index(gf4_matrix_t * matrix, size_t row_index, size_t
 }
 
 bool gf4_matrix_is_row_zero(gf4_matrix_t * matrix, size_t row_index) {
-    bool is_zero = true;
-    for (size_t i = 0; i < matrix->num_cols; ++i) {
-        is_zero &= (0 == matrix->rows[row_index][i]);
+    uint64_t * packed = gf4_matrix_row(matrix, row_index);
+    uint64_t bits = 0;
+    for (size_t word = 0; word < 2 * matrix->num_words; ++word) {
+        bits |= packed[word];
     }
-    return is_zero;
+    return 0 == bits;
 }
 
 bool gf4_matrix_is_upper_echelon(gf4_matrix_t * matrix) {
@@ -102,11 +282,14 @@ bool gf4_matrix_is_upper_echelon(gf4_matrix_t * matrix) {
             if (last_pivot_index > pivot_index) {
                 return false;
             }
+            if (!pivot_exists) {
+                continue;
+            }
             for (size_t current_row = 0; current_row < matrix->num_rows; ++current_row) {
                 if (row == current_row) {
                     continue;
                 }
-                if (matrix->rows[current_row][pivot_index] != 0) {
+                if (gf4_matrix_get(matrix, current_row, pivot_index) != 0) {
                     return false;
                 }
             }
@@ -153,14 +336,17 @@ void gf4_matrix_gaussian_elimination_inplace(gf4_matrix_t * matrix) {
             // zero row
             continue;
         }
+        uint64_t * pivot_row = gf4_matrix_row(matrix, row);
+        gf4_t pivot = gf4_matrix_packed_get(pivot_row, matrix->num_words, pivot_index);
         for (size_t other_row = 0; other_row < matrix->num_rows; ++other_row) {
-            if (row == other_row || 0 == matrix->rows[other_row][pivot_index]) {
+            uint64_t * packed = gf4_matrix_row(matrix, other_row);
+            gf4_t val = gf4_matrix_packed_get(packed, matrix->num_words, pivot_index);
+            if (row == other_row || 0 == val) {
                 continue;
             }
-            gf4_t ratio = gf4_div(matrix->rows[row][pivot_index], matrix->rows[other_row][pivot_index]);
-            for (size_t col = 0; col < matrix->num_cols; ++ col) {
-                matrix->rows[other_row][col] = matrix->rows[row][col] ^ gf4_mul(matrix->rows[other_row][col], ratio);
-            }
+            // other_row = row + ratio * other_row
+            gf4_matrix_packed_scale(packed, gf4_div(pivot, val), 0, matrix->num_words);
+            gf4_matrix_packed_add_mul(packed, pivot_row, 1, 0, matrix->num_words);
         }
     }
 
@@ -169,9 +355,7 @@ void gf4_matrix_gaussian_elimination_inplace(gf4_matrix_t * matrix) {
     size_t row_pos = 0;
     while (min_index < matrix->num_rows) {
         // swap rows in matrix
-        gf4_t * tmp_row = matrix->rows[row_pos];
-        matrix->rows[row_pos] = matrix->rows[min_index];
-        matrix->rows[min_index] = tmp_row;
+        gf4_matrix_swap_rows(matrix, row_pos, min_index);
         // swap pivot indices
         size_t tmp_index = pivot_indices[row_pos];
         pivot_indices[row_pos] = pivot_indices[min_index];
@@ -185,6 +369,355 @@ void gf4_matrix_gaussian_elimination_inplace(gf4_matrix_t * matrix) {
     free(pivot_indices);
 }
 
+/**
+ * @brief State of a (possibly multithreaded) Method of Four Russians elimination.
+ */
+typedef struct {
+    gf4_matrix_t * matrix; ///< eliminated matrix
+    uint64_t * table; ///< all linear combinations of the pivots of the current panel
+    size_t * num_reduced; ///< number of panel pivots every row below the panel has been reduced by
+    size_t pivot_cols[GF4_MATRIX_M4RM_K]; ///< pivot columns of the current panel
+    size_t num_pivots; ///< number of pivots of the current panel
+    size_t rank; ///< first row of the current panel
+    size_t from_word; ///< first word that may be nonzero in the rows of the current panel
+    size_t num_threads; ///< number of threads reducing the rows
+    pthread_barrier_t start; ///< the panel is ready to be applied
+    pthread_barrier_t end; ///< all rows are reduced by the panel
+    bool done; ///< the elimination is finished, set before the last start barrier
+} gf4_matrix_m4rm_t;
+
+typedef struct {
+    gf4_matrix_m4rm_t * state; ///< shared state
+    size_t thread_index; ///< index of the worker, 1 ... num_threads - 1 (the caller is 0)
+} gf4_matrix_m4rm_worker_t;
+
+// find up to K pivots starting at start_col, rows below the panel are reduced by its pivots only when inspected
+static size_t gf4_matrix_m4rm_panel(gf4_matrix_m4rm_t * state, size_t start_col) {
+    gf4_matrix_t * matrix = state->matrix;
+    size_t num_rows = matrix->num_rows, num_words = matrix->num_words;
+    size_t rank = state->rank, from_word = start_col / 64;
+    size_t num_pivots = 0;
+    for (size_t row = rank; row < num_rows; ++row) {
+        state->num_reduced[row] = 0;
+    }
+    for (size_t col = start_col; col < matrix->num_cols && num_pivots < GF4_MATRIX_M4RM_K && rank + num_pivots < num_rows; ++col) {
+        size_t pivot_row = num_rows;
+        for (size_t row = rank + num_pivots; row < num_rows; ++row) {
+            uint64_t * packed = gf4_matrix_row(matrix, row);
+            for (size_t j = state->num_reduced[row]; j < num_pivots; ++j) {
+                gf4_t val = gf4_matrix_packed_get(packed, num_words, state->pivot_cols[j]);
+                gf4_matrix_packed_add_mul(packed, gf4_matrix_row(matrix, rank + j), val, from_word, num_words);
+            }
+            state->num_reduced[row] = num_pivots;
+            if (0 != gf4_matrix_packed_get(packed, num_words, col)) {
+                pivot_row = row;
+                break;
+            }
+        }
+        if (num_rows == pivot_row) {
+            continue;
+        }
+        size_t target = rank + num_pivots;
+        gf4_matrix_swap_rows(matrix, target, pivot_row);
+        size_t tmp_reduced = state->num_reduced[target];
+        state->num_reduced[target] = state->num_reduced[pivot_row];
+        state->num_reduced[pivot_row] = tmp_reduced;
+
+        // normalize the pivot and clear its column in the previous pivots of the panel
+        uint64_t * pivot = gf4_matrix_row(matrix, target);
+        gf4_matrix_packed_scale(pivot, gf4_div(1, gf4_matrix_packed_get(pivot, num_words, col)), from_word, num_words);
+        for (size_t j = 0; j < num_pivots; ++j) {
+            uint64_t * packed = gf4_matrix_row(matrix, rank + j);
+            gf4_t val = gf4_matrix_packed_get(packed, num_words, col);
+            gf4_matrix_packed_add_mul(packed, pivot, val, from_word, num_words);
+        }
+        state->pivot_cols[num_pivots] = col;
+        ++num_pivots;
+    }
+    state->num_pivots = num_pivots;
+    state->from_word = from_word;
+    return num_pivots;
+}
+
+// table of all linear combinations of the pivots, entry i cancels a row whose pivot columns hold the digits of i
+static void gf4_matrix_m4rm_build_table(gf4_matrix_m4rm_t * state) {
+    size_t num_words = state->matrix->num_words, from_word = state->from_word;
+    size_t num_entries = (size_t)1 << (2 * state->num_pivots);
+    for (size_t i = 1; i < num_entries; ++i) {
+        size_t j = 0;
+        while ((i >> (2 * (j + 1))) != 0) {
+            ++j;
+        }
+        gf4_t val = (gf4_t)((i >> (2 * j)) & 3);
+        uint64_t * entry = state->table + i * 2 * num_words;
+        const uint64_t * prev = state->table + (i - ((size_t)val << (2 * j))) * 2 * num_words;
+        memcpy(entry + from_word, prev + from_word, (num_words - from_word) * sizeof(uint64_t));
+        memcpy(entry + num_words + from_word, prev + num_words + from_word, (num_words - from_word) * sizeof(uint64_t));
+        gf4_matrix_packed_add_mul(entry, gf4_matrix_row(state->matrix, state->rank + j), val, from_word, num_words);
+    }
+}
+
+// reduce the share of rows of one thread by the current panel
+static void gf4_matrix_m4rm_reduce(gf4_matrix_m4rm_t * state, size_t thread_index) {
+    gf4_matrix_t * matrix = state->matrix;
+    size_t num_words = matrix->num_words;
+    size_t row_begin = matrix->num_rows * thread_index / state->num_threads;
+    size_t row_end = matrix->num_rows * (thread_index + 1) / state->num_threads;
+    for (size_t row = row_begin; row < row_end; ++row) {
+        if (state->rank <= row && row < state->rank + state->num_pivots) {
+            continue;
+        }
+        uint64_t * packed = gf4_matrix_row(matrix, row);
+        size_t index = gf4_matrix_packed_table_index(packed, num_words, state->pivot_cols, state->num_pivots);
+        if (0 != index) {
+            gf4_matrix_packed_add_mul(packed, state->table + index * 2 * num_words, 1, state->from_word, num_words);
+        }
+    }
+}
+
+static void * gf4_matrix_m4rm_work(void * arg) {
+    gf4_matrix_m4rm_worker_t * worker = arg;
+    gf4_matrix_m4rm_t * state = worker->state;
+    while (true) {
+        pthread_barrier_wait(&state->start);
+        if (state->done) {
+            break;
+        }
+        gf4_matrix_m4rm_reduce(state, worker->thread_index);
+        pthread_barrier_wait(&state->end);
+    }
+    return NULL;
+}
+
+void gf4_matrix_gaussian_elimination_parallel_inplace(gf4_matrix_t * matrix, size_t num_threads) {
+    assert(NULL != matrix);
+    assert(0 < num_threads);
+    if (0 == matrix->num_rows || 0 == matrix->num_cols) {
+        return;
+    }
+    gf4_matrix_m4rm_t state;
+    size_t table_size = (size_t)1 << (2 * GF4_MATRIX_M4RM_K);
+    state.matrix = matrix;
+    state.num_reduced = calloc(matrix->num_rows, sizeof(size_t));
+    state.table = calloc(table_size * 2 * matrix->num_words, sizeof(uint64_t));
+    state.num_threads = UTILS_MAX(1, UTILS_MIN(num_threads, matrix->num_rows));
+    state.num_pivots = 0;
+    state.rank = 0;
+    state.done = false;
+    gf4_matrix_m4rm_worker_t * workers = malloc(state.num_threads * sizeof(gf4_matrix_m4rm_worker_t));
+    pthread_t * threads = malloc(state.num_threads * sizeof(pthread_t));
+    if (NULL == state.num_reduced || NULL == state.table || NULL == workers || NULL == threads) {
+        fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
+        exit(-1);
+    }
+    if (1 < state.num_threads) {
+        pthread_barrier_init(&state.start, NULL, (unsigned)state.num_threads);
+        pthread_barrier_init(&state.end, NULL, (unsigned)state.num_threads);
+        for (size_t i = 1; i < state.num_threads; ++i) {
+            workers[i].state = &state;
+            workers[i].thread_index = i;
+            if (0 != pthread_create(&threads[i], NULL, gf4_matrix_m4rm_work, &workers[i])) {
+                fprintf(stderr, "%s: Thread couldn't be created!\n", __func__);
+                exit(-1);
+            }
+        }
+    }
+
+    // the panels are factorized by the caller, the trailing update is shared by all the threads
+    size_t start_col = 0;
+    while (state.rank < matrix->num_rows && start_col < matrix->num_cols) {
+        if (0 == gf4_matrix_m4rm_panel(&state, start_col)) {
+            break;
+        }
+        gf4_matrix_m4rm_build_table(&state);
+        if (1 < state.num_threads) {
+            pthread_barrier_wait(&state.start);
+            gf4_matrix_m4rm_reduce(&state, 0);
+            pthread_barrier_wait(&state.end);
+        } else {
+            gf4_matrix_m4rm_reduce(&state, 0);
+        }
+        state.rank += state.num_pivots;
+        start_col = state.pivot_cols[state.num_pivots - 1] + 1;
+    }
+
+    // cleanup
+    if (1 < state.num_threads) {
+        state.done = true;
+        pthread_barrier_wait(&state.start);
+        for (size_t i = 1; i < state.num_threads; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        pthread_barrier_destroy(&state.start);
+        pthread_barrier_destroy(&state.end);
+    }
+    free(threads);
+    free(workers);
+    free(state.table);
+    free(state.num_reduced);
+}
+
+void gf4_matrix_gaussian_elimination_m4rm_inplace(gf4_matrix_t * matrix) {
+    gf4_matrix_gaussian_elimination_parallel_inplace(matrix, 1);
+}
+
+gf4_matrix_t gf4_matrix_nullspace(gf4_matrix_t * equations) {
+    assert(NULL != equations);
+    size_t num_cols = equations->num_cols;
+    size_t * pivot_cols = malloc(num_cols * sizeof(size_t));
+    bool * is_pivot_col = calloc(num_cols, sizeof(bool));
+    size_t * free_cols = malloc(num_cols * sizeof(size_t));
+    if (NULL == pivot_cols || NULL == is_pivot_col || NULL == free_cols) {
+        fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
+        exit(-1);
+    }
+    size_t rank = 0, num_free = 0, pivot_col;
+    while (rank < equations->num_rows && gf4_matrix_find_pivot_index(equations, rank, &pivot_col)) {
+        assert(1 == gf4_matrix_get(equations, rank, pivot_col));
+        assert(0 == rank || pivot_cols[rank - 1] < pivot_col);
+        pivot_cols[rank] = pivot_col;
+        is_pivot_col[pivot_col] = true;
+        ++rank;
+    }
+    for (size_t col = 0; col < num_cols; ++col) {
+        if (!is_pivot_col[col]) {
+            free_cols[num_free++] = col;
+        }
+    }
+
+    // free column f gives the solution x_f = 1, x_p = -equation[p][f] = equation[p][f] for every pivot column p
+    gf4_matrix_t basis = gf4_matrix_init_zero(num_free, num_cols);
+    for (size_t i = 0; i < num_free; ++i) {
+        uint64_t * solution = gf4_matrix_row(&basis, i);
+        gf4_matrix_packed_set(solution, basis.num_words, free_cols[i], 1);
+        for (size_t row = 0; row < rank; ++row) {
+            gf4_t val = gf4_matrix_packed_get(gf4_matrix_row(equations, row), equations->num_words, free_cols[i]);
+            gf4_matrix_packed_set(solution, basis.num_words, pivot_cols[row], val);
+        }
+    }
+    free(free_cols);
+    free(is_pivot_col);
+    free(pivot_cols);
+    return basis;
+}
+
+void gf4_matrix_kernel_solver_init(gf4_matrix_kernel_solver_t * solver, gf4_matrix_t * matrix, size_t num_threads) {
+    assert(NULL != solver);
+    assert(NULL != matrix);
+    solver->reduced = gf4_matrix_clone(matrix);
+    gf4_matrix_gaussian_elimination_parallel_inplace(&solver->reduced, num_threads);
+    solver->pivot_row = malloc(matrix->num_cols * sizeof(size_t));
+    if (NULL == solver->pivot_row) {
+        fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
+        exit(-1);
+    }
+    for (size_t col = 0; col < matrix->num_cols; ++col) {
+        solver->pivot_row[col] = solver->reduced.num_rows;
+    }
+    size_t pivot_col;
+    solver->rank = 0;
+    while (solver->rank < solver->reduced.num_rows && gf4_matrix_find_pivot_index(&solver->reduced, solver->rank, &pivot_col)) {
+        solver->pivot_row[pivot_col] = solver->rank;
+        ++solver->rank;
+    }
+}
+
+gf4_matrix_t gf4_matrix_kernel_solver_nullspace(gf4_matrix_kernel_solver_t * solver, const bool * col_mask, size_t num_threads) {
+    assert(NULL != solver);
+    assert(NULL != col_mask);
+    gf4_matrix_t * reduced = &solver->reduced;
+    size_t num_rows = reduced->num_rows, num_cols = reduced->num_cols;
+    size_t * position = malloc(num_cols * sizeof(size_t)); // position of every selected column in the solution
+    bool * is_free = calloc(num_cols, sizeof(bool));
+    bool * is_pivot_row = calloc(num_rows, sizeof(bool));
+    bool * is_remaining_row = calloc(num_rows, sizeof(bool));
+    if (NULL == position || NULL == is_free || NULL == is_pivot_row || NULL == is_remaining_row) {
+        fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
+        exit(-1);
+    }
+    size_t num_selected = 0, num_free = 0;
+    for (size_t col = 0; col < num_cols; ++col) {
+        if (!col_mask[col]) {
+            continue;
+        }
+        position[col] = num_selected++;
+        if (num_rows == solver->pivot_row[col]) {
+            is_free[col] = true;
+            ++num_free;
+        } else {
+            is_pivot_row[solver->pivot_row[col]] = true;
+        }
+    }
+    assert(0 < num_selected);
+    for (size_t row = 0; row < solver->rank; ++row) {
+        is_remaining_row[row] = !is_pivot_row[row];
+    }
+    if (0 == num_free) {
+        free(is_remaining_row);
+        free(is_pivot_row);
+        free(is_free);
+        free(position);
+        return gf4_matrix_init_zero(0, num_selected);
+    }
+
+    // rows with pivots outside the selection restricted to the selected non-pivot columns
+    gf4_matrix_t remaining = gf4_matrix_select(reduced, is_remaining_row, is_free);
+    gf4_matrix_gaussian_elimination_parallel_inplace(&remaining, num_threads);
+    gf4_matrix_t free_part = gf4_matrix_nullspace(&remaining);
+    size_t dim = free_part.num_rows;
+
+    // the pivot columns of the selection follow from the free ones, columns are stored in reverse order
+    gf4_matrix_t reversed = gf4_matrix_init_zero(dim, num_selected);
+    gf4_matrix_t pivot_part = gf4_matrix_select(reduced, is_pivot_row, is_free);
+    for (size_t i = 0; i < dim; ++i) {
+        uint64_t * solution = gf4_matrix_row(&reversed, i);
+        const uint64_t * free_solution = gf4_matrix_row(&free_part, i);
+        size_t free_index = 0, pivot_index = 0;
+        for (size_t col = 0; col < num_cols; ++col) {
+            if (!col_mask[col]) {
+                continue;
+            }
+            gf4_t val;
+            if (is_free[col]) {
+                val = gf4_matrix_packed_get(free_solution, free_part.num_words, free_index++);
+            } else {
+                val = gf4_matrix_packed_dot(gf4_matrix_row(&pivot_part, pivot_index++), free_solution, free_part.num_words);
+            }
+            gf4_matrix_packed_set(solution, reversed.num_words, num_selected - 1 - position[col], val);
+        }
+    }
+
+    // canonical basis: the last nonzero element of every vector is 1 and the other vectors are 0 in its column
+    gf4_matrix_gaussian_elimination_parallel_inplace(&reversed, num_threads);
+    gf4_matrix_t out = gf4_matrix_init_zero(dim, num_selected);
+    for (size_t i = 0; i < dim; ++i) {
+        const uint64_t * solution = gf4_matrix_row(&reversed, dim - 1 - i);
+        uint64_t * out_solution = gf4_matrix_row(&out, i);
+        for (size_t col = 0; col < num_selected; ++col) {
+            gf4_t val = gf4_matrix_packed_get(solution, reversed.num_words, num_selected - 1 - col);
+            gf4_matrix_packed_set(out_solution, out.num_words, col, val);
+        }
+    }
+
+    // cleanup
+    gf4_matrix_deinit(&pivot_part);
+    gf4_matrix_deinit(&reversed);
+    gf4_matrix_deinit(&free_part);
+    gf4_matrix_deinit(&remaining);
+    free(is_remaining_row);
+    free(is_pivot_row);
+    free(is_free);
+    free(position);
+    return out;
+}
+
+void gf4_matrix_kernel_solver_deinit(gf4_matrix_kernel_solver_t * solver) {
+    assert(NULL != solver);
+    gf4_matrix_deinit(&solver->reduced);
+    free(solver->pivot_row);
+    solver->pivot_row = NULL;
+}
+
 size_t gf4_matrix_rank(gf4_matrix_t * matrix) {
     size_t num_zero = 0;
     for (size_t row = 0; row < matrix->num_rows; ++row) {
@@ -201,15 +734,7 @@ gf4_matrix_t gf4_matrix_solve_homogenous_linear_system(gf4_matrix_t * equations)
     size_t num_params = equations->num_cols - equations_rank;
 
     // allocate matrix for the solutions
-    gf4_matrix_t out_solutions;
-    out_solutions.num_cols = equations->num_cols;
-    out_solutions.num_rows = utils_binary_pow(4, num_params);
-    out_solutions.rows = malloc(out_solutions.num_rows * sizeof(gf4_t *));
-    assert(NULL != out_solutions.rows);
-    for (size_t i = 0; i < out_solutions.num_rows; ++i) {
-        out_solutions.rows[i] = calloc(out_solutions.num_cols, sizeof(gf4_t));
-        assert(NULL != out_solutions.rows[i]);
-    }
+    gf4_matrix_t out_solutions = gf4_matrix_init_zero(utils_binary_pow(4, num_params), equations->num_cols);
 
     // solve
     if (0 == equations_rank) {
@@ -232,7 +757,7 @@ gf4_matrix_t gf4_matrix_solve_homogenous_linear_system(gf4_matrix_t * equations)
                 size_t index = 0;
                 while (index < out_solutions.num_rows) {
                     for (size_t rep = 0; rep < repetitions; ++rep) {
-                        out_solutions.rows[index][col] = val;
+                        gf4_matrix_set(&out_solutions, index, col, val);
                         ++index;
                     }
                     ++val;
@@ -240,13 +765,16 @@ gf4_matrix_t gf4_matrix_solve_homogenous_linear_system(gf4_matrix_t * equations)
                 }
                 repetitions *= 4;
             }
+            uint64_t * equation = gf4_matrix_row(equations, current_row);
+            gf4_t pivot_coefficient = gf4_matrix_packed_get(equation, equations->num_words, pivot_index);
             for (size_t row = 0; row < out_solutions.num_rows; ++row) {
+                uint64_t * solution = gf4_matrix_row(&out_solutions, row);
                 gf4_t sum_right_of_pivot = 0;
-                gf4_t pivot_coefficient = equations->rows[current_row][pivot_index];
                 for (size_t col = pivot_index + 1; col < out_solutions.num_cols; ++col) {
-                    sum_right_of_pivot ^= gf4_mul(equations->rows[current_row][col], out_solutions.rows[row][col]);
+                    sum_right_of_pivot ^= gf4_mul(gf4_matrix_packed_get(equation, equations->num_words, col),
+                                                  gf4_matrix_packed_get(solution, out_solutions.num_words, col));
                 }
-                out_solutions.rows[row][pivot_index] = gf4_div(sum_right_of_pivot, pivot_coefficient);
+                gf4_matrix_packed_set(solution, out_solutions.num_words, pivot_index, gf4_div(sum_right_of_pivot, pivot_coefficient));
             }
             last_set_unknown_index = (0 == pivot_index) ? equations->num_cols : last_set_unknown_index - 1;
         } while (0 != current_row);
@@ -257,7 +785,7 @@ gf4_matrix_t gf4_matrix_solve_homogenous_linear_system(gf4_matrix_t * equations)
             size_t index = 0;
             while (index < out_solutions.num_rows) {
                 for (size_t rep = 0; rep < repetitions; ++rep) {
-                    out_solutions.rows[index][pivot_index] = val;
+                    gf4_matrix_set(&out_solutions, index, pivot_index, val);
                     ++index;
                 }
                 ++val;
@@ -269,28 +797,79 @@ gf4_matrix_t gf4_matrix_solve_homogenous_linear_system(gf4_matrix_t * equations)
     return out_solutions;
 }
 
+gf4_matrix_t gf4_matrix_select(gf4_matrix_t * matrix, const bool * row_mask, const bool * col_mask) {
+    assert(NULL != matrix);
+    size_t num_rows = 0, num_cols = 0;
+    for (size_t row = 0; row < matrix->num_rows; ++row) {
+        num_rows += (NULL == row_mask || row_mask[row]);
+    }
+    size_t * cols = malloc(matrix->num_cols * sizeof(size_t));
+    if (NULL == cols) {
+        fprintf(stderr, "%s: Memory allocation failed!\n", __func__);
+        exit(-1);
+    }
+    for (size_t col = 0; col < matrix->num_cols; ++col) {
+        if (NULL == col_mask || col_mask[col]) {
+            cols[num_cols++] = col;
+        }
+    }
+    gf4_matrix_t out = gf4_matrix_init_zero(num_rows, num_cols);
+    size_t out_row = 0;
+    for (size_t row = 0; row < matrix->num_rows; ++row) {
+        if (NULL != row_mask && !row_mask[row]) {
+            continue;
+        }
+        const uint64_t * packed = gf4_matrix_row(matrix, row);
+        uint64_t * out_packed = gf4_matrix_row(&out, out_row++);
+        if (NULL == col_mask) {
+            memcpy(out_packed, packed, out.stride * sizeof(uint64_t));
+            continue;
+        }
+        // gather the selected bits of both planes, one output word at a time
+        for (size_t word = 0; word < out.num_words; ++word) {
+            uint64_t lo = 0, hi = 0;
+            size_t end = UTILS_MIN(num_cols, 64 * (word + 1));
+            for (size_t i = 64 * word; i < end; ++i) {
+                size_t col = cols[i];
+                lo |= ((packed[col / 64] >> (col % 64)) & 1) << (i % 64);
+                hi |= ((packed[matrix->num_words + col / 64] >> (col % 64)) & 1) << (i % 64);
+            }
+            out_packed[word] = lo;
+            out_packed[out.num_words + word] = hi;
+        }
+    }
+    free(cols);
+    return out;
+}
+
 void gf4_matrix_remove_row_inplace(gf4_matrix_t * matrix, size_t row_index) {
     assert(NULL != matrix);
     assert(matrix->num_rows > row_index);
-    free(matrix->rows[row_index]);
-    matrix->rows[row_index] = NULL;
+    size_t removed = matrix->row_index[row_index];
     for (size_t row = row_index; row < matrix->num_rows - 1; ++row) {
-        // gf4_t * tmp_row = matrix->rows[row];
-        matrix->rows[row] = matrix->rows[row + 1];
-        // matrix->rows[row + 1] = tmp_row;
+        matrix->row_index[row] = matrix->row_index[row + 1];
     }
+    // keep the physical position in the (now unused) tail of the permutation
+    matrix->row_index[matrix->num_rows - 1] = removed;
     matrix->num_rows -= 1;
 }
 
 void gf4_matrix_remove_col_inplace(gf4_matrix_t * matrix, size_t col_index) {
     assert(NULL != matrix);
     assert(matrix->num_cols > col_index);
-
+    size_t first_word = col_index / 64;
+    uint64_t keep_mask = ((uint64_t)1 << (col_index % 64)) - 1;
     for (size_t row = 0; row < matrix->num_rows; ++row) {
-        for (size_t col = col_index; col < matrix->num_cols - 1; ++col) {
-            matrix->rows[row][col] = matrix->rows[row][col + 1];
+        uint64_t * packed = gf4_matrix_row(matrix, row);
+        for (size_t plane = 0; plane < 2; ++plane) {
+            // shift all the bits above col_index down by one
+            uint64_t * words = packed + plane * matrix->num_words;
+            for (size_t word = first_word; word < matrix->num_words; ++word) {
+                uint64_t carry = (word + 1 < matrix->num_words) ? words[word + 1] << 63 : 0;
+                uint64_t shifted = (words[word] >> 1) | carry;
+                words[word] = (word == first_word) ? (words[word] & keep_mask) | (shifted & ~keep_mask) : shifted;
+            }
         }
-        matrix->rows[matrix->num_cols - 1] = 0;
     }
     matrix->num_cols -= 1;
 }
@@ -299,26 +878,31 @@ void gf4_matrix_realloc_to_match_dimensions_inplace(gf4_matrix_t * matrix) {
     assert(NULL != matrix);
     assert(0 != matrix->num_rows);
     assert(0 != matrix->num_cols);
-    fprintf(stderr, "gf4_matrix_realloc_to_match_dimensions_inplace: Not yet implemented!\n");
-    gf4_matrix_deinit(matrix); // todo remove this line
-    exit(-1);
+    gf4_matrix_t out = gf4_matrix_init_zero(matrix->num_rows, matrix->num_cols);
+    size_t num_words = UTILS_MIN(out.num_words, matrix->num_words);
+    for (size_t row = 0; row < out.num_rows; ++row) {
+        uint64_t * packed = gf4_matrix_row(matrix, row);
+        uint64_t * out_packed = gf4_matrix_row(&out, row);
+        memcpy(out_packed, packed, num_words * sizeof(uint64_t));
+        memcpy(out_packed + out.num_words, packed + matrix->num_words, num_words * sizeof(uint64_t));
+    }
+    gf4_matrix_deinit(matrix);
+    *matrix = out;
 }
 
 void gf4_matrix_deinit(gf4_matrix_t * matrix) {
     assert(NULL != matrix);
-    for (size_t i = 0; i < matrix->num_rows; ++i) {
-        free(matrix->rows[i]);
-        matrix->rows[i] = NULL;
-    }
-    free(matrix->rows);
-    matrix->rows = NULL;
+    free(matrix->data);
+    free(matrix->row_index);
+    matrix->data = NULL;
+    matrix->row_index = NULL;
 }
 
 void gf4_matrix_pretty_print(gf4_matrix_t * matrix) {
     for (size_t row = 0; row < matrix->num_rows; ++row) {
         for (size_t col = 0; col < matrix->num_cols; ++col) {
-            printf("%5s ", gf4_to_str(matrix->rows[row][col]));
+            printf("%5s ", gf4_to_str(gf4_matrix_get(matrix, row, col)));
         }
         printf("\n");
     }
-}
\ No newline at end of file
+}
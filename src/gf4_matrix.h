@@ -26,18 +26,68 @@
 #ifndef GF4_GF4_MATRIX_H
 #define GF4_GF4_MATRIX_H
 
+#include <pthread.h>
 #include "gf4_poly.h"
 #include "utils.h"
 
+#define GF4_MATRIX_M4RM_K 4 ///< number of pivot rows combined into one table by the Method of Four Russians
+#define GF4_MATRIX_ALIGNMENT 64 ///< alignment of the matrix buffer and of every row in bytes
+
 /**
- * @brief This structure represents a square matrix of size NxN.
+ * @brief This structure represents a matrix over GF(4) of size num_rows x num_cols.
+ *
+ * All rows are stored in one contiguous, GF4_MATRIX_ALIGNMENT aligned buffer. A row consists of two bit planes
+ * of num_words 64-bit words each: the coefficients of 1 followed by the coefficients of alpha
+ * (element 2 is alpha, element 3 is alpha + 1). Rows are padded to stride words, unused bits are zero.
+ * Logical row i is stored at data + row_index[i] * stride, so rows are swapped and removed by changing row_index only.
  */
 typedef struct {
-    gf4_t ** rows; ///< rows of the matrix
+    uint64_t * data; ///< packed rows
+    size_t * row_index; ///< physical position of every logical row
+    size_t stride; ///< number of words between two consecutive physical rows
+    size_t num_words; ///< number of words of one bit plane of a row
     size_t num_rows; ///< number of rows
     size_t num_cols; ///< number of columns
 } gf4_matrix_t;
 
+/**
+ * @brief Implicit N x N cyclic matrix represented by its first row only.
+ *
+ * Row i is the first row cyclically shifted by i places to the right (see gf4_matrix_init_cyclic_matrix),
+ * i.e. element (i, j) is first_row[(j - i) mod N]. Rows and columns are generated on demand.
+ * The view does not own first_row, which must outlive it.
+ */
+typedef struct {
+    const gf4_t * first_row; ///< coefficients of the first row, at least N of them
+    size_t N; ///< size of the matrix
+} gf4_circulant_t;
+
+/**
+ * @brief Nullspaces of column subsets of a fixed matrix sharing one elimination.
+ *
+ * The system A[:, C] x = 0 has the same solutions as E[:, C] x = 0, where E is the reduced row echelon form of A.
+ * Columns of C that are pivot columns of E are already eliminated, so only the rows of E whose pivots lie outside C
+ * restricted to the non-pivot columns of C have to be eliminated for every C.
+ */
+typedef struct {
+    gf4_matrix_t reduced; ///< the matrix in reduced row echelon form with unit pivots
+    size_t rank; ///< number of nonzero rows of reduced
+    size_t * pivot_row; ///< row of reduced whose pivot is in the given column, reduced.num_rows if the column has no pivot
+} gf4_matrix_kernel_solver_t;
+
+/**
+ * @brief Allocate a zero matrix.
+ *
+ * Initialized matrix must be cleaned up using gf4_matrix_deinit function if no longer needed!
+ *
+ * @see gf4_matrix_deinit
+ *
+ * @param num_rows number of rows
+ * @param num_cols number of columns, positive
+ * @return initialized zero matrix
+ */
+gf4_matrix_t gf4_matrix_init_zero(size_t num_rows, size_t num_cols);
+
 /**
  * @brief Allocate a cyclic matrix and fill it it based on the given first_row.
  *
@@ -53,6 +103,80 @@ typedef struct {
  */
 gf4_matrix_t gf4_matrix_init_cyclic_matrix(gf4_poly_t * first_row, size_t N);
 
+/**
+ * @brief Create a circulant view of first_row, nothing is allocated.
+ *
+ * @param first_row the first row of the matrix, must outlive the view
+ * @param N size of the matrix
+ * @return the view
+ */
+gf4_circulant_t gf4_circulant_init_view(gf4_poly_t * first_row, size_t N);
+
+/**
+ * @brief Get an element of a circulant.
+ *
+ * @param circulant a circulant view
+ * @param row row index
+ * @param col column index
+ * @return the element
+ */
+gf4_t gf4_circulant_get(gf4_circulant_t * circulant, size_t row, size_t col);
+
+/**
+ * @brief Generate the submatrix of the selected rows and columns of a circulant.
+ *
+ * Same as gf4_matrix_select applied to gf4_matrix_init_cyclic_matrix, but only the selected
+ * elements are ever generated.
+ * This function allocates memory!
+ * Initialized matrix must be cleaned up using gf4_matrix_deinit function if no longer needed!
+ *
+ * @see gf4_matrix_deinit
+ *
+ * @param circulant a circulant view
+ * @param row_mask N flags, true keeps the row, NULL keeps all the rows
+ * @param col_mask N flags, true keeps the column, NULL keeps all the columns
+ * @return initialized matrix of the selected rows and columns (in their original order), at least one column must be selected
+ */
+gf4_matrix_t gf4_circulant_select(gf4_circulant_t * circulant, const bool * row_mask, const bool * col_mask);
+
+/**
+ * @brief Get an element of a matrix.
+ *
+ * @param matrix an initialized matrix
+ * @param row row index
+ * @param col column index
+ * @return the element
+ */
+gf4_t gf4_matrix_get(gf4_matrix_t * matrix, size_t row, size_t col);
+
+/**
+ * @brief Set an element of a matrix.
+ *
+ * @param matrix an initialized matrix
+ * @param row row index
+ * @param col column index
+ * @param val new value
+ */
+void gf4_matrix_set(gf4_matrix_t * matrix, size_t row, size_t col, gf4_t val);
+
+/**
+ * @brief Unpack a row of a matrix to one element per byte.
+ *
+ * @param matrix an initialized matrix
+ * @param row row index
+ * @param out memory location of at least matrix->num_cols elements
+ */
+void gf4_matrix_get_row(gf4_matrix_t * matrix, size_t row, gf4_t * out);
+
+/**
+ * @brief Swap two rows of a matrix (no data is moved).
+ *
+ * @param matrix an initialized matrix
+ * @param row1 row index
+ * @param row2 row index
+ */
+void gf4_matrix_swap_rows(gf4_matrix_t * matrix, size_t row1, size_t row2);
+
 /**
  * @brief Clone a matrix.
  *
@@ -67,7 +191,7 @@ gf4_matrix_t gf4_matrix_clone(gf4_matrix_t * matrix);
 /**
  * @brief Destroy a matrix.
  *
- * Free all the rows of the matrix and the rows array itself.
+ * Free the buffer of the matrix and its row permutation.
  *
  * @param matrix an initialized matrix
  */
@@ -83,6 +207,83 @@ void gf4_matrix_deinit(gf4_matrix_t * matrix);
  */
 void gf4_matrix_gaussian_elimination_inplace(gf4_matrix_t * matrix);
 
+/**
+ * @brief Perform gaussian elimination on the matrix using the Method of Four Russians.
+ *
+ * The rows are packed into two bit planes (coefficients of 1 and alpha) of 64-bit words.
+ * Pivots are searched for in panels of GF4_MATRIX_M4RM_K columns, all GF(4)-linear combinations
+ * of the panel's pivot rows are tabulated and every other row is reduced by a single table lookup,
+ * i.e. by word XORs instead of one gf4_mul per element and pivot.
+ *
+ * The resulting matrix is in reduced row echelon form with all pivots equal to 1 and zero rows at the bottom.
+ * Except for the pivot values it is the same matrix as the one produced by gf4_matrix_gaussian_elimination_inplace.
+ *
+ * @param matrix an initialized matrix
+ */
+void gf4_matrix_gaussian_elimination_m4rm_inplace(gf4_matrix_t * matrix);
+
+/**
+ * @brief Perform gaussian elimination on the matrix using the Method of Four Russians and multiple threads.
+ *
+ * Every panel of GF4_MATRIX_M4RM_K pivots is factorized by the calling thread, then the rows
+ * are split into num_threads contiguous ranges that are reduced by the panel in parallel.
+ * The result is identical to that of gf4_matrix_gaussian_elimination_m4rm_inplace.
+ *
+ * @param matrix an initialized matrix
+ * @param num_threads number of threads including the calling one, positive
+ */
+void gf4_matrix_gaussian_elimination_parallel_inplace(gf4_matrix_t * matrix, size_t num_threads);
+
+/**
+ * @brief Find a basis of the solutions of a system of linear homogenous equations.
+ *
+ * Unlike gf4_matrix_solve_homogenous_linear_system, which lists all 4^dim solutions,
+ * the basis has only dim = equations->num_cols - rank rows, one for every column without a pivot.
+ * The matrix of equations is expected to be in reduced row echelon form with unit pivots
+ * (see gf4_matrix_gaussian_elimination_m4rm_inplace).
+ * This function allocates memory!
+ * Initialized matrix must be cleaned up using gf4_matrix_deinit function if no longer needed!
+ *
+ * @see gf4_matrix_deinit
+ *
+ * @param equations an initialized matrix representing the system of linear equations in reduced row echelon form
+ * @return an initialized matrix whose rows form a basis of the solutions (no rows if only the zero vector is a solution)
+ */
+gf4_matrix_t gf4_matrix_nullspace(gf4_matrix_t * equations);
+
+
+/**
+ * @brief Prepare nullspace computations for column subsets of a matrix.
+ *
+ * The matrix is cloned and eliminated using num_threads threads.
+ * Initialized solver must be cleaned up using gf4_matrix_kernel_solver_deinit function if no longer needed!
+ *
+ * @param solver memory location of the solver
+ * @param matrix an initialized matrix, it is not modified
+ * @param num_threads number of threads, positive
+ */
+void gf4_matrix_kernel_solver_init(gf4_matrix_kernel_solver_t * solver, gf4_matrix_t * matrix, size_t num_threads);
+
+/**
+ * @brief Find a basis of the solutions of matrix[:, C] x = 0, where C are the columns selected by col_mask.
+ *
+ * The basis is the same one gf4_matrix_nullspace returns for the eliminated gf4_matrix_select(matrix, NULL, col_mask).
+ * This function allocates memory!
+ * Initialized matrix must be cleaned up using gf4_matrix_deinit function if no longer needed!
+ *
+ * @param solver an initialized solver
+ * @param col_mask flags of the columns of the matrix, true selects the column, at least one column must be selected
+ * @param num_threads number of threads, positive
+ * @return an initialized matrix whose rows form a basis of the solutions, its columns correspond to the selected columns
+ */
+gf4_matrix_t gf4_matrix_kernel_solver_nullspace(gf4_matrix_kernel_solver_t * solver, const bool * col_mask, size_t num_threads);
+
+/**
+ * @brief Destroy a solver.
+ *
+ * @param solver an initialized solver
+ */
+void gf4_matrix_kernel_solver_deinit(gf4_matrix_kernel_solver_t * solver);
 
 /**
  * @brief Solve a system of linear homogenous equations.
@@ -100,9 +301,28 @@ void gf4_matrix_gaussian_elimination_inplace(gf4_matrix_t * matrix);
  */
 gf4_matrix_t gf4_matrix_solve_homogenous_linear_system(gf4_matrix_t * equations);
 
+/**
+ * @brief Extract the submatrix of the selected rows and columns in one pass.
+ *
+ * This is equivalent to (but much faster than) a clone followed by gf4_matrix_remove_row_inplace
+ * and gf4_matrix_remove_col_inplace for every row and column that is not selected.
+ * This function allocates memory!
+ * Initialized matrix must be cleaned up using gf4_matrix_deinit function if no longer needed!
+ *
+ * @see gf4_matrix_deinit
+ *
+ * @param matrix an initialized matrix
+ * @param row_mask matrix->num_rows flags, true keeps the row, NULL keeps all the rows
+ * @param col_mask matrix->num_cols flags, true keeps the column, NULL keeps all the columns
+ * @return initialized matrix of the selected rows and columns (in their original order), at least one column must be selected
+ */
+gf4_matrix_t gf4_matrix_select(gf4_matrix_t * matrix, const bool * row_mask, const bool * col_mask);
+
 /**
  * @brief Remove a row from a matrix.
  *
+ * Only the row permutation is updated, the memory of the row is kept until the matrix is destroyed.
+ *
  * @param matrix an initialized matrix
  * @param row_index index of the row to remove
  */
@@ -120,7 +340,8 @@ void gf4_matrix_remove_col_inplace(gf4_matrix_t * matrix, size_t col_index);
  * @brief Realloc given matrix to shrink it or grow it.
  *
  * e.g. a matrix was originally allocated with 4 rows and 3 columns. Then one column was removed.
- * Its dimensions are now set to 4 by 2. This function reallocates all rows to be of length 2.
+ * Its dimensions are now set to 4 by 2. This function reallocates all rows to be of length 2
+ * and stores the rows in their logical order.
  *
  * @param matrix an initialized matrix
  */
@@ -59,7 +59,7 @@ void gf4_poly_set_coefficient(gf4_poly_t * poly, size_t deg, gf4_t val) {
         if (0 != val) {
 #ifdef CANRESIZE // can resize
             if (deg >= poly->coefficients.capacity) {
-                gf4_array_resize(&poly->coefficients, deg+1);
+                gf4_array_resize(&poly->coefficients, deg+1, true);
 			}
 #endif // CANRESIZE
             poly->degree = deg;
@@ -122,7 +122,7 @@ void gf4_poly_add_ax_to_deg_inplace(gf4_poly_t * poly, size_t deg, gf4_t a) {
     assert(NULL != poly);
 #ifdef CANRESIZE
     if (deg >= poly->coefficients.capacity) {
-        gf4_array_resize(&poly.coefficients, deg + 1);
+        gf4_array_resize(&poly->coefficients, deg + 1, true);
     }
 #endif // CANRESIZE
     poly->coefficients.array[deg] = poly->coefficients.array[deg] ^ a;
@@ -175,9 +175,54 @@ void gf4_poly_div_x_to_deg_inplace(gf4_poly_t * poly, size_t deg) {
     poly->degree = diff;
 }
 
+// true if b = l*x^deg + c with l, c nonzero and deg > 0, the scan stops at the first nonzero middle coefficient
+static bool gf4_poly_is_binomial(gf4_poly_t * b) {
+    if (0 == b->degree || 0 == b->coefficients.array[0]) {
+        return false;
+    }
+    for (size_t i = 1; i < b->degree; ++i) {
+        if (0 != b->coefficients.array[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// div_rem for b = l*x^r + c: x^r = c/l mod b, so every coefficient i >= r is folded onto i - r, O(a->degree)
+static void gf4_poly_div_rem_binomial(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_poly_t * b) {
+    size_t r = b->degree;
+    gf4_t b_lead = b->coefficients.array[r];
+    gf4_t b_const = b->coefficients.array[0];
+    gf4_poly_zero_out(div);
+    gf4_poly_copy(rem, a);
+    if (a->degree < r) {
+        return;
+    }
+#ifdef CANRESIZE
+    if (div->coefficients.capacity < a->degree - r + 1) {
+        gf4_array_resize(&div->coefficients, a->degree - r + 1, true);
+    }
+#endif
+    gf4_t * rem_array = rem->coefficients.array;
+    for (size_t i = a->degree; i >= r; --i) {
+        if (0 != rem_array[i]) {
+            gf4_t tmp = gf4_div(rem_array[i], b_lead);
+            div->coefficients.array[i - r] = tmp;
+            rem_array[i - r] ^= gf4_mul(tmp, b_const);
+            rem_array[i] = 0;
+        }
+    }
+    gf4_poly_adjust_degree(div, a->degree - r);
+    gf4_poly_adjust_degree(rem, r - 1);
+}
+
 void gf4_poly_div_rem(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_poly_t * b) {
     assert(!gf4_poly_is_zero(b));
 
+    if (gf4_poly_is_binomial(b)) {
+        gf4_poly_div_rem_binomial(div, rem, a, b);
+        return;
+    }
     if (a->degree < b->degree) {
         gf4_poly_zero_out(div);
         gf4_poly_copy(rem, a);
@@ -206,31 +251,110 @@ void gf4_poly_div_rem(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_po
     }
 }
 
+// workspace
+void gf4_poly_workspace_init(gf4_poly_workspace_t * ws, size_t num_polys, size_t capacity) {
+    assert(NULL != ws);
+    assert(0 < capacity);
+    ws->buffer = malloc(num_polys * capacity * sizeof(gf4_t));
+    ws->polys = malloc(num_polys * sizeof(gf4_poly_t));
+    if ((NULL == ws->buffer || NULL == ws->polys) && 0 < num_polys) {
+        fprintf(stderr, "gf4_poly_workspace_init: Memory allocation failed!\n");
+        exit(-1);
+    }
+    for (size_t i = 0; i < num_polys; ++i) {
+        ws->polys[i].coefficients.array = ws->buffer + i * capacity;
+        ws->polys[i].coefficients.capacity = capacity;
+        ws->polys[i].degree = 0;
+    }
+    ws->num_polys = num_polys;
+    ws->capacity = capacity;
+    ws->used = 0;
+}
+
+void gf4_poly_workspace_deinit(gf4_poly_workspace_t * ws) {
+    assert(NULL != ws);
+    free(ws->buffer);
+    free(ws->polys);
+    ws->buffer = NULL;
+    ws->polys = NULL;
+    ws->num_polys = 0;
+    ws->used = 0;
+}
+
+gf4_poly_t * gf4_poly_workspace_take(gf4_poly_workspace_t * ws) {
+    assert(NULL != ws);
+    if (ws->used >= ws->num_polys) {
+        fprintf(stderr, "gf4_poly_workspace_take: Workspace exhausted (%zu polynomials)!\n", ws->num_polys);
+        exit(-1);
+    }
+    gf4_poly_t * poly = &ws->polys[ws->used++];
+    gf4_poly_zero_out(poly);
+    return poly;
+}
+
+size_t gf4_poly_workspace_mark(gf4_poly_workspace_t * ws) {
+    assert(NULL != ws);
+    return ws->used;
+}
+
+void gf4_poly_workspace_release(gf4_poly_workspace_t * ws, size_t mark) {
+    assert(NULL != ws);
+    assert(mark <= ws->used);
+    ws->used = mark;
+}
+
+void gf4_poly_mul_ws(gf4_poly_t * out, gf4_poly_t * a, gf4_poly_t * b, gf4_poly_workspace_t * ws) {
+    assert(NULL != out);
+    assert(NULL != a);
+    assert(NULL != b);
+    assert(NULL != ws);
+    assert(ws->capacity > a->degree + b->degree);
+    size_t mark = gf4_poly_workspace_mark(ws);
+    gf4_poly_t * product = gf4_poly_workspace_take(ws);
+    gf4_poly_mul(product, a, b);
+    gf4_poly_copy(out, product);
+    gf4_poly_workspace_release(ws, mark);
+}
+
+void gf4_poly_div_rem_ws(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_poly_t * b, gf4_poly_workspace_t * ws) {
+    assert(NULL != div);
+    assert(NULL != rem);
+    assert(NULL != a);
+    assert(NULL != b);
+    assert(NULL != ws);
+    assert(ws->capacity > a->degree);
+    size_t mark = gf4_poly_workspace_mark(ws);
+    gf4_poly_t * tmp_div = gf4_poly_workspace_take(ws);
+    gf4_poly_t * tmp_rem = gf4_poly_workspace_take(ws);
+    gf4_poly_div_rem(tmp_div, tmp_rem, a, b);
+    gf4_poly_copy(div, tmp_div);
+    gf4_poly_copy(rem, tmp_rem);
+    gf4_poly_workspace_release(ws, mark);
+}
 
 // invert
-bool gf4_poly_invert_slow(gf4_poly_t * maybe_inverse, gf4_poly_t * poly, gf4_poly_t * modulus) {
+bool gf4_poly_invert_ws(gf4_poly_t * maybe_inverse, gf4_poly_t * poly, gf4_poly_t * modulus, gf4_poly_workspace_t * ws) {
     assert(NULL != maybe_inverse);
     assert(NULL != poly);
     assert(NULL != modulus);
+    assert(NULL != ws);
     assert(!gf4_poly_is_zero(modulus));
+    assert(ws->capacity > poly->degree && ws->capacity > modulus->degree);
 
     if (gf4_poly_is_zero(poly)) {
+        gf4_poly_zero_out(maybe_inverse);
         return false;
     }
 
-    gf4_poly_t a = gf4_poly_clone(poly);
-    gf4_poly_t b = gf4_poly_clone(modulus);
-#ifdef CANRESIZE
-    gf4_poly_t s = gf4_poly_init_zero(1);
-    gf4_poly_t t = gf4_poly_init_zero(1);
-    gf4_poly_t div = gf4_poly_init_zero(1);
-    gf4_poly_t rem = gf4_poly_init_zero(1);
-#else
-    gf4_poly_t s = gf4_poly_init_zero(modulus->coefficients.capacity);
-    gf4_poly_t t = gf4_poly_init_zero(modulus->coefficients.capacity);
-    gf4_poly_t div = gf4_poly_init_zero(modulus->coefficients.capacity);
-    gf4_poly_t rem = gf4_poly_init_zero(modulus->coefficients.capacity);
-#endif
+    size_t mark = gf4_poly_workspace_mark(ws);
+    gf4_poly_t a = *gf4_poly_workspace_take(ws);
+    gf4_poly_t b = *gf4_poly_workspace_take(ws);
+    gf4_poly_t s = *gf4_poly_workspace_take(ws);
+    gf4_poly_t t = *gf4_poly_workspace_take(ws);
+    gf4_poly_t div = *gf4_poly_workspace_take(ws);
+    gf4_poly_t rem = *gf4_poly_workspace_take(ws);
+    gf4_poly_copy(&a, poly);
+    gf4_poly_copy(&b, modulus);
     gf4_poly_t tmp;
     s.coefficients.array[0] = 1;
     while (!gf4_poly_is_zero(&b)) {
@@ -264,13 +388,21 @@ bool gf4_poly_invert_slow(gf4_poly_t * maybe_inverse, gf4_poly_t * poly, gf4_pol
         }
         gf4_poly_copy(maybe_inverse, &s);
         ret_value = true;
+    } else {
+        gf4_poly_zero_out(maybe_inverse);
     }
-    gf4_poly_deinit(&s);
-    gf4_poly_deinit(&a);
-    gf4_poly_deinit(&b);
-    gf4_poly_deinit(&t);
-    gf4_poly_deinit(&div);
-    gf4_poly_deinit(&rem);
+    gf4_poly_workspace_release(ws, mark);
+    return ret_value;
+}
+
+bool gf4_poly_invert_slow(gf4_poly_t * maybe_inverse, gf4_poly_t * poly, gf4_poly_t * modulus) {
+    assert(NULL != poly);
+    assert(NULL != modulus);
+    gf4_poly_workspace_t ws;
+    size_t capacity = UTILS_MAX(poly->degree, modulus->degree) + 1;
+    gf4_poly_workspace_init(&ws, GF4_POLY_INVERT_WS_POLYS, capacity);
+    bool ret_value = gf4_poly_invert_ws(maybe_inverse, poly, modulus, &ws);
+    gf4_poly_workspace_deinit(&ws);
     return ret_value;
 }
 
@@ -371,10 +503,13 @@ void gf4_poly_copy(gf4_poly_t * out, gf4_poly_t * in) {
     assert(NULL != out);
     assert(NULL != in);
 #ifdef CANRESIZE
-    if (out->coefficients.capacity < in->coefficients.capacity) {
-        gf4_array_resize(&out->coefficients, in->coefficients.capacity);
+    if (out->coefficients.capacity <= in->degree) {
+        gf4_array_resize(&out->coefficients, in->degree + 1, true);
     }
 #endif
+    assert(out->coefficients.capacity > in->degree);
     out->degree = in->degree;
-    memcpy(out->coefficients.array, in->coefficients.array, sizeof(gf4_t)*out->coefficients.capacity);
+    size_t length = UTILS_MIN(in->coefficients.capacity, out->coefficients.capacity);
+    memcpy(out->coefficients.array, in->coefficients.array, sizeof(gf4_t)*length);
+    memset(out->coefficients.array + length, 0, sizeof(gf4_t)*(out->coefficients.capacity - length));
 }
\ No newline at end of file
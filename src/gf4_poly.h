@@ -46,6 +46,23 @@
      gf4_array_t coefficients;
      size_t degree;
  } gf4_poly_t;
+
+#define GF4_POLY_INVERT_WS_POLYS 6 ///< number of workspace polynomials used by gf4_poly_invert_ws
+
+/**
+ * @brief Pool of temporary polynomials of the same capacity.
+ *
+ * All coefficients are stored in one buffer allocated by gf4_poly_workspace_init. Temporaries are taken
+ * in a stack-like manner: gf4_poly_workspace_mark remembers the current top, gf4_poly_workspace_release
+ * returns all polynomials taken since then in O(1). Workspace polynomials must never be deinitialized or resized.
+ */
+typedef struct {
+    gf4_t * buffer; ///< coefficients of all polynomials
+    gf4_poly_t * polys; ///< polynomials, their coefficients point into buffer
+    size_t num_polys; ///< number of polynomials
+    size_t capacity; ///< capacity of every polynomial
+    size_t used; ///< number of polynomials taken
+} gf4_poly_workspace_t;
 // initialization
 /**
  * @brief Initialize a zero polynomial with the given capacity.
@@ -188,6 +205,9 @@ void gf4_poly_div_x_to_deg_inplace(gf4_poly_t * poly, size_t deg);
  * @brief (div, mod) = (a / b, a % b)
  *
  * div, rem, a, b must be initialized beforehand.
+ * If b is a binomial l*x^r + c (e.g. the modulus x^r + 1), the division takes O(a->degree) time
+ * instead of O((a->degree - r) * r) time of the long division: every coefficient i >= r of the dividend
+ * is folded into coefficient i - r once.
  * If resizing is enabled, div and rem may be resized to fit the result of multiplication.
  * If it is not enabled, div and rem must have sufficient capacity.
  *
@@ -202,7 +222,7 @@ void gf4_poly_div_rem(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_po
 /**
  * @brief maybe_inverse = poly^-1 (mod modulus)
  *
- * Implemented using xgcd.
+ * Implemented using xgcd, see gf4_poly_invert_ws for a variant without allocations.
  * maybe_inverse will be zeroed out if the inverse does not exist.
  *
  * maybe_inverse, poly, modulus must be initialized beforehand.
@@ -216,6 +236,91 @@ void gf4_poly_div_rem(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_po
  */
 bool gf4_poly_invert_slow(gf4_poly_t * maybe_inverse, gf4_poly_t * poly, gf4_poly_t * modulus);
 
+/**
+ * @brief maybe_inverse = poly^-1 (mod modulus), temporaries are taken from a workspace.
+ *
+ * Same as gf4_poly_invert_slow, but no memory is allocated.
+ * ws must have at least GF4_POLY_INVERT_WS_POLYS free polynomials of capacity > max(poly->degree, modulus->degree).
+ *
+ * @param maybe_inverse pointer to the polynomial to store the inverse in
+ * @param poly pointer to the polynomial to be inverted
+ * @param modulus pointer to the polynomial to by used as a modulus
+ * @param ws workspace
+ * @return true if the inverse was found, false otherwise
+ */
+bool gf4_poly_invert_ws(gf4_poly_t * maybe_inverse, gf4_poly_t * poly, gf4_poly_t * modulus, gf4_poly_workspace_t * ws);
+
+// workspace
+/**
+ * @brief Allocate a workspace of num_polys polynomials of the given capacity.
+ *
+ * Initialized workspace must be cleaned up using gf4_poly_workspace_deinit function if no longer needed!
+ *
+ * @param ws memory location of the workspace
+ * @param num_polys number of polynomials
+ * @param capacity capacity of every polynomial
+ */
+void gf4_poly_workspace_init(gf4_poly_workspace_t * ws, size_t num_polys, size_t capacity);
+
+/**
+ * @brief Free a workspace.
+ *
+ * @param ws an initialized workspace
+ */
+void gf4_poly_workspace_deinit(gf4_poly_workspace_t * ws);
+
+/**
+ * @brief Take a zero polynomial from a workspace.
+ *
+ * Exits if all polynomials of the workspace are taken.
+ *
+ * @param ws an initialized workspace
+ * @return pointer to a zero polynomial owned by the workspace
+ */
+gf4_poly_t * gf4_poly_workspace_take(gf4_poly_workspace_t * ws);
+
+/**
+ * @brief Remember the number of taken polynomials.
+ *
+ * @param ws an initialized workspace
+ * @return mark to be passed to gf4_poly_workspace_release
+ */
+size_t gf4_poly_workspace_mark(gf4_poly_workspace_t * ws);
+
+/**
+ * @brief Return all polynomials taken after mark was obtained, in O(1).
+ *
+ * @param ws an initialized workspace
+ * @param mark value returned by gf4_poly_workspace_mark
+ */
+void gf4_poly_workspace_release(gf4_poly_workspace_t * ws, size_t mark);
+
+/**
+ * @brief out = a * b, out may be the same polynomial as a or b.
+ *
+ * Uses one polynomial of ws, which must have capacity > a->degree + b->degree.
+ * If resizing is not enabled, out must have capacity > a->degree + b->degree.
+ *
+ * @param out pointer to a polynomial to store the result in
+ * @param a pointer to a polynomial
+ * @param b pointer to a polynomial
+ * @param ws workspace
+ */
+void gf4_poly_mul_ws(gf4_poly_t * out, gf4_poly_t * a, gf4_poly_t * b, gf4_poly_workspace_t * ws);
+
+/**
+ * @brief (div, mod) = (a / b, a % b), div and rem may be the same polynomials as a or b.
+ *
+ * Uses two polynomials of ws, which must have capacity > a->degree.
+ *
+ * @param div pointer to a polynomial to store the result of division in
+ * @param rem pointer to a polynomial to store the resulting remainder in
+ * @param a pointer to a polynomial to be used as the dividend
+ * @param b pointer to a polynomial to be used as the divisor
+ * @param ws workspace
+ */
+void gf4_poly_div_rem_ws(gf4_poly_t * div, gf4_poly_t * rem, gf4_poly_t * a, gf4_poly_t * b, gf4_poly_workspace_t * ws);
+
 // properties
 /**
  * @brief check whether polynomial is zero.
@@ -0,0 +1,963 @@
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gjs.h"
+#include "random.h"
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+
+static const char * gjs_class_names[GJS_NUM_CLASSES] = {
+        "same_e0", "same_e1", "alpha_mult_right_e0", "alpha_mult_right_e1", "alpha_mult_left_e0", "alpha_mult_left_e1"
+};
+
+gjs_relation_t gjs_relation(gf4_t a, gf4_t b) {
+    assert(0 != a && 0 != b);
+    if (a == b) {
+        return GJS_RELATION_SAME;
+    }
+    // b / a is either alpha or alpha^2 = alpha + 1
+    return (gf4_mul(2, a) == b) ? GJS_RELATION_ALPHA_RIGHT : GJS_RELATION_ALPHA_LEFT;
+}
+
+size_t gjs_class_index(gjs_relation_t relation, size_t half) {
+    assert(half < 2);
+    return 2 * (size_t)relation + half;
+}
+
+const char * gjs_class_name(size_t class_index) {
+    assert(class_index < GJS_NUM_CLASSES);
+    return gjs_class_names[class_index];
+}
+
+uint64_t gjs_key_fingerprint(decoding_context_t * ctx) {
+    assert(NULL != ctx);
+    const uint64_t fnv_offset_basis = 0xcbf29ce484222325ULL;
+    const uint64_t fnv_prime = 0x100000001b3ULL;
+    uint64_t hash = fnv_offset_basis;
+    uint64_t block_size = ctx->block_size;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+        hash = (hash ^ ((block_size >> (8 * i)) & 0xff)) * fnv_prime;
+    }
+    for (size_t i = 0; i < ctx->block_size; ++i) {
+        hash = (hash ^ ctx->h0.coefficients.array[i]) * fnv_prime;
+    }
+    for (size_t i = 0; i < ctx->block_size; ++i) {
+        hash = (hash ^ ctx->h1.coefficients.array[i]) * fnv_prime;
+    }
+    return hash;
+}
+
+gjs_support_t gjs_support_init(size_t capacity) {
+    gjs_support_t support;
+    support.weight = 0;
+    support.capacity = capacity;
+    support.positions = malloc(UTILS_MAX(capacity, 1) * sizeof(size_t));
+    support.values = malloc(UTILS_MAX(capacity, 1) * sizeof(gf4_t));
+    if (NULL == support.positions || NULL == support.values) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    return support;
+}
+
+gjs_support_t gjs_support_init_in(gf4_arena_t * arena, size_t capacity) {
+    assert(NULL != arena);
+    gjs_support_t support;
+    support.weight = 0;
+    support.capacity = capacity;
+    support.positions = gf4_arena_alloc(arena, UTILS_MAX(capacity, 1) * sizeof(size_t), false);
+    support.values = gf4_arena_alloc(arena, UTILS_MAX(capacity, 1) * sizeof(gf4_t), false);
+    return support;
+}
+
+void gjs_support_deinit(gjs_support_t * support) {
+    assert(NULL != support);
+    free(support->positions);
+    free(support->values);
+    support->positions = NULL;
+    support->values = NULL;
+    support->weight = 0;
+    support->capacity = 0;
+}
+
+void gjs_support_from_array(gjs_support_t * out_support, gf4_array_t * array, size_t offset, size_t size) {
+    assert(NULL != out_support);
+    assert(NULL != array);
+    assert(offset + size <= array->capacity);
+    out_support->weight = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (0 != array->array[offset + i]) {
+            assert(out_support->weight < out_support->capacity);
+            out_support->positions[out_support->weight] = i;
+            out_support->values[out_support->weight] = array->array[offset + i];
+            out_support->weight += 1;
+        }
+    }
+}
+
+void gjs_support_split(gjs_support_t * out_e0, gjs_support_t * out_e1, size_t * positions, gf4_t * values,
+                       size_t weight, size_t block_size) {
+    assert(NULL != out_e0);
+    assert(NULL != out_e1);
+    assert(NULL != positions);
+    assert(NULL != values);
+    out_e0->weight = 0;
+    out_e1->weight = 0;
+    for (size_t i = 0; i < weight; ++i) {
+        assert(positions[i] < 2 * block_size);
+        gjs_support_t * e = (positions[i] < block_size) ? out_e0 : out_e1;
+        size_t position = (positions[i] < block_size) ? positions[i] : positions[i] - block_size;
+        assert(e->weight < e->capacity);
+        // insertion sort, the weight is small
+        size_t j = e->weight;
+        while (j > 0 && e->positions[j - 1] > position) {
+            e->positions[j] = e->positions[j - 1];
+            e->values[j] = e->values[j - 1];
+            --j;
+        }
+        e->positions[j] = position;
+        e->values[j] = values[i];
+        e->weight += 1;
+    }
+}
+
+size_t gjs_syndrome(gf4_array_t * out_syndrome, gjs_support_t * e0, gjs_support_t * e1, gjs_support_t * h0,
+                    gjs_support_t * h1, size_t block_size) {
+    assert(NULL != out_syndrome);
+    assert(out_syndrome->capacity >= block_size);
+    size_t weight = 0;
+    gjs_support_t * e_blocks[2] = {e0, e1};
+    gjs_support_t * h_blocks[2] = {h0, h1};
+    for (size_t block = 0; block < 2; ++block) {
+        gjs_support_t * e = e_blocks[block];
+        gjs_support_t * h = h_blocks[block];
+        for (size_t a = 0; a < e->weight; ++a) {
+            for (size_t b = 0; b < h->weight; ++b) {
+                // error position j hits syndrome position (j - p) mod block_size through coefficient p of h
+                size_t j = e->positions[a];
+                size_t p = h->positions[b];
+                size_t idx = (j >= p) ? j - p : j + block_size - p;
+                bool was_zero = (0 == out_syndrome->array[idx]);
+                out_syndrome->array[idx] ^= gf4_mul(h->values[b], e->values[a]);
+                if (was_zero) {
+                    weight += 1;
+                } else if (0 == out_syndrome->array[idx]) {
+                    weight -= 1;
+                }
+            }
+        }
+    }
+    return weight;
+}
+
+void gjs_spectrum_init(gjs_spectrum_t * spectrum, size_t block_size, size_t num_errors, uint64_t key_fingerprint) {
+    assert(NULL != spectrum);
+    spectrum->block_size = block_size;
+    spectrum->num_errors = num_errors;
+    spectrum->key_fingerprint = key_fingerprint;
+    spectrum->num_distances = (block_size / 2) + 1;
+    spectrum->num_samples = 0;
+    spectrum->num_ranges = 0;
+    spectrum->ranges = NULL;
+    spectrum->weights = calloc(GJS_NUM_CLASSES * spectrum->num_distances, sizeof(uint64_t));
+    spectrum->attempts = calloc(GJS_NUM_CLASSES * spectrum->num_distances, sizeof(uint64_t));
+    spectrum->squares = calloc(GJS_NUM_CLASSES * spectrum->num_distances, sizeof(uint64_t));
+    if (NULL == spectrum->weights || NULL == spectrum->attempts || NULL == spectrum->squares) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+}
+
+void gjs_spectrum_deinit(gjs_spectrum_t * spectrum) {
+    assert(NULL != spectrum);
+    free(spectrum->weights);
+    free(spectrum->attempts);
+    free(spectrum->squares);
+    spectrum->weights = NULL;
+    spectrum->attempts = NULL;
+    spectrum->squares = NULL;
+    free(spectrum->ranges);
+    spectrum->ranges = NULL;
+    spectrum->num_ranges = 0;
+}
+
+// true if range shares a sample with a range of spectrum
+static bool gjs_spectrum_overlaps(gjs_spectrum_t * spectrum, gjs_sample_range_t * range) {
+    for (size_t i = 0; i < spectrum->num_ranges; ++i) {
+        gjs_sample_range_t * r = &spectrum->ranges[i];
+        if (r->seed == range->seed && r->sample_begin < range->sample_end && range->sample_begin < r->sample_end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// insert a range not overlapping the ones of spectrum, keeping them sorted and joining adjacent ranges
+static void gjs_spectrum_add_range(gjs_spectrum_t * spectrum, gjs_sample_range_t * range) {
+    assert(!gjs_spectrum_overlaps(spectrum, range));
+    if (range->sample_begin == range->sample_end) {
+        return;
+    }
+    size_t pos = 0;
+    while (pos < spectrum->num_ranges && (spectrum->ranges[pos].seed < range->seed
+           || (spectrum->ranges[pos].seed == range->seed && spectrum->ranges[pos].sample_begin < range->sample_begin))) {
+        ++pos;
+    }
+    gjs_sample_range_t * prev = (0 < pos) ? &spectrum->ranges[pos - 1] : NULL;
+    gjs_sample_range_t * next = (pos < spectrum->num_ranges) ? &spectrum->ranges[pos] : NULL;
+    bool join_prev = NULL != prev && prev->seed == range->seed && prev->sample_end == range->sample_begin;
+    bool join_next = NULL != next && next->seed == range->seed && next->sample_begin == range->sample_end;
+    if (join_prev && join_next) {
+        prev->sample_end = next->sample_end;
+        memmove(next, next + 1, (spectrum->num_ranges - pos - 1) * sizeof(gjs_sample_range_t));
+        spectrum->num_ranges -= 1;
+    } else if (join_prev) {
+        prev->sample_end = range->sample_end;
+    } else if (join_next) {
+        next->sample_begin = range->sample_begin;
+    } else {
+        gjs_sample_range_t * ranges = realloc(spectrum->ranges, (spectrum->num_ranges + 1) * sizeof(gjs_sample_range_t));
+        if (NULL == ranges) {
+            fprintf(stderr, "%s: Allocation error!\n", __func__);
+            exit(-1);
+        }
+        spectrum->ranges = ranges;
+        memmove(&ranges[pos + 1], &ranges[pos], (spectrum->num_ranges - pos) * sizeof(gjs_sample_range_t));
+        ranges[pos] = *range;
+        spectrum->num_ranges += 1;
+    }
+}
+
+static void gjs_spectrum_add_pairs(gjs_spectrum_t * spectrum, gjs_support_t * e, size_t half,
+                                   size_t syndrome_weight, bool * written_to) {
+    for (size_t a = 0; a < e->weight; ++a) {
+        for (size_t b = a + 1; b < e->weight; ++b) {
+            size_t diff = e->positions[b] - e->positions[a];
+            size_t distance = (diff < spectrum->num_distances) ? diff : spectrum->block_size - diff;
+            size_t idx = gjs_class_index(gjs_relation(e->values[a], e->values[b]), half) * spectrum->num_distances + distance;
+            if (!written_to[idx]) {
+                spectrum->weights[idx] += syndrome_weight;
+                spectrum->attempts[idx] += 1;
+                spectrum->squares[idx] += (uint64_t)syndrome_weight * syndrome_weight;
+                written_to[idx] = true;
+            }
+        }
+    }
+}
+
+void gjs_spectrum_add_sample(gjs_spectrum_t * spectrum, gjs_support_t * e0, gjs_support_t * e1,
+                             size_t syndrome_weight, bool * written_to) {
+    assert(NULL != spectrum);
+    assert(NULL != e0);
+    assert(NULL != e1);
+    assert(NULL != written_to);
+    gjs_spectrum_add_pairs(spectrum, e0, 0, syndrome_weight, written_to);
+    gjs_spectrum_add_pairs(spectrum, e1, 1, syndrome_weight, written_to);
+    memset(written_to, 0, GJS_NUM_CLASSES * spectrum->num_distances * sizeof(bool));
+    spectrum->num_samples += 1;
+}
+
+bool gjs_spectrum_merge(gjs_spectrum_t * spectrum, gjs_spectrum_t * other) {
+    assert(NULL != spectrum);
+    assert(NULL != other);
+    if (spectrum->block_size != other->block_size || spectrum->num_errors != other->num_errors
+        || spectrum->key_fingerprint != other->key_fingerprint) {
+        return false;
+    }
+    for (size_t i = 0; i < other->num_ranges; ++i) {
+        if (gjs_spectrum_overlaps(spectrum, &other->ranges[i])) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < GJS_NUM_CLASSES * spectrum->num_distances; ++i) {
+        spectrum->weights[i] += other->weights[i];
+        spectrum->attempts[i] += other->attempts[i];
+        spectrum->squares[i] += other->squares[i];
+    }
+    spectrum->num_samples += other->num_samples;
+    for (size_t i = 0; i < other->num_ranges; ++i) {
+        gjs_spectrum_add_range(spectrum, &other->ranges[i]);
+    }
+    return true;
+}
+
+typedef struct {
+    gjs_spectrum_t spectrum; ///< accumulator of the worker
+    gjs_support_t * h0; ///< support of the first block of the private key, shared
+    gjs_support_t * h1; ///< support of the second block of the private key, shared
+    uint64_t seed; ///< base seed of the samples
+    uint64_t sample_begin; ///< first sample of the worker (inclusive)
+    uint64_t sample_end; ///< last sample of the worker (exclusive)
+} gjs_worker_t;
+
+static void * gjs_work(void * arg) {
+    gjs_worker_t * worker = arg;
+    size_t block_size = worker->spectrum.block_size;
+    // scratch of the worker, arenas are not shared between threads
+    gf4_arena_t arena;
+    gf4_arena_init(&arena, 0);
+    size_t * positions = gf4_arena_alloc(&arena, UTILS_MAX(worker->spectrum.num_errors, 1) * sizeof(size_t), false);
+    gf4_t * values = gf4_arena_alloc(&arena, UTILS_MAX(worker->spectrum.num_errors, 1) * sizeof(gf4_t), false);
+    bool * written_to = gf4_arena_alloc(&arena, GJS_NUM_CLASSES * worker->spectrum.num_distances * sizeof(bool), true);
+    gjs_support_t e0 = gjs_support_init_in(&arena, worker->spectrum.num_errors);
+    gjs_support_t e1 = gjs_support_init_in(&arena, worker->spectrum.num_errors);
+    gf4_array_t syndrome = gf4_array_init_in(&arena, block_size, true);
+    for (uint64_t sample = worker->sample_begin; sample < worker->sample_end; ++sample) {
+        random_seed(random_derive_seed(worker->seed, sample, GJS_SAMPLE_STREAM));
+        random_error_positions(positions, values, 2 * block_size, worker->spectrum.num_errors);
+        gjs_support_split(&e0, &e1, positions, values, worker->spectrum.num_errors, block_size);
+        size_t syndrome_weight = gjs_syndrome(&syndrome, &e0, &e1, worker->h0, worker->h1, block_size);
+        gjs_spectrum_add_sample(&worker->spectrum, &e0, &e1, syndrome_weight, written_to);
+        gf4_array_zero_out(&syndrome);
+    }
+    gf4_arena_deinit(&arena);
+    return NULL;
+}
+
+void gjs_collect(gjs_spectrum_t * spectrum, decoding_context_t * ctx, uint64_t seed, uint64_t sample_begin,
+                 uint64_t sample_end, size_t num_threads) {
+    assert(NULL != spectrum);
+    assert(NULL != ctx);
+    assert(spectrum->block_size == ctx->block_size);
+    assert(spectrum->num_errors <= 2 * ctx->block_size);
+    assert(spectrum->key_fingerprint == gjs_key_fingerprint(ctx));
+    assert(sample_begin <= sample_end);
+    assert(0 < num_threads);
+    gjs_sample_range_t range = {seed, sample_begin, sample_end};
+    assert(!gjs_spectrum_overlaps(spectrum, &range));
+    uint64_t num_samples = sample_end - sample_begin;
+    num_threads = (size_t)UTILS_MAX(1, UTILS_MIN((uint64_t)num_threads, num_samples));
+
+    gjs_support_t h0 = gjs_support_init(ctx->block_size);
+    gjs_support_t h1 = gjs_support_init(ctx->block_size);
+    gjs_support_from_array(&h0, &ctx->h0.coefficients, 0, ctx->block_size);
+    gjs_support_from_array(&h1, &ctx->h1.coefficients, 0, ctx->block_size);
+
+    gjs_worker_t * workers = malloc(num_threads * sizeof(gjs_worker_t));
+    pthread_t * threads = malloc(num_threads * sizeof(pthread_t));
+    if (NULL == workers || NULL == threads) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        gjs_spectrum_init(&workers[i].spectrum, ctx->block_size, spectrum->num_errors, spectrum->key_fingerprint);
+        workers[i].h0 = &h0;
+        workers[i].h1 = &h1;
+        workers[i].seed = seed;
+        workers[i].sample_begin = sample_begin + num_samples * i / num_threads;
+        workers[i].sample_end = sample_begin + num_samples * (i + 1) / num_threads;
+    }
+    // the caller works as the first thread
+    for (size_t i = 1; i < num_threads; ++i) {
+        if (0 != pthread_create(&threads[i], NULL, gjs_work, &workers[i])) {
+            fprintf(stderr, "%s: Thread couldn't be created!\n", __func__);
+            exit(-1);
+        }
+    }
+    gjs_work(&workers[0]);
+    for (size_t i = 1; i < num_threads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        gjs_spectrum_merge(spectrum, &workers[i].spectrum);
+        gjs_spectrum_deinit(&workers[i].spectrum);
+    }
+    gjs_spectrum_add_range(spectrum, &range);
+
+    free(threads);
+    free(workers);
+    gjs_support_deinit(&h1);
+    gjs_support_deinit(&h0);
+}
+
+static void gjs_write_u64(FILE * file, uint64_t value) {
+    if (1 != fwrite(&value, sizeof(uint64_t), 1, file)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+}
+
+static uint64_t gjs_read_u64(FILE * file) {
+    uint64_t value;
+    if (1 != fread(&value, sizeof(uint64_t), 1, file)) {
+        fprintf(stderr, "%s: Read error! The file is truncated!\n", __func__);
+        exit(-1);
+    }
+    return value;
+}
+
+void gjs_spectrum_save(const char * filename, gjs_spectrum_t * spectrum) {
+    assert(NULL != filename);
+    assert(NULL != spectrum);
+
+    FILE * output = fopen(filename, "wb");
+    if (NULL == output) {
+        fprintf(stderr, "%s: Output file couldn't be created!\n", __func__);
+        exit(-1);
+    }
+    char magic[8] = {0};
+    memcpy(magic, GJS_SPECTRUM_MAGIC, strlen(GJS_SPECTRUM_MAGIC));
+    if (1 != fwrite(magic, sizeof(magic), 1, output)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+    gjs_write_u64(output, GJS_SPECTRUM_VERSION);
+    gjs_write_u64(output, spectrum->block_size);
+    gjs_write_u64(output, spectrum->num_errors);
+    gjs_write_u64(output, spectrum->key_fingerprint);
+    gjs_write_u64(output, spectrum->num_samples);
+    gjs_write_u64(output, spectrum->num_ranges);
+    for (size_t i = 0; i < spectrum->num_ranges; ++i) {
+        gjs_write_u64(output, spectrum->ranges[i].seed);
+        gjs_write_u64(output, spectrum->ranges[i].sample_begin);
+        gjs_write_u64(output, spectrum->ranges[i].sample_end);
+    }
+    size_t count = GJS_NUM_CLASSES * spectrum->num_distances;
+    if (count != fwrite(spectrum->weights, sizeof(uint64_t), count, output)
+        || count != fwrite(spectrum->attempts, sizeof(uint64_t), count, output)
+        || count != fwrite(spectrum->squares, sizeof(uint64_t), count, output)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+    fclose(output);
+}
+
+void gjs_spectrum_load(const char * filename, gjs_spectrum_t * spectrum) {
+    assert(NULL != filename);
+    assert(NULL != spectrum);
+
+    FILE * input = fopen(filename, "rb");
+    if (NULL == input) {
+        fprintf(stderr, "%s: Input file %s doesn't exist!\n", __func__, filename);
+        exit(-1);
+    }
+    char magic[8] = {0};
+    if (1 != fread(magic, sizeof(magic), 1, input) || 0 != strncmp(magic, GJS_SPECTRUM_MAGIC, sizeof(magic))) {
+        fprintf(stderr, "%s: %s is not a %s file!\n", __func__, filename, GJS_SPECTRUM_MAGIC);
+        exit(-1);
+    }
+    if (GJS_SPECTRUM_VERSION != gjs_read_u64(input)) {
+        fprintf(stderr, "%s: %s has unsupported version!\n", __func__, filename);
+        exit(-1);
+    }
+    size_t block_size = gjs_read_u64(input);
+    size_t num_errors = gjs_read_u64(input);
+    uint64_t key_fingerprint = gjs_read_u64(input);
+    gjs_spectrum_init(spectrum, block_size, num_errors, key_fingerprint);
+    spectrum->num_samples = gjs_read_u64(input);
+    size_t num_ranges = gjs_read_u64(input);
+    for (size_t i = 0; i < num_ranges; ++i) {
+        gjs_sample_range_t range;
+        range.seed = gjs_read_u64(input);
+        range.sample_begin = gjs_read_u64(input);
+        range.sample_end = gjs_read_u64(input);
+        if (range.sample_end <= range.sample_begin || gjs_spectrum_overlaps(spectrum, &range)) {
+            fprintf(stderr, "%s: %s is corrupted, invalid sample range!\n", __func__, filename);
+            exit(-1);
+        }
+        gjs_spectrum_add_range(spectrum, &range);
+    }
+    size_t count = GJS_NUM_CLASSES * spectrum->num_distances;
+    if (count != fread(spectrum->weights, sizeof(uint64_t), count, input)
+        || count != fread(spectrum->attempts, sizeof(uint64_t), count, input)
+        || count != fread(spectrum->squares, sizeof(uint64_t), count, input)) {
+        fprintf(stderr, "%s: Read error! %s is truncated!\n", __func__, filename);
+        exit(-1);
+    }
+    fclose(input);
+}
+
+void gjs_spectrum_write_text(gjs_spectrum_t * spectrum, size_t id) {
+    assert(NULL != spectrum);
+    char buffer[100] = {0};
+    for (size_t c = 0; c < GJS_NUM_CLASSES; ++c) {
+        snprintf(buffer, sizeof(buffer), "weights_%s_%zu.txt", gjs_class_name(c), id);
+        FILE * file = fopen(buffer, "w+");
+        if (NULL == file) {
+            fprintf(stderr, "%s: Fopen error!\n", __func__);
+            exit(-1);
+        }
+        for (size_t dist = 1; dist < spectrum->num_distances; ++dist) {
+            size_t idx = c * spectrum->num_distances + dist;
+            fprintf(file, "%zu %llu %llu\n", dist, (unsigned long long)spectrum->weights[idx],
+                    (unsigned long long)spectrum->attempts[idx]);
+        }
+        fclose(file);
+    }
+}
+
+void gjs_spectrum_write_means(const char * filename, gjs_spectrum_t * spectrum) {
+    assert(NULL != filename);
+    assert(NULL != spectrum);
+    FILE * file = fopen(filename, "w+");
+    if (NULL == file) {
+        fprintf(stderr, "%s: Fopen error!\n", __func__);
+        exit(-1);
+    }
+    fprintf(file, "# distance");
+    for (size_t c = 0; c < GJS_NUM_CLASSES; ++c) {
+        fprintf(file, " %s", gjs_class_name(c));
+    }
+    fprintf(file, "\n");
+    for (size_t dist = 1; dist < spectrum->num_distances; ++dist) {
+        fprintf(file, "%zu", dist);
+        for (size_t c = 0; c < GJS_NUM_CLASSES; ++c) {
+            size_t idx = c * spectrum->num_distances + dist;
+            double mean = (0 == spectrum->attempts[idx]) ? 0.0 : (double)spectrum->weights[idx] / (double)spectrum->attempts[idx];
+            fprintf(file, " %.6f", mean);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+void gjs_multiplicities_h0(decoding_context_t * ctx, size_t * out_same, size_t * out_different) {
+    assert(NULL != ctx);
+    assert(NULL != out_same);
+    assert(NULL != out_different);
+    size_t num_distances = (ctx->block_size / 2) + 1;
+    size_t * lists[2][GJS_MAX_MULTIPLICITY + 1];
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t m = 0; m <= GJS_MAX_MULTIPLICITY; ++m) {
+            lists[i][m] = calloc(ctx->block_size, sizeof(size_t));
+            if (NULL == lists[i][m]) {
+                fprintf(stderr, "%s: Allocation error!\n", __func__);
+                exit(-1);
+            }
+        }
+    }
+    utils_get_distance_multiplicities_h0(lists[0], lists[1], ctx);
+    // distances missing from the lists have a larger multiplicity
+    size_t * out[2] = {out_same, out_different};
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t d = 0; d < num_distances; ++d) {
+            out[i][d] = GJS_MAX_MULTIPLICITY;
+        }
+        for (size_t m = 0; m <= GJS_MAX_MULTIPLICITY; ++m) {
+            // lists are terminated by 0, the distance 0 is not valid
+            for (size_t k = 0; k < ctx->block_size && 0 != lists[i][m][k]; ++k) {
+                if (lists[i][m][k] < num_distances) {
+                    out[i][lists[i][m][k]] = m;
+                }
+            }
+            free(lists[i][m]);
+        }
+    }
+}
+
+double gjs_confidence_z(double confidence) {
+    assert(0.0 < confidence && confidence < 1.0);
+    // P(|X| > z) = erfc(z / sqrt(2)) is decreasing in z, bisect
+    double low = 0.0;
+    double high = 40.0;
+    for (size_t i = 0; i < 100; ++i) {
+        double middle = (low + high) / 2.0;
+        if (erfc(middle / sqrt(2.0)) > 1.0 - confidence) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+void gjs_classification_init(gjs_classification_t * classification, size_t num_distances) {
+    assert(NULL != classification);
+    classification->num_distances = num_distances;
+    for (size_t series = 0; series < 2; ++series) {
+        classification->estimates[series] = calloc(num_distances, sizeof(size_t));
+        classification->confident[series] = calloc(num_distances, sizeof(bool));
+        if (NULL == classification->estimates[series] || NULL == classification->confident[series]) {
+            fprintf(stderr, "%s: Allocation error!\n", __func__);
+            exit(-1);
+        }
+        classification->level_zero[series] = 0.0;
+        classification->level_step[series][0] = 0.0;
+        classification->level_step[series][1] = 0.0;
+        classification->num_confident[series] = 0;
+        classification->num_wrong[series] = 0;
+    }
+    classification->log_likelihood = -INFINITY;
+}
+
+void gjs_classification_deinit(gjs_classification_t * classification) {
+    assert(NULL != classification);
+    for (size_t series = 0; series < 2; ++series) {
+        free(classification->estimates[series]);
+        free(classification->confident[series]);
+        classification->estimates[series] = NULL;
+        classification->confident[series] = NULL;
+    }
+}
+
+// number of samples, mean and variance of the syndrome weights of a series at a distance
+static double gjs_series_mean(gjs_spectrum_t * spectrum, gjs_series_t series, size_t distance,
+                              double * out_count, double * out_variance) {
+    size_t classes[2] = {gjs_class_index(GJS_RELATION_SAME, 0), gjs_class_index(GJS_RELATION_SAME, 0)};
+    size_t num_classes = 1;
+    if (GJS_SERIES_DIFFERENT == series) {
+        classes[0] = gjs_class_index(GJS_RELATION_ALPHA_RIGHT, 0);
+        classes[1] = gjs_class_index(GJS_RELATION_ALPHA_LEFT, 0);
+        num_classes = 2;
+    }
+    double count = 0.0, sum = 0.0, squares = 0.0;
+    for (size_t i = 0; i < num_classes; ++i) {
+        size_t idx = classes[i] * spectrum->num_distances + distance;
+        count += (double)spectrum->attempts[idx];
+        sum += (double)spectrum->weights[idx];
+        squares += (double)spectrum->squares[idx];
+    }
+    *out_count = count;
+    if (count < 2.0) {
+        *out_variance = 0.0;
+        return (0.0 == count) ? 0.0 : sum / count;
+    }
+    double mean = sum / count;
+    *out_variance = UTILS_MAX(0.0, (squares - sum * mean) / (count - 1.0));
+    return mean;
+}
+
+static double gjs_det3(double m[3][3]) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+           - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+           + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+// solve the 3x3 system m * out = rhs by Cramer's rule, false if m is singular
+static bool gjs_solve3(double m[3][3], double rhs[3], double out[3]) {
+    double det = gjs_det3(m);
+    if (fabs(det) < 1e-9) {
+        return false;
+    }
+    for (size_t col = 0; col < 3; ++col) {
+        double replaced[3][3];
+        memcpy(replaced, m, sizeof(replaced));
+        for (size_t row = 0; row < 3; ++row) {
+            replaced[row][col] = rhs[row];
+        }
+        out[col] = gjs_det3(replaced) / det;
+    }
+    return true;
+}
+
+// (m_same, m_different) lattice points of the mixture fitted by gjs_classify, index m_same * (GJS_MAX_MULTIPLICITY + 1) + m_different
+#define GJS_NUM_COMPONENTS ((GJS_MAX_MULTIPLICITY + 1) * (GJS_MAX_MULTIPLICITY + 1))
+#define GJS_FIT_MAX_ITERATIONS 200
+#define GJS_FIT_RESTART_DROP 0.25
+
+static size_t gjs_component_multiplicity(size_t component, gjs_series_t series) {
+    return (GJS_SERIES_SAME == series) ? component / (GJS_MAX_MULTIPLICITY + 1) : component % (GJS_MAX_MULTIPLICITY + 1);
+}
+
+static int gjs_compare_double(const void * a, const void * b) {
+    double aa = *(const double *)a;
+    double bb = *(const double *)b;
+    return (aa > bb) - (aa < bb);
+}
+
+// m_same + m_different - mean_multiplicity of a lattice point
+static double gjs_component_excess(size_t component, double mean_multiplicity) {
+    return (double)(gjs_component_multiplicity(component, GJS_SERIES_SAME)
+                    + gjs_component_multiplicity(component, GJS_SERIES_DIFFERENT)) - mean_multiplicity;
+}
+
+// mixture weights maximizing sum_k counts[k] * log(weights[k]) with the mean multiplicity m_same + m_different
+// fixed to mean_multiplicity: weights[k] = counts[k] / (total + beta * excess_k), beta is bisected
+static void gjs_mixture_weights(double * counts, double mean_multiplicity, double * out_weights) {
+    double total = 0.0;
+    for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+        total += counts[k];
+    }
+    // beta keeping the denominators of the nonzero counts positive
+    double low = -INFINITY, high = INFINITY;
+    for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+        double excess = gjs_component_excess(k, mean_multiplicity);
+        if (0.0 < counts[k] && 0.0 < excess) {
+            low = UTILS_MAX(low, -total / excess);
+        } else if (0.0 < counts[k] && excess < 0.0) {
+            high = UTILS_MIN(high, -total / excess);
+        }
+    }
+    double beta = 0.0;
+    if (isfinite(low) && isfinite(high)) {
+        // the mean excess of the weights decreases in beta from +inf at low to -inf at high
+        for (size_t i = 0; i < 200; ++i) {
+            beta = (low + high) / 2.0;
+            double excess_sum = 0.0;
+            for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+                double excess = gjs_component_excess(k, mean_multiplicity);
+                excess_sum += (0.0 < counts[k]) ? counts[k] * excess / (total + beta * excess) : 0.0;
+            }
+            if (0.0 < excess_sum) {
+                low = beta;
+            } else {
+                high = beta;
+            }
+        }
+    } // otherwise mean_multiplicity is out of reach of the nonzero counts, the weights are left unconstrained
+    double sum = 0.0;
+    for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+        out_weights[k] = (0.0 < counts[k]) ? counts[k] / (total + beta * gjs_component_excess(k, mean_multiplicity)) : 0.0;
+        sum += out_weights[k];
+    }
+    // beta at a bound of the bisection (the constraint cannot be met) makes a weight overflow
+    bool constrained = isfinite(sum) && 0.0 < sum;
+    for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+        out_weights[k] = constrained ? out_weights[k] / sum : counts[k] / total;
+    }
+}
+
+// means and squared standard errors of both series at the distances used by the fit
+typedef struct {
+    size_t num_points; ///< number of distances with at least two samples in both series
+    double * means[2]; ///< means of the series
+    double * errors[2]; ///< squared standard errors of the means
+    double * responsibilities; ///< num_points * GJS_NUM_COMPONENTS scratch items
+} gjs_fit_data_t;
+
+// EM fit of the mixture of the lattice points, level_zero and level_step are the start and the result,
+// returns the log-likelihood (without the constant terms) or -INFINITY if the levels cannot be fitted
+static double gjs_fit_levels(gjs_fit_data_t * data, double mean_multiplicity, double level_zero[2], double level_step[2][2]) {
+    double weights[GJS_NUM_COMPONENTS];
+    for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+        weights[k] = 1.0 / GJS_NUM_COMPONENTS;
+    }
+    double log_likelihood = -INFINITY;
+    for (size_t iteration = 0; iteration < GJS_FIT_MAX_ITERATIONS; ++iteration) {
+        // E step: posterior probabilities of the lattice points
+        double previous = log_likelihood;
+        double counts[GJS_NUM_COMPONENTS] = {0.0};
+        // the log-weights and the levels of the lattice points do not depend on the distance
+        double log_weights[GJS_NUM_COMPONENTS], levels[2][GJS_NUM_COMPONENTS];
+        for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+            log_weights[k] = (0.0 < weights[k]) ? log(weights[k]) : -INFINITY;
+            for (size_t series = 0; series < 2; ++series) {
+                levels[series][k] = level_zero[series]
+                                    - level_step[series][0] * (double)gjs_component_multiplicity(k, GJS_SERIES_SAME)
+                                    - level_step[series][1] * (double)gjs_component_multiplicity(k, GJS_SERIES_DIFFERENT);
+            }
+        }
+        log_likelihood = 0.0;
+        for (size_t i = 0; i < data->num_points; ++i) {
+            double * r = &data->responsibilities[i * GJS_NUM_COMPONENTS];
+            double half_precision[2] = {0.5 / data->errors[0][i], 0.5 / data->errors[1][i]};
+            double largest = -INFINITY;
+            for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+                double residual[2] = {data->means[0][i] - levels[0][k], data->means[1][i] - levels[1][k]};
+                r[k] = log_weights[k] - half_precision[0] * residual[0] * residual[0] - half_precision[1] * residual[1] * residual[1];
+                largest = UTILS_MAX(largest, r[k]);
+            }
+            double sum = 0.0;
+            for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+                r[k] = exp(r[k] - largest);
+                sum += r[k];
+            }
+            for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+                r[k] /= sum;
+                counts[k] += r[k];
+            }
+            log_likelihood += largest + log(sum);
+        }
+        if (!isfinite(log_likelihood)) {
+            return -INFINITY;
+        }
+        if (fabs(log_likelihood - previous) <= 1e-9 * fabs(log_likelihood)) {
+            break;
+        }
+        // M step: weights under the multiplicity constraint, levels by weighted least squares
+        gjs_mixture_weights(counts, mean_multiplicity, weights);
+        for (size_t series = 0; series < 2; ++series) {
+            // the sums over the distances are taken per lattice point, the regressors only depend on the point
+            double precisions[GJS_NUM_COMPONENTS] = {0.0}, weighted_means[GJS_NUM_COMPONENTS] = {0.0};
+            for (size_t i = 0; i < data->num_points; ++i) {
+                double * r = &data->responsibilities[i * GJS_NUM_COMPONENTS];
+                double precision = 1.0 / data->errors[series][i];
+                for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+                    precisions[k] += r[k] * precision;
+                    weighted_means[k] += r[k] * precision * data->means[series][i];
+                }
+            }
+            double normal[3][3] = {{0.0}};
+            double rhs[3] = {0.0};
+            for (size_t k = 0; k < GJS_NUM_COMPONENTS; ++k) {
+                double x[3] = {1.0, -(double)gjs_component_multiplicity(k, GJS_SERIES_SAME),
+                               -(double)gjs_component_multiplicity(k, GJS_SERIES_DIFFERENT)};
+                for (size_t a = 0; a < 3; ++a) {
+                    for (size_t b = 0; b < 3; ++b) {
+                        normal[a][b] += precisions[k] * x[a] * x[b];
+                    }
+                    rhs[a] += weighted_means[k] * x[a];
+                }
+            }
+            double coefficients[3];
+            if (!gjs_solve3(normal, rhs, coefficients)) {
+                return -INFINITY;
+            }
+            level_zero[series] = coefficients[0];
+            level_step[series][0] = coefficients[1];
+            level_step[series][1] = coefficients[2];
+        }
+    }
+    return log_likelihood;
+}
+
+bool gjs_classify(gjs_classification_t * classification, gjs_spectrum_t * spectrum, size_t num_pairs,
+                  size_t ** multiplicities, double z) {
+    assert(NULL != classification);
+    assert(NULL != spectrum);
+    assert(classification->num_distances == spectrum->num_distances);
+    size_t num_distances = spectrum->num_distances;
+    for (size_t series = 0; series < 2; ++series) {
+        classification->num_confident[series] = 0;
+        classification->num_wrong[series] = 0;
+        memset(classification->estimates[series], 0, num_distances * sizeof(size_t));
+        memset(classification->confident[series], 0, num_distances * sizeof(bool));
+    }
+
+    gjs_fit_data_t data;
+    data.num_points = 0;
+    for (size_t series = 0; series < 2; ++series) {
+        data.means[series] = malloc(num_distances * sizeof(double));
+        data.errors[series] = malloc(num_distances * sizeof(double));
+    }
+    data.responsibilities = malloc(num_distances * GJS_NUM_COMPONENTS * sizeof(double));
+    double * sorted = malloc(num_distances * sizeof(double));
+    if (NULL == data.means[0] || NULL == data.means[1] || NULL == data.errors[0] || NULL == data.errors[1]
+        || NULL == data.responsibilities || NULL == sorted) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t d = 1; d < num_distances; ++d) {
+        double count[2], variance[2], mean[2];
+        mean[0] = gjs_series_mean(spectrum, GJS_SERIES_SAME, d, &count[0], &variance[0]);
+        mean[1] = gjs_series_mean(spectrum, GJS_SERIES_DIFFERENT, d, &count[1], &variance[1]);
+        if (count[0] < 2.0 || count[1] < 2.0 || 0.0 == variance[0] || 0.0 == variance[1]) {
+            continue;
+        }
+        for (size_t series = 0; series < 2; ++series) {
+            data.means[series][data.num_points] = mean[series];
+            data.errors[series][data.num_points] = variance[series] / count[series];
+        }
+        data.num_points += 1;
+    }
+
+    // the levels are fitted without the key: a mixture of the lattice points of the multiplicities is fitted
+    // to the means by EM. The pairs of h0 fall into the distances, so the mean multiplicity is num_pairs / distances,
+    // this fixes the scale of the steps, which the means alone cannot (a finer lattice fits them as well).
+    bool fitted = false;
+    if (0 < data.num_points && 0 < num_pairs) {
+        double mean_multiplicity = (double)num_pairs / (double)(num_distances - 1);
+        // most distances have multiplicities 0, so the median is close to level_zero and the average lies
+        // about one unit of step times the mean multiplicity below it
+        double median[2], unit = 0.0;
+        for (size_t series = 0; series < 2; ++series) {
+            double average = 0.0;
+            for (size_t i = 0; i < data.num_points; ++i) {
+                sorted[i] = data.means[series][i];
+                average += data.means[series][i] / (double)data.num_points;
+            }
+            qsort(sorted, data.num_points, sizeof(double), gjs_compare_double);
+            median[series] = sorted[data.num_points / 2];
+            unit += (median[series] - average) / mean_multiplicity / 2.0;
+        }
+        // EM only finds a local maximum. Once a fit exists, it is refined from the previous levels, the samples
+        // added since then move the means little. EM is restarted from steps of several sizes before the first fit
+        // and whenever the refined fit explains the means worse than the previous fit did.
+        double best = -INFINITY;
+        double best_zero[2] = {0.0}, best_step[2][2] = {{0.0}};
+        if (isfinite(classification->log_likelihood)) {
+            memcpy(best_zero, classification->level_zero, sizeof(best_zero));
+            memcpy(best_step, classification->level_step, sizeof(best_step));
+            best = gjs_fit_levels(&data, mean_multiplicity, best_zero, best_step);
+            fitted = isfinite(best);
+        }
+        static const double multipliers[] = {0.5, 1.0, 1.5, 2.5, 4.0};
+        static const double cross_ratios[] = {0.0, 0.5};
+        size_t num_starts = sizeof(multipliers) / sizeof(multipliers[0]) * sizeof(cross_ratios) / sizeof(cross_ratios[0]);
+        bool restart = !fitted || best / (double)data.num_points
+                       < classification->log_likelihood - GJS_FIT_RESTART_DROP * fabs(classification->log_likelihood);
+        for (size_t start = 0; start < num_starts && restart && 0.0 < unit; ++start) {
+            double level_zero[2], level_step[2][2];
+            double step = multipliers[start / 2] * unit;
+            double cross = cross_ratios[start % 2] * step;
+            level_zero[0] = median[0];
+            level_zero[1] = median[1];
+            level_step[0][0] = step;
+            level_step[0][1] = cross;
+            level_step[1][0] = cross;
+            level_step[1][1] = step;
+            double log_likelihood = gjs_fit_levels(&data, mean_multiplicity, level_zero, level_step);
+            if (log_likelihood > best) {
+                best = log_likelihood;
+                memcpy(best_zero, level_zero, sizeof(best_zero));
+                memcpy(best_step, level_step, sizeof(best_step));
+                fitted = true;
+            }
+        }
+        if (fitted) {
+            memcpy(classification->level_zero, best_zero, sizeof(best_zero));
+            memcpy(classification->level_step, best_step, sizeof(best_step));
+            classification->log_likelihood = best / (double)data.num_points;
+        }
+    }
+    free(sorted);
+    free(data.responsibilities);
+    for (size_t series = 0; series < 2; ++series) {
+        free(data.means[series]);
+        free(data.errors[series]);
+    }
+    if (!fitted) {
+        return false;
+    }
+
+    // the means are mapped back to the multiplicities by the inverse of the step matrix
+    double (*step)[2] = classification->level_step;
+    double det = step[0][0] * step[1][1] - step[0][1] * step[1][0];
+    if (step[0][0] <= 0.0 || step[1][1] <= 0.0 || det <= 1e-12) {
+        return false;
+    }
+    double inverse[2][2] = {{step[1][1] / det, -step[0][1] / det}, {-step[1][0] / det, step[0][0] / det}};
+
+    for (size_t d = 1; d < num_distances; ++d) {
+        double count[2], variance[2], drop[2];
+        drop[0] = classification->level_zero[0] - gjs_series_mean(spectrum, GJS_SERIES_SAME, d, &count[0], &variance[0]);
+        drop[1] = classification->level_zero[1] - gjs_series_mean(spectrum, GJS_SERIES_DIFFERENT, d, &count[1], &variance[1]);
+        if (count[0] < 2.0 || count[1] < 2.0) {
+            continue;
+        }
+        for (size_t series = 0; series < 2; ++series) {
+            double position = inverse[series][0] * drop[0] + inverse[series][1] * drop[1];
+            double half_width = z * sqrt(inverse[series][0] * inverse[series][0] * variance[0] / count[0]
+                                         + inverse[series][1] * inverse[series][1] * variance[1] / count[1]);
+            size_t estimate = (position <= 0.0) ? 0 : (size_t)UTILS_MIN(floor(position + 0.5), (double)GJS_MAX_MULTIPLICITY);
+            // the region of the estimate is (estimate - 1/2, estimate + 1/2), the outer classes are open
+            bool above_lower = (0 == estimate) || (position - half_width > (double)estimate - 0.5);
+            bool below_upper = (GJS_MAX_MULTIPLICITY == estimate) || (position + half_width < (double)estimate + 0.5);
+            classification->estimates[series][d] = estimate;
+            if (above_lower && below_upper) {
+                classification->confident[series][d] = true;
+                classification->num_confident[series] += 1;
+                if (NULL != multiplicities && estimate != multiplicities[series][d]) {
+                    classification->num_wrong[series] += 1;
+                }
+            }
+        }
+    }
+    return num_distances - 1 == classification->num_confident[0] && num_distances - 1 == classification->num_confident[1];
+}
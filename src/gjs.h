@@ -0,0 +1,402 @@
+/**
+ *  @file   gjs.h
+ *  @brief  Collection of the syndrome weight spectrum used by the GJS reaction attack.
+ *  @author Tomáš Vavro
+ *  @date   2026-10-19
+ ***********************************************/
+
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDPC_GF4_GJS_H
+#define MDPC_GF4_GJS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "gf4.h"
+#include "gf4_array.h"
+#include "contexts.h"
+
+#define GJS_SAMPLE_STREAM (UINT64_MAX - 1) ///< second index used to derive the seed of a sample, see random_derive_seed
+#define GJS_NUM_RELATIONS 3 ///< number of relations of two nonzero symbols, see gjs_relation_t
+#define GJS_NUM_CLASSES (2 * GJS_NUM_RELATIONS) ///< number of (relation, half of the error vector) classes
+#define GJS_SPECTRUM_MAGIC "MDPCGJS"
+#define GJS_SPECTRUM_VERSION 3
+#define GJS_MAX_MULTIPLICITY 3 ///< largest multiplicity class, larger multiplicities fall into it
+
+/**
+ * @brief Relation of the symbols a (smaller position) and b (larger position) of a pair of errors.
+ */
+typedef enum {
+    GJS_RELATION_SAME = 0, ///< b == a
+    GJS_RELATION_ALPHA_RIGHT = 1, ///< b == alpha * a
+    GJS_RELATION_ALPHA_LEFT = 2 ///< a == alpha * b
+} gjs_relation_t;
+
+/**
+ * @brief Series of the spectrum classified into the distance multiplicities of h0.
+ */
+typedef enum {
+    GJS_SERIES_SAME = 0, ///< class same_e0, multiplicities of pairs of h0 with the same symbols
+    GJS_SERIES_DIFFERENT = 1 ///< classes alpha_mult_right_e0 and alpha_mult_left_e0 together, pairs with different symbols
+} gjs_series_t;
+
+/**
+ * @brief Nonzero entries of a vector in ascending order of their positions.
+ */
+typedef struct {
+    size_t weight; ///< number of nonzero entries
+    size_t capacity; ///< maximum number of nonzero entries
+    size_t * positions; ///< positions of the nonzero entries in ascending order
+    gf4_t * values; ///< values of the nonzero entries
+} gjs_support_t;
+
+/**
+ * @brief Samples sample_begin, ..., sample_end - 1 of the base seed seed, see gjs_collect.
+ */
+typedef struct {
+    uint64_t seed; ///< base seed of the samples
+    uint64_t sample_begin; ///< first sample (inclusive)
+    uint64_t sample_end; ///< last sample (exclusive)
+} gjs_sample_range_t;
+
+/**
+ * @brief Syndrome weight spectrum.
+ *
+ * For every class c (see gjs_class_index) and cyclic distance d, weights[c * num_distances + d] is the sum
+ * of syndrome weights of the samples containing at least one pair of class c at distance d
+ * and attempts[c * num_distances + d] is the number of such samples.
+ * squares holds the sums of squared syndrome weights, so the variance of every mean can be estimated.
+ * Distance 0 is never written to.
+ *
+ * Only spectra of the same private key (see gjs_key_fingerprint) and the same number of errors can be merged.
+ * ranges records the collected samples, so that no sample is counted twice by merging spectra of overlapping
+ * ranges of the same seed.
+ */
+typedef struct {
+    size_t block_size; ///< size of the circulant block
+    size_t num_errors; ///< hamming weight of the error vectors
+    uint64_t key_fingerprint; ///< fingerprint of the private key, see gjs_key_fingerprint
+    size_t num_distances; ///< block_size / 2 + 1, distances 1, ..., num_distances - 1 are valid
+    uint64_t num_samples; ///< number of collected samples
+    size_t num_ranges; ///< number of sample ranges
+    gjs_sample_range_t * ranges; ///< collected samples sorted by seed and sample_begin, adjacent ranges of a seed are joined
+    uint64_t * weights; ///< sums of syndrome weights, GJS_NUM_CLASSES * num_distances items
+    uint64_t * attempts; ///< numbers of samples, GJS_NUM_CLASSES * num_distances items
+    uint64_t * squares; ///< sums of squared syndrome weights, GJS_NUM_CLASSES * num_distances items
+} gjs_spectrum_t;
+
+/**
+ * @brief Classification of the distances into multiplicity classes 0, ..., GJS_MAX_MULTIPLICITY of both series.
+ *
+ * A pair of h0 at the distance of a pair of errors lowers the syndrome weight whether it cancels
+ * the errors (same relation) or merges them into one nonzero symbol. Therefore the mean of series s
+ * is modelled as level_zero[s] - level_step[s][GJS_SERIES_SAME] * m_same - level_step[s][GJS_SERIES_DIFFERENT] * m_different,
+ * where m_same and m_different are the multiplicities of the distance. Arrays are indexed by gjs_series_t.
+ * The levels are fitted without the key, see gjs_classify.
+ */
+typedef struct {
+    size_t num_distances; ///< number of distances, distance 0 is not classified
+    size_t * estimates[2]; ///< estimated multiplicity of every distance
+    bool * confident[2]; ///< true if the confidence interval of the multiplicity lies in the region of the estimate
+    double level_zero[2]; ///< fitted mean syndrome weight of the series at multiplicities 0
+    double level_step[2][2]; ///< fitted decrease of the mean of a series per unit of multiplicity of a series
+    double log_likelihood; ///< log-likelihood of the fitted levels per distance, -INFINITY before the first fit
+    size_t num_confident[2]; ///< number of confidently classified distances
+    size_t num_wrong[2]; ///< number of confidently classified distances with a wrong estimate, if the key is known
+} gjs_classification_t;
+
+/**
+ * @brief Relation of two nonzero symbols.
+ *
+ * @param a symbol on the smaller position
+ * @param b symbol on the larger position
+ * @return relation of a and b
+ */
+gjs_relation_t gjs_relation(gf4_t a, gf4_t b);
+
+/**
+ * @brief Index of a class, classes are ordered as same_e0, same_e1, alpha_mult_right_e0, ...
+ *
+ * @param relation relation of the symbols of a pair
+ * @param half half of the error vector the pair lies in (0 or 1)
+ * @return index of the class, smaller than GJS_NUM_CLASSES
+ */
+size_t gjs_class_index(gjs_relation_t relation, size_t half);
+
+/**
+ * @brief Name of a class used in the names of the text output files, e.g. "alpha_mult_left_e1".
+ *
+ * @param class_index index of the class
+ * @return name of the class
+ */
+const char * gjs_class_name(size_t class_index);
+
+/**
+ * @brief Fingerprint of a private key, 64-bit FNV-1a hash of the block size and the coefficients of h0 and h1.
+ *
+ * @param ctx private key
+ * @return fingerprint
+ */
+uint64_t gjs_key_fingerprint(decoding_context_t * ctx);
+
+/**
+ * @brief Initialize an empty support.
+ *
+ * Initialized support must be cleaned up using gjs_support_deinit function if no longer needed!
+ *
+ * @param capacity maximum number of nonzero entries
+ * @return initialized support
+ */
+gjs_support_t gjs_support_init(size_t capacity);
+
+/**
+ * @brief Destroy a support.
+ *
+ * @param support an initialized support
+ */
+void gjs_support_deinit(gjs_support_t * support);
+
+/**
+ * @brief Initialize an empty support in an arena.
+ *
+ * The support is freed by gf4_arena_release or gf4_arena_deinit, do not call gjs_support_deinit on it!
+ *
+ * @param arena an initialized arena
+ * @param capacity maximum number of nonzero entries
+ * @return initialized support
+ */
+gjs_support_t gjs_support_init_in(gf4_arena_t * arena, size_t capacity);
+
+/**
+ * @brief Collect the nonzero entries of array[offset], ..., array[offset + size - 1].
+ *
+ * Positions are relative to offset.
+ *
+ * @param out_support an initialized support with enough capacity
+ * @param array array to scan
+ * @param offset first scanned entry
+ * @param size number of scanned entries
+ */
+void gjs_support_from_array(gjs_support_t * out_support, gf4_array_t * array, size_t offset, size_t size);
+
+/**
+ * @brief Split error positions of a vector of length 2 * block_size (see random_error_positions)
+ * into the supports of its two halves.
+ *
+ * @param out_e0 an initialized support to store the first half to
+ * @param out_e1 an initialized support to store the second half to
+ * @param positions distinct positions smaller than 2 * block_size
+ * @param values nonzero values
+ * @param weight number of positions
+ * @param block_size size of the circulant block
+ */
+void gjs_support_split(gjs_support_t * out_e0, gjs_support_t * out_e1, size_t * positions, gf4_t * values,
+                       size_t weight, size_t block_size);
+
+/**
+ * @brief Calculate syndrome of a sparse error vector.
+ *
+ * The result is the same as that of dec_calculate_syndrome, but it is computed
+ * in O(weight(e) * weight(h)) instead of O(block_size^2).
+ *
+ * @param out_syndrome zeroed out array of at least block_size items
+ * @param e0 support of the first half of the error vector
+ * @param e1 support of the second half of the error vector
+ * @param h0 support of the first block of the private key
+ * @param h1 support of the second block of the private key
+ * @param block_size size of the circulant block
+ * @return hamming weight of the syndrome
+ */
+size_t gjs_syndrome(gf4_array_t * out_syndrome, gjs_support_t * e0, gjs_support_t * e1, gjs_support_t * h0,
+                    gjs_support_t * h1, size_t block_size);
+
+/**
+ * @brief Initialize an empty spectrum.
+ *
+ * Initialized spectrum must be cleaned up using gjs_spectrum_deinit function if no longer needed!
+ *
+ * @param spectrum memory location of the spectrum
+ * @param block_size size of the circulant block
+ * @param num_errors hamming weight of the error vectors
+ * @param key_fingerprint fingerprint of the private key, see gjs_key_fingerprint
+ */
+void gjs_spectrum_init(gjs_spectrum_t * spectrum, size_t block_size, size_t num_errors, uint64_t key_fingerprint);
+
+/**
+ * @brief Destroy a spectrum.
+ *
+ * @param spectrum an initialized spectrum
+ */
+void gjs_spectrum_deinit(gjs_spectrum_t * spectrum);
+
+/**
+ * @brief Add one sample to a spectrum.
+ *
+ * Every (class, distance) is counted at most once per sample.
+ *
+ * @param spectrum an initialized spectrum
+ * @param e0 support of the first half of the error vector
+ * @param e1 support of the second half of the error vector
+ * @param syndrome_weight hamming weight of the syndrome of the error vector
+ * @param written_to scratch array of GJS_NUM_CLASSES * spectrum->num_distances items, all false, left all false
+ */
+void gjs_spectrum_add_sample(gjs_spectrum_t * spectrum, gjs_support_t * e0, gjs_support_t * e1,
+                             size_t syndrome_weight, bool * written_to);
+
+/**
+ * @brief Add other to spectrum.
+ *
+ * Spectra collected with different seeds or from disjoint ranges of the same seed can be merged,
+ * the sample ranges of other are added to the ones of spectrum.
+ *
+ * @param spectrum an initialized spectrum
+ * @param other an initialized spectrum
+ * @return true on success, false if the spectra differ in the block size, the number of errors or the key,
+ *         or if they share samples of a seed (spectrum is left unchanged then)
+ */
+bool gjs_spectrum_merge(gjs_spectrum_t * spectrum, gjs_spectrum_t * other);
+
+/**
+ * @brief Collect the samples sample_begin, ..., sample_end - 1 into spectrum.
+ *
+ * Sample i is generated from the seed random_derive_seed(seed, i, GJS_SAMPLE_STREAM), so the result
+ * depends neither on the number of threads nor on the split of the samples into ranges.
+ * Every thread accumulates into its own spectrum, the spectra are merged at the end.
+ * The range is recorded in spectrum->ranges and must not overlap the samples of seed already collected into spectrum.
+ *
+ * @param spectrum an initialized spectrum of the key ctx to accumulate to
+ * @param ctx private key
+ * @param seed base seed of the samples
+ * @param sample_begin first sample (inclusive)
+ * @param sample_end last sample (exclusive)
+ * @param num_threads number of threads, positive
+ */
+void gjs_collect(gjs_spectrum_t * spectrum, decoding_context_t * ctx, uint64_t seed, uint64_t sample_begin,
+                 uint64_t sample_end, size_t num_threads);
+
+/**
+ * @brief Save a spectrum to a binary file.
+ *
+ * The file starts with an 8 byte magic and the version followed by the block size, the number of errors,
+ * the key fingerprint, the number of samples, the number of sample ranges, the (seed, sample_begin, sample_end)
+ * triples of the ranges and the weights, attempts and squares arrays, all stored as 64-bit integers
+ * in the native byte order.
+ *
+ * @param filename savefile path
+ * @param spectrum an initialized spectrum
+ */
+void gjs_spectrum_save(const char * filename, gjs_spectrum_t * spectrum);
+
+/**
+ * @brief Load a spectrum from a binary file created by gjs_spectrum_save.
+ *
+ * Allocates all the necessary memory for spectrum. Do not initialize it yourself!
+ *
+ * @see gjs_spectrum_deinit
+ *
+ * @param filename savefile path
+ * @param spectrum memory location of the spectrum
+ */
+void gjs_spectrum_load(const char * filename, gjs_spectrum_t * spectrum);
+
+/**
+ * @brief Write a spectrum to the text files weights_<class name>_<id>.txt.
+ *
+ * Every line of a file holds a distance, the sum of syndrome weights and the number of samples.
+ *
+ * @param spectrum an initialized spectrum
+ * @param id identifier used in the file names
+ */
+void gjs_spectrum_write_text(gjs_spectrum_t * spectrum, size_t id);
+
+/**
+ * @brief Write the input of the distance classifier: the mean syndrome weight of every class and distance.
+ *
+ * Every line holds a distance followed by the means of the classes in the order of gjs_class_index,
+ * a class without samples at the distance has mean 0. The first line is a comment with the class names.
+ *
+ * @param filename output path
+ * @param spectrum an initialized spectrum
+ */
+void gjs_spectrum_write_means(const char * filename, gjs_spectrum_t * spectrum);
+
+/**
+ * @brief Find the multiplicity class of every distance of h0 using utils_get_distance_multiplicities_h0.
+ *
+ * @param ctx private key
+ * @param out_same array of ctx->block_size / 2 + 1 items to store the multiplicities of same symbols to
+ * @param out_different array of ctx->block_size / 2 + 1 items to store the multiplicities of different symbols to
+ */
+void gjs_multiplicities_h0(decoding_context_t * ctx, size_t * out_same, size_t * out_different);
+
+/**
+ * @brief Quantile z of the standard normal distribution such that P(|X| <= z) = confidence.
+ *
+ * @param confidence two-sided confidence, 0 < confidence < 1
+ * @return z
+ */
+double gjs_confidence_z(double confidence);
+
+/**
+ * @brief Initialize an empty classification.
+ *
+ * Initialized classification must be cleaned up using gjs_classification_deinit function if no longer needed!
+ *
+ * @param classification memory location of the classification
+ * @param num_distances number of distances, see gjs_spectrum_t
+ */
+void gjs_classification_init(gjs_classification_t * classification, size_t num_distances);
+
+/**
+ * @brief Destroy a classification.
+ *
+ * @param classification an initialized classification
+ */
+void gjs_classification_deinit(gjs_classification_t * classification);
+
+/**
+ * @brief Classify the distances into multiplicity classes of both series.
+ *
+ * The model (see gjs_classification_t) is fitted to the current means without the key: the means are a mixture
+ * of the points of the (m_same, m_different) lattice, which is fitted by EM with the standard errors of the means
+ * as the noise. The lattice scale is fixed by the mean multiplicity num_pairs / (num_distances - 1),
+ * a finer lattice would fit the means as well. EM is refined from the previous fit, it is restarted from several
+ * step sizes before the first fit and whenever the log-likelihood per distance drops by more than a quarter,
+ * the fit of the largest likelihood is kept.
+ * The multiplicities of every distance are then estimated by solving the model for the two means.
+ * A multiplicity is confidently classified if the interval estimate +- z * (standard error) lies within
+ * 1/2 of the nearest class. The standard errors are propagated from the variances of the syndrome weights
+ * at the distance, the two means are treated as independent. z applies to every distance on its own,
+ * a confidence of the whole classification needs a Bonferroni corrected z (see main-gjs.c).
+ *
+ * @param classification an initialized classification to store the result to, its levels are the start of the fit
+ * @param spectrum an initialized spectrum
+ * @param num_pairs number of pairs of nonzero entries of h0, block_weight * (block_weight - 1) / 2
+ * @param multiplicities true multiplicities of every distance indexed by gjs_series_t (see gjs_multiplicities_h0),
+ *                       only used to count the wrong estimates, NULL if unknown
+ * @param z quantile of the standard normal distribution, see gjs_confidence_z
+ * @return true if all the distances of both series are confidently classified, false otherwise
+ */
+bool gjs_classify(gjs_classification_t * classification, gjs_spectrum_t * spectrum, size_t num_pairs,
+                  size_t ** multiplicities, double z);
+
+#endif //MDPC_GF4_GJS_H
@@ -0,0 +1,185 @@
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "keypool.h"
+#include "report.h"
+#include "sim.h"
+#include "utils.h"
+
+static void * keypool_produce(void * arg) {
+    keypool_t * pool = arg;
+    encoding_context_t ec[CONTEXTS_BATCH_SIZE];
+    decoding_context_t dc[CONTEXTS_BATCH_SIZE];
+    contexts_seed_t key_seeds[CONTEXTS_BATCH_SIZE];
+    uint64_t batch_size = UTILS_MIN((uint64_t)CONTEXTS_BATCH_SIZE, (uint64_t)pool->capacity);
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        // wait until a whole batch of consecutive key pairs (or the rest of them) fits into the free slots
+        uint64_t count = UTILS_MIN(batch_size, pool->key_end - pool->next_produce);
+        while (!pool->stop && 0 < count && pool->next_produce + count > pool->next_consume + pool->capacity) {
+            pthread_cond_wait(&pool->consumed, &pool->mutex);
+            count = UTILS_MIN(batch_size, pool->key_end - pool->next_produce);
+        }
+        if (pool->stop || 0 == count) {
+            break;
+        }
+        uint64_t first_key = pool->next_produce;
+        pool->next_produce += count;
+        pthread_mutex_unlock(&pool->mutex);
+
+        double start = report_now();
+        for (uint64_t i = 0; i < count; ++i) {
+            contexts_seed_from_u64(&key_seeds[i], random_derive_seed(pool->seed, first_key + i, SIM_KEY_STREAM));
+        }
+        contexts_init_from_seeds(ec, dc, key_seeds, count, pool->block_size, pool->block_weight, pool->cache_dirname);
+        double elapsed = report_now() - start;
+
+        pthread_mutex_lock(&pool->mutex);
+        for (uint64_t i = 0; i < count; ++i) {
+            keypool_slot_t * slot = &pool->slots[(first_key + i) % pool->capacity];
+            assert(!slot->ready);
+            slot->enc_ctx = ec[i];
+            slot->dec_ctx = dc[i];
+            slot->ready = true;
+        }
+        pool->depth += count;
+        pool->num_generated += count;
+        pool->keygen_seconds += elapsed;
+        pthread_cond_broadcast(&pool->produced);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+void keypool_init(keypool_t * pool, uint64_t seed, uint64_t key_begin, uint64_t key_end, size_t block_size,
+                  size_t block_weight, const char * cache_dirname, size_t num_threads, size_t capacity) {
+    assert(NULL != pool);
+    assert(key_begin <= key_end);
+    assert(0 < num_threads);
+    assert(0 < capacity);
+    pool->seed = seed;
+    pool->key_end = key_end;
+    pool->block_size = block_size;
+    pool->block_weight = block_weight;
+    pool->cache_dirname = cache_dirname;
+    pool->capacity = capacity;
+    pool->slots = calloc(capacity, sizeof(keypool_slot_t));
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    if (NULL == pool->slots || NULL == pool->threads) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    pool->next_produce = key_begin;
+    pool->next_consume = key_begin;
+    pool->stop = false;
+    pool->start_time = report_now();
+    pool->num_generated = 0;
+    pool->num_taken = 0;
+    pool->depth = 0;
+    pool->depth_sum = 0;
+    pool->keygen_seconds = 0.0;
+    pool->wait_seconds = 0.0;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->produced, NULL);
+    pthread_cond_init(&pool->consumed, NULL);
+    pool->num_threads = num_threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+        if (0 != pthread_create(&pool->threads[i], NULL, keypool_produce, pool)) {
+            fprintf(stderr, "%s: Thread couldn't be created!\n", __func__);
+            exit(-1);
+        }
+    }
+}
+
+void keypool_take(keypool_t * pool, uint64_t key, encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx) {
+    assert(NULL != pool);
+    assert(NULL != out_enc_ctx);
+    assert(NULL != out_dec_ctx);
+    pthread_mutex_lock(&pool->mutex);
+    if (key != pool->next_consume || key >= pool->key_end) {
+        fprintf(stderr, "%s: Key pair %llu requested out of order!\n", __func__, (unsigned long long)key);
+        exit(-1);
+    }
+    pool->depth_sum += pool->depth;
+    keypool_slot_t * slot = &pool->slots[key % pool->capacity];
+    if (!slot->ready) {
+        double start = report_now();
+        while (!slot->ready) {
+            pthread_cond_wait(&pool->produced, &pool->mutex);
+        }
+        pool->wait_seconds += report_now() - start;
+    }
+    *out_enc_ctx = slot->enc_ctx;
+    *out_dec_ctx = slot->dec_ctx;
+    slot->ready = false;
+    pool->depth -= 1;
+    pool->num_taken += 1;
+    pool->next_consume += 1;
+    pthread_cond_broadcast(&pool->consumed);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void keypool_get_metrics(keypool_t * pool, keypool_metrics_t * out_metrics) {
+    assert(NULL != pool);
+    assert(NULL != out_metrics);
+    pthread_mutex_lock(&pool->mutex);
+    double elapsed = report_now() - pool->start_time;
+    out_metrics->num_generated = pool->num_generated;
+    out_metrics->num_taken = pool->num_taken;
+    out_metrics->depth = pool->depth;
+    out_metrics->mean_depth = (0 == pool->num_taken) ? 0.0 : (double)pool->depth_sum / (double)pool->num_taken;
+    out_metrics->keygen_seconds = pool->keygen_seconds;
+    out_metrics->keygen_rate = (elapsed > 0.0) ? (double)pool->num_generated / elapsed : 0.0;
+    out_metrics->wait_seconds = pool->wait_seconds;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void keypool_print_metrics(FILE * stream, keypool_t * pool) {
+    assert(NULL != stream);
+    assert(NULL != pool);
+    keypool_metrics_t metrics;
+    keypool_get_metrics(pool, &metrics);
+    fprintf(stream, "key pool: %zu threads, %llu key pairs generated (%.2f/s, %.3f s each), queue depth %zu (mean %.2f), "
+                    "waited %.2f s\n",
+            pool->num_threads, (unsigned long long)metrics.num_generated, metrics.keygen_rate,
+            (0 == metrics.num_generated) ? 0.0 : metrics.keygen_seconds / (double)metrics.num_generated,
+            metrics.depth, metrics.mean_depth, metrics.wait_seconds);
+}
+
+void keypool_deinit(keypool_t * pool) {
+    assert(NULL != pool);
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->consumed);
+    pthread_mutex_unlock(&pool->mutex);
+    for (size_t i = 0; i < pool->num_threads; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (size_t i = 0; i < pool->capacity; ++i) {
+        if (pool->slots[i].ready) {
+            contexts_deinit(&pool->slots[i].enc_ctx, &pool->slots[i].dec_ctx);
+        }
+    }
+    pthread_cond_destroy(&pool->consumed);
+    pthread_cond_destroy(&pool->produced);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->slots);
+    free(pool->threads);
+    pool->slots = NULL;
+    pool->threads = NULL;
+}
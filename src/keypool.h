@@ -0,0 +1,146 @@
+/**
+ *  @file   keypool.h
+ *  @brief  Background generation of key pairs.
+ *  @author Tomáš Vavro
+ *  @date   2026-10-19
+ ***********************************************/
+
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDPC_GF4_KEYPOOL_H
+#define MDPC_GF4_KEYPOOL_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "contexts.h"
+
+/**
+ * @brief One slot of the queue of generated key pairs.
+ */
+typedef struct {
+    bool ready; ///< true if the slot holds a generated key pair
+    encoding_context_t enc_ctx; ///< generated public key
+    decoding_context_t dec_ctx; ///< generated private key
+} keypool_slot_t;
+
+/**
+ * @brief Counters describing the work of a key pool.
+ */
+typedef struct {
+    uint64_t num_generated; ///< number of key pairs generated so far
+    uint64_t num_taken; ///< number of key pairs taken by the consumer
+    size_t depth; ///< number of generated key pairs waiting in the queue
+    double mean_depth; ///< mean number of waiting key pairs when the consumer asked for one
+    double keygen_seconds; ///< total time spent generating key pairs (summed over producers)
+    double keygen_rate; ///< generated key pairs per second of wall time
+    double wait_seconds; ///< total time the consumer waited for a key pair
+} keypool_metrics_t;
+
+/**
+ * @brief Pool of producer threads generating the key pairs key_begin, ..., key_end - 1 of a simulation.
+ *
+ * Key pair i is expanded from the seed random_derive_seed(seed, i, SIM_KEY_STREAM) (see contexts_seed_from_u64),
+ * so it does not depend on the thread that generates it. Producers stay at most capacity key pairs
+ * ahead of the consumer, which takes the key pairs in ascending order.
+ * A producer claims min(CONTEXTS_BATCH_SIZE, capacity) consecutive key pairs at once and expands them
+ * using contexts_init_from_seeds, so they share one inversion.
+ */
+typedef struct {
+    uint64_t seed; ///< base seed of the simulation
+    uint64_t key_end; ///< last key pair (exclusive)
+    size_t block_size; ///< size of the circulant block
+    size_t block_weight; ///< hamming weight of the circulant block
+    const char * cache_dirname; ///< expansion cache, see contexts_init_from_seed, may be NULL
+    size_t capacity; ///< maximum number of generated key pairs waiting in the queue
+    keypool_slot_t * slots; ///< queue, key pair i is stored in slots[i % capacity]
+    uint64_t next_produce; ///< next key pair to be claimed by a producer
+    uint64_t next_consume; ///< next key pair to be taken by the consumer
+    bool stop; ///< set to stop the producers
+    pthread_mutex_t mutex; ///< protects all the members above and the metrics
+    pthread_cond_t produced; ///< signalled when a key pair becomes ready
+    pthread_cond_t consumed; ///< signalled when a slot becomes free
+    size_t num_threads; ///< number of producer threads
+    pthread_t * threads; ///< producer threads
+    double start_time; ///< time the pool was started, see report_now
+    uint64_t num_generated; ///< number of generated key pairs
+    uint64_t num_taken; ///< number of key pairs taken by the consumer
+    size_t depth; ///< number of ready slots
+    uint64_t depth_sum; ///< sum of depth observed by keypool_take
+    double keygen_seconds; ///< total generation time
+    double wait_seconds; ///< total time the consumer waited
+} keypool_t;
+
+/**
+ * @brief Start producer threads.
+ *
+ * Started pool must be stopped using keypool_deinit function!
+ *
+ * @param pool memory location of the pool
+ * @param seed base seed of the simulation
+ * @param key_begin first key pair to generate (inclusive)
+ * @param key_end last key pair to generate (exclusive)
+ * @param block_size size of the circulant block
+ * @param block_weight hamming weight of the circulant block
+ * @param cache_dirname expansion cache, see contexts_init_from_seed, may be NULL
+ * @param num_threads number of producer threads, positive
+ * @param capacity maximum number of generated key pairs waiting in the queue, positive
+ */
+void keypool_init(keypool_t * pool, uint64_t seed, uint64_t key_begin, uint64_t key_end, size_t block_size,
+                  size_t block_weight, const char * cache_dirname, size_t num_threads, size_t capacity);
+
+/**
+ * @brief Take the next key pair, wait for it if it is not generated yet.
+ *
+ * Key pairs are taken in ascending order, key must be the next key pair of the pool.
+ * The caller owns the contexts and must deinitialize them using contexts_deinit.
+ *
+ * @param pool a started pool
+ * @param key index of the key pair
+ * @param out_enc_ctx memory location to store the public key to
+ * @param out_dec_ctx memory location to store the private key to
+ */
+void keypool_take(keypool_t * pool, uint64_t key, encoding_context_t * out_enc_ctx, decoding_context_t * out_dec_ctx);
+
+/**
+ * @brief Get the current metrics of a pool.
+ *
+ * @param pool a started pool
+ * @param out_metrics memory location to store the metrics to
+ */
+void keypool_get_metrics(keypool_t * pool, keypool_metrics_t * out_metrics);
+
+/**
+ * @brief Print metrics of a pool.
+ *
+ * @param stream stream to be used (e.g. stdout, stderr...)
+ * @param pool a started pool
+ */
+void keypool_print_metrics(FILE * stream, keypool_t * pool);
+
+/**
+ * @brief Stop the producers and free the key pairs that were not taken.
+ *
+ * @param pool a started pool
+ */
+void keypool_deinit(keypool_t * pool);
+
+#endif //MDPC_GF4_KEYPOOL_H
@@ -18,24 +18,85 @@
 
 #include "random.h"
 
+// every thread has its own generator, e.g. key pool producers, see keypool.h
+static _Thread_local uint64_t random_state[4];
+static _Thread_local bool random_initialized = false;
+
+static uint64_t random_splitmix64(uint64_t * x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t random_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static void random_set_seed(uint64_t seed) {
+    for (size_t i = 0; i < 4; ++i) {
+        random_state[i] = random_splitmix64(&seed);
+    }
+    random_initialized = true;
+}
+
 void random_init() {
-    static bool initialized = false;
-    if (!initialized) {
-        initialized = true;
+    if (!random_initialized) {
         time_t t;
-        srand((unsigned)time(&t));
+        // the address of the thread-local state distinguishes threads started in the same second
+        random_set_seed((uint64_t)time(&t) ^ (uint64_t)(uintptr_t)random_state);
     }
 }
 
-void random_force_reseed() {
-    time_t t;
-    srand((unsigned)time(&t));
+void random_seed(uint64_t seed) {
+    random_set_seed(seed);
+}
+
+void random_expand_seed(uint64_t seed, random_state_t * out_state) {
+    assert(NULL != out_state);
+    for (size_t i = 0; i < 4; ++i) {
+        out_state->s[i] = random_splitmix64(&seed);
+    }
+}
+
+void random_get_state(random_state_t * out_state) {
+    assert(NULL != out_state);
+    random_init();
+    memcpy(out_state->s, random_state, sizeof(random_state));
+}
+
+void random_set_state(random_state_t * state) {
+    assert(NULL != state);
+    memcpy(random_state, state->s, sizeof(random_state));
+    random_initialized = true;
+}
+
+uint64_t random_derive_seed(uint64_t base_seed, uint64_t a, uint64_t b) {
+    uint64_t x = base_seed;
+    uint64_t h = random_splitmix64(&x);
+    x = h ^ a;
+    h = random_splitmix64(&x);
+    x = h ^ b;
+    return random_splitmix64(&x);
+}
+
+uint64_t random_u64() {
+    random_init();
+    // xoshiro256**
+    const uint64_t result = random_rotl(random_state[1] * 5, 7) * 9;
+    const uint64_t t = random_state[1] << 17;
+    random_state[2] ^= random_state[0];
+    random_state[3] ^= random_state[1];
+    random_state[1] ^= random_state[2];
+    random_state[0] ^= random_state[3];
+    random_state[2] ^= t;
+    random_state[3] = random_rotl(random_state[3], 45);
+    return result;
 }
 
 size_t random_from_range(size_t low_bound_inclusive, size_t top_bound_inclusive) {
     assert(low_bound_inclusive < top_bound_inclusive);
-    random_init();
-    return low_bound_inclusive + (rand() % (top_bound_inclusive - low_bound_inclusive + 1));
+    return low_bound_inclusive + (size_t)(random_u64() % (top_bound_inclusive - low_bound_inclusive + 1));
 }
 
 void random_gf4_array(gf4_array_t *array, size_t size) {
@@ -63,6 +124,27 @@ void random_weighted_gf4_array(gf4_array_t *array, size_t size, size_t weight) {
     }
 }
 
+void random_error_positions(size_t *out_positions, gf4_t *out_values, size_t size, size_t weight) {
+    assert(NULL != out_positions);
+    assert(NULL != out_values);
+    assert(weight <= size);
+    // rejection sampling keeps the positions in the order they were drawn, the weight is small compared to size,
+    // so the positions drawn so far are searched instead of marking them in an array of size items
+    for (size_t i = 0; i < weight; ++i) {
+        size_t position;
+        bool used;
+        do {
+            position = (size_t)(random_u64() % size);
+            used = false;
+            for (size_t j = 0; j < i && !used; ++j) {
+                used = out_positions[j] == position;
+            }
+        } while (used);
+        out_positions[i] = position;
+        out_values[i] = (gf4_t) random_from_range(1, GF4_MAX_VALUE);
+    }
+}
+
 void random_weighted_gf4_vector_pairs_common(gf4_array_t *vector, size_t size, size_t weight, size_t distance, gf4_t first, gf4_t second) {
     assert(NULL != vector);
     assert(vector->capacity >= size);
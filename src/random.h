@@ -28,29 +28,91 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include "gf4_poly.h"
 #include "gf4.h"
 
+/**
+ * @brief State of the random generator.
+ */
+typedef struct {
+    uint64_t s[4]; ///< xoshiro256** state
+} random_state_t;
+
 
 /**
- * @brief Initialize random using srand with current time.
+ * @brief Initialize random generator with current time.
  *
- * Ensures that srand is called at most once during each program execution. This function is not thread safe.
+ * Ensures that the generator is seeded at most once during each program execution.
+ * Every thread has its own generator, which is seeded separately.
  * This function doesn't need to be called explicitly.
+ * If the generator was already seeded using random_seed, this function does nothing.
  */
 void random_init();
 
 /**
- * @brief Force another call to srand using current time.
+ * @brief Seed the generator deterministically.
+ *
+ * The same seed always produces the same sequence of random values.
+ * The internal generator is xoshiro256** with its state expanded from seed using splitmix64.
+ *
+ * @param seed seed value
+ */
+void random_seed(uint64_t seed);
+
+/**
+ * @brief Compute the state random_seed would set for a seed, without changing the generator.
+ *
+ * @param seed seed value
+ * @param out_state memory location to store the state to
+ */
+void random_expand_seed(uint64_t seed, random_state_t * out_state);
+
+/**
+ * @brief Store the current state of the generator.
+ *
+ * May also call random_init().
+ *
+ * @param out_state memory location to store the state to
+ */
+void random_get_state(random_state_t * out_state);
+
+/**
+ * @brief Restore a state of the generator previously stored by random_get_state.
+ *
+ * The generator is considered to be seeded afterwards, see random_init.
+ *
+ * @param state state to restore
+ */
+void random_set_state(random_state_t * state);
+
+/**
+ * @brief Derive a seed from a base seed and two indices.
+ *
+ * Used to give every (key, message) pair of a simulation its own reproducible stream,
+ * independently of which process or in which order the pair is processed.
+ *
+ * @param base_seed base seed of the whole simulation
+ * @param a first index (e.g. key index)
+ * @param b second index (e.g. message index)
+ * @return derived seed
+ */
+uint64_t random_derive_seed(uint64_t base_seed, uint64_t a, uint64_t b);
+
+/**
+ * @brief Return a random 64-bit value.
+ *
+ * May also call random_init().
+ *
+ * @return random 64-bit value
  */
-void random_force_reseed();
+uint64_t random_u64();
 
 /**
  * @brief Return an unsigned integer within given range.
  *
  * May also call random_init().
- * This function uses rand() to generate random values.
  *
  * @param low_bound_inclusive inclusive low bound
  * @param top_bound_inclusive inclusive top bound
@@ -81,6 +143,21 @@ void random_gf4_array(gf4_array_t *array, size_t size);
  */
 void random_weighted_gf4_array(gf4_array_t *array, size_t size, size_t weight);
 
+/**
+ * @brief Generate distinct random positions with random nonzero values.
+ *
+ * The positions are in random order, so for every w <= weight the first w positions and values
+ * form a uniformly random vector of hamming weight w. Error vectors of increasing weight
+ * generated this way are nested. Duplicates are rejected by searching the positions drawn so far,
+ * which takes O(weight^2) time and allocates nothing, weight should be small compared to size.
+ *
+ * @param out_positions array of at least weight items to store the positions to
+ * @param out_values array of at least weight items to store the nonzero values to
+ * @param size length of the vector, all positions are smaller than size
+ * @param weight number of positions to generate, weight <= size
+ */
+void random_error_positions(size_t *out_positions, gf4_t *out_values, size_t size, size_t weight);
+
 
 /**
  * @brief Generate a array of given weight such that at least weight/2 ones are placed exactly distance apart.
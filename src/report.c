@@ -0,0 +1,209 @@
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "report.h"
+#include <string.h>
+#include <time.h>
+
+#define REPORT_RECORD_FIELDS 8
+
+double report_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+bool report_parse_format(const char * str, report_format_t * out_format) {
+    assert(NULL != str);
+    assert(NULL != out_format);
+    if (0 == strcmp(str, "csv")) {
+        *out_format = REPORT_FORMAT_CSV;
+    } else if (0 == strcmp(str, "jsonl")) {
+        *out_format = REPORT_FORMAT_JSONL;
+    } else if (0 == strcmp(str, "binary")) {
+        *out_format = REPORT_FORMAT_BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void report_write_u64s(report_sink_t * sink, uint64_t * values, size_t count) {
+    if (count != fwrite(values, sizeof(uint64_t), count, sink->file)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+}
+
+void report_sink_open(report_sink_t * sink, const char * filename, report_format_t format, bool append) {
+    assert(NULL != sink);
+    assert(NULL != filename);
+    sink->format = format;
+    sink->file = fopen(filename, append ? "ab" : "wb");
+    if (NULL == sink->file) {
+        fprintf(stderr, "%s: Output file %s couldn't be opened!\n", __func__, filename);
+        exit(-1);
+    }
+    sink->buffer = malloc(REPORT_BUFFER_SIZE);
+    if (NULL == sink->buffer) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    setvbuf(sink->file, sink->buffer, _IOFBF, REPORT_BUFFER_SIZE);
+
+    // header only at the beginning of the file
+    fseek(sink->file, 0, SEEK_END);
+    if (0 != ftell(sink->file)) {
+        return;
+    }
+    if (REPORT_FORMAT_CSV == format) {
+        fprintf(sink->file, "key,message,num_errors,decoder,opt,iterations,success,seconds\n");
+    } else if (REPORT_FORMAT_BINARY == format) {
+        char magic[8] = {0};
+        memcpy(magic, REPORT_BINARY_MAGIC, strlen(REPORT_BINARY_MAGIC));
+        uint64_t version = REPORT_BINARY_VERSION;
+        if (1 != fwrite(magic, sizeof(magic), 1, sink->file)) {
+            fprintf(stderr, "%s: Write error!\n", __func__);
+            exit(-1);
+        }
+        report_write_u64s(sink, &version, 1);
+    }
+}
+
+void report_sink_write(report_sink_t * sink, report_record_t * record) {
+    assert(NULL != sink);
+    assert(NULL != sink->file);
+    assert(NULL != record);
+    double seconds = 1e-9 * (double)record->nanoseconds;
+    switch (sink->format) {
+        case REPORT_FORMAT_CSV:
+            fprintf(sink->file, "%llu,%llu,%llu,%llu,%llu,%llu,%d,%.9f\n",
+                    (unsigned long long)record->key, (unsigned long long)record->message,
+                    (unsigned long long)record->num_errors, (unsigned long long)record->decoder,
+                    (unsigned long long)record->opt, (unsigned long long)record->iterations,
+                    record->success ? 1 : 0, seconds);
+            break;
+        case REPORT_FORMAT_JSONL:
+            fprintf(sink->file, "{\"key\":%llu,\"message\":%llu,\"num_errors\":%llu,\"decoder\":%llu,\"opt\":%llu,"
+                                "\"iterations\":%llu,\"success\":%s,\"seconds\":%.9f}\n",
+                    (unsigned long long)record->key, (unsigned long long)record->message,
+                    (unsigned long long)record->num_errors, (unsigned long long)record->decoder,
+                    (unsigned long long)record->opt, (unsigned long long)record->iterations,
+                    record->success ? "true" : "false", seconds);
+            break;
+        case REPORT_FORMAT_BINARY: {
+            uint64_t values[REPORT_RECORD_FIELDS] = {record->key, record->message, record->num_errors, record->decoder,
+                                                     record->opt, record->iterations, record->success, record->nanoseconds};
+            report_write_u64s(sink, values, REPORT_RECORD_FIELDS);
+            break;
+        }
+    }
+}
+
+void report_sink_flush(report_sink_t * sink) {
+    assert(NULL != sink);
+    if (0 != fflush(sink->file)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+}
+
+void report_sink_close(report_sink_t * sink) {
+    assert(NULL != sink);
+    report_sink_flush(sink);
+    fclose(sink->file);
+    free(sink->buffer);
+    sink->file = NULL;
+    sink->buffer = NULL;
+}
+
+bool report_read_binary_header(FILE * file) {
+    assert(NULL != file);
+    char magic[8] = {0};
+    uint64_t version;
+    if (1 != fread(magic, sizeof(magic), 1, file) || 1 != fread(&version, sizeof(version), 1, file)) {
+        return false;
+    }
+    return 0 == strncmp(magic, REPORT_BINARY_MAGIC, sizeof(magic)) && REPORT_BINARY_VERSION == version;
+}
+
+bool report_read_binary_record(FILE * file, report_record_t * out_record) {
+    assert(NULL != file);
+    assert(NULL != out_record);
+    uint64_t values[REPORT_RECORD_FIELDS];
+    if (REPORT_RECORD_FIELDS != fread(values, sizeof(uint64_t), REPORT_RECORD_FIELDS, file)) {
+        return false;
+    }
+    out_record->key = values[0];
+    out_record->message = values[1];
+    out_record->num_errors = values[2];
+    out_record->decoder = values[3];
+    out_record->opt = values[4];
+    out_record->iterations = values[5];
+    out_record->success = (0 != values[6]);
+    out_record->nanoseconds = values[7];
+    return true;
+}
+
+void report_progress_init(report_progress_t * progress, uint64_t total, uint64_t done, uint64_t num_failures, double interval) {
+    assert(NULL != progress);
+    progress->total = total;
+    progress->done = done;
+    progress->num_failures = num_failures;
+    progress->start_done = done;
+    progress->start_time = report_now();
+    progress->last_print = progress->start_time;
+    progress->last_print_done = done;
+    progress->interval = interval;
+}
+
+void report_progress_update(report_progress_t * progress, uint64_t num_done, uint64_t num_failures) {
+    assert(NULL != progress);
+    progress->done += num_done;
+    progress->num_failures += num_failures;
+    if (report_now() - progress->last_print >= progress->interval) {
+        report_progress_print(progress);
+    }
+}
+
+void report_progress_print(report_progress_t * progress) {
+    assert(NULL != progress);
+    double now = report_now();
+    double elapsed = now - progress->start_time;
+    double rate = (elapsed > 0.0) ? (double)(progress->done - progress->start_done) / elapsed : 0.0;
+    uint64_t remaining = (progress->total > progress->done) ? progress->total - progress->done : 0;
+    fprintf(stderr, "progress: %llu / %llu (%.1f%%), failures: %llu, %.2f trials/s",
+            (unsigned long long)progress->done, (unsigned long long)progress->total,
+            (0 == progress->total) ? 100.0 : 100.0 * (double)progress->done / (double)progress->total,
+            (unsigned long long)progress->num_failures, rate);
+    if (rate > 0.0) {
+        unsigned long long eta = (unsigned long long)((double)remaining / rate);
+        fprintf(stderr, ", ETA %lluh%02llum%02llus\n", eta / 3600, (eta / 60) % 60, eta % 60);
+    } else {
+        fprintf(stderr, ", ETA unknown\n");
+    }
+    progress->last_print = now;
+    progress->last_print_done = progress->done;
+}
+
+void report_progress_finish(report_progress_t * progress) {
+    assert(NULL != progress);
+    if (progress->last_print_done != progress->done) {
+        report_progress_print(progress);
+    }
+}
@@ -0,0 +1,192 @@
+/**
+ *  @file   report.h
+ *  @brief  Per-trial result sinks and rate-limited progress reporting.
+ *  @author Tomáš Vavro
+ *  @date   2026-10-19
+ ***********************************************/
+
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDPC_GF4_REPORT_H
+#define MDPC_GF4_REPORT_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <assert.h>
+
+#define REPORT_BINARY_MAGIC "MDPCTRL"
+#define REPORT_BINARY_VERSION 1
+#define REPORT_BUFFER_SIZE (1 << 20)
+
+/**
+ * @brief Format of the per-trial records.
+ */
+typedef enum {
+    REPORT_FORMAT_CSV, ///< header line followed by one comma separated line per trial
+    REPORT_FORMAT_JSONL, ///< one JSON object per line
+    REPORT_FORMAT_BINARY ///< 8 byte magic, 64-bit version, then fixed size records of 8 64-bit integers in native byte order
+} report_format_t;
+
+/**
+ * @brief Record of a single decoding attempt.
+ */
+typedef struct {
+    uint64_t key; ///< index of the key pair
+    uint64_t message; ///< index of the message
+    uint64_t num_errors; ///< hamming weight of the error vector
+    uint64_t decoder; ///< index of the decoder
+    uint64_t opt; ///< decoder option
+    uint64_t iterations; ///< elapsed decoding iterations (the maximum on failure)
+    bool success; ///< true if the decoding succeeded
+    uint64_t nanoseconds; ///< duration of the decryption
+} report_record_t;
+
+/**
+ * @brief Buffered output of trial records.
+ */
+typedef struct {
+    FILE * file; ///< output file
+    char * buffer; ///< stdio buffer of REPORT_BUFFER_SIZE bytes
+    report_format_t format; ///< format of the records
+} report_sink_t;
+
+/**
+ * @brief Progress line printed at most once per interval.
+ */
+typedef struct {
+    uint64_t total; ///< number of trials to run
+    uint64_t done; ///< number of finished trials
+    uint64_t num_failures; ///< number of failures among the finished trials
+    uint64_t start_done; ///< value of done when the reporting started, used for throughput
+    double start_time; ///< time when the reporting started
+    double last_print; ///< time of the last printed line
+    uint64_t last_print_done; ///< value of done in the last printed line
+    double interval; ///< minimum number of seconds between two lines
+} report_progress_t;
+
+/**
+ * @brief Monotonic time in seconds.
+ *
+ * @return seconds since an unspecified starting point
+ */
+double report_now();
+
+/**
+ * @brief Parse the name of a format: "csv", "jsonl" or "binary".
+ *
+ * @param str string to parse
+ * @param out_format memory location to store the format to
+ * @return true if str is a known format, false otherwise
+ */
+bool report_parse_format(const char * str, report_format_t * out_format);
+
+/**
+ * @brief Open a sink.
+ *
+ * The header (CSV column names or binary magic) is written only to a new or empty file,
+ * so appending to an existing file (e.g. after resuming from a checkpoint) continues its records.
+ * Opened sink must be closed using report_sink_close function!
+ *
+ * @param sink memory location of the sink
+ * @param filename output file path
+ * @param format format of the records
+ * @param append true to append to an existing file, false to truncate it
+ */
+void report_sink_open(report_sink_t * sink, const char * filename, report_format_t format, bool append);
+
+/**
+ * @brief Write a record to the sink.
+ *
+ * @param sink an opened sink
+ * @param record the record to write
+ */
+void report_sink_write(report_sink_t * sink, report_record_t * record);
+
+/**
+ * @brief Flush the buffered records to the file.
+ *
+ * @param sink an opened sink
+ */
+void report_sink_flush(report_sink_t * sink);
+
+/**
+ * @brief Flush and close the sink.
+ *
+ * @param sink an opened sink
+ */
+void report_sink_close(report_sink_t * sink);
+
+/**
+ * @brief Read the next record of a binary sink file.
+ *
+ * The file must be positioned after the header, see report_read_binary_header.
+ *
+ * @param file input file
+ * @param out_record memory location to store the record to
+ * @return true if a record was read, false at the end of the file
+ */
+bool report_read_binary_record(FILE * file, report_record_t * out_record);
+
+/**
+ * @brief Read and check the header of a binary sink file.
+ *
+ * @param file input file positioned at the beginning
+ * @return true if the header is valid, false otherwise
+ */
+bool report_read_binary_header(FILE * file);
+
+/**
+ * @brief Start progress reporting.
+ *
+ * @param progress memory location of the progress
+ * @param total number of trials to run
+ * @param done number of already finished trials (e.g. restored from a checkpoint)
+ * @param num_failures number of failures among them
+ * @param interval minimum number of seconds between two printed lines
+ */
+void report_progress_init(report_progress_t * progress, uint64_t total, uint64_t done, uint64_t num_failures, double interval);
+
+/**
+ * @brief Count finished trials and failures and print the progress line if the interval has elapsed.
+ *
+ * The line contains the number of finished trials, failures, throughput and estimated remaining time.
+ *
+ * @param progress initialized progress
+ * @param num_done number of newly finished trials
+ * @param num_failures number of new failures
+ */
+void report_progress_update(report_progress_t * progress, uint64_t num_done, uint64_t num_failures);
+
+/**
+ * @brief Print the progress line regardless of the interval.
+ *
+ * @param progress initialized progress
+ */
+void report_progress_print(report_progress_t * progress);
+
+/**
+ * @brief Print the final progress line unless the last printed line is up to date.
+ *
+ * @param progress initialized progress
+ */
+void report_progress_finish(report_progress_t * progress);
+
+#endif //MDPC_GF4_REPORT_H
@@ -0,0 +1,686 @@
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sim.h"
+#include "keypool.h"
+#include "utils.h"
+#include <math.h>
+#include <unistd.h>
+
+#define SIM_RESULT_MAGIC "MDPCSIM"
+#define SIM_RESULT_VERSION 3
+#define SIM_CHECKPOINT_MAGIC "MDPCCKP"
+#define SIM_CHECKPOINT_VERSION 2
+
+bool sim_select_decoder(size_t decoder, size_t opt, sim_decode_function_t * out_decode, long (**out_threshold)(long)) {
+    assert(NULL != out_decode);
+    assert(NULL != out_threshold);
+    *out_decode = NULL;
+    *out_threshold = NULL;
+    switch (decoder) {
+        case 0:
+            *out_decode = &dec_decode_symbol_flipping;
+            break;
+        case 2:
+            *out_decode = &dec_decode_symbol_flipping_delta;
+            break;
+        case 3:
+            *out_decode = &dec_decode_symbol_flipping_threshold;
+            break;
+        default:
+            return false;
+    }
+
+    // select threshold if relevant
+    if (3 == decoder) {
+        switch (opt) {
+            case 0:
+                *out_threshold = &dec_calculate_threshold_0;
+                break;
+            case 1:
+                *out_threshold = &dec_calculate_threshold_1;
+                break;
+            case 2:
+                *out_threshold = &dec_calculate_threshold_2;
+                break;
+            case 3:
+                *out_threshold = &dec_calculate_threshold_3;
+                break;
+            case 4:
+                *out_threshold = &dec_calculate_threshold_4;
+                break;
+            case 5:
+                *out_threshold = &dec_calculate_threshold_5;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool sim_parse_shard(const char * str, size_t * out_index, size_t * out_count) {
+    assert(NULL != str);
+    assert(NULL != out_index);
+    assert(NULL != out_count);
+    char * end;
+    unsigned long long index = strtoull(str, &end, 10);
+    if (end == str || '/' != *end) {
+        return false;
+    }
+    const char * count_str = end + 1;
+    unsigned long long count = strtoull(count_str, &end, 10);
+    if (end == count_str || '\0' != *end || 0 == count || index >= count) {
+        return false;
+    }
+    *out_index = (size_t)index;
+    *out_count = (size_t)count;
+    return true;
+}
+
+void sim_shard_range(sim_params_t * params, uint64_t * out_begin, uint64_t * out_end) {
+    assert(NULL != params);
+    assert(NULL != out_begin);
+    assert(NULL != out_end);
+    assert(params->shard_index < params->shard_count);
+    uint64_t num_trials = (uint64_t)params->num_keys * params->num_messages;
+    *out_begin = num_trials * params->shard_index / params->shard_count;
+    *out_end = num_trials * (params->shard_index + 1) / params->shard_count;
+}
+
+void sim_result_init(sim_result_t * result, sim_params_t * params) {
+    assert(NULL != result);
+    assert(NULL != params);
+    result->params = *params;
+    sim_shard_range(params, &result->trial_begin, &result->trial_end);
+    result->num_trials = 0;
+    result->num_failures = 0;
+    result->num_run_trials = 0;
+    result->stopped_early = false;
+    result->iterations = calloc(params->num_iterations + 1, sizeof(uint64_t));
+    if (NULL == result->iterations) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+}
+
+void sim_result_deinit(sim_result_t * result) {
+    assert(NULL != result);
+    free(result->iterations);
+    result->iterations = NULL;
+}
+
+void sim_options_init(sim_options_t * options) {
+    assert(NULL != options);
+    options->checkpoint_filename = NULL;
+    options->checkpoint_interval = 60.0;
+    options->resume = false;
+    options->stop_min_trials = 100;
+    options->stop_width = 0.0;
+    options->stop_threshold = 0.0;
+    options->sink = NULL;
+    options->progress_interval = 1.0;
+    options->corpus = NULL;
+    options->key_cache_dirname = NULL;
+    options->keygen_threads = 0;
+    options->keygen_queue_size = 2 * CONTEXTS_BATCH_SIZE;
+}
+
+void sim_wilson_interval(uint64_t num_failures, uint64_t num_trials, double z, double * out_low, double * out_high) {
+    assert(num_failures <= num_trials);
+    assert(NULL != out_low);
+    assert(NULL != out_high);
+    if (0 == num_trials) {
+        *out_low = 0.0;
+        *out_high = 1.0;
+        return;
+    }
+    double n = (double)num_trials;
+    double p = (double)num_failures / n;
+    double z2 = z * z;
+    double center = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    double half_width = z / (1.0 + z2 / n) * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n));
+    *out_low = (center - half_width > 0.0) ? center - half_width : 0.0;
+    *out_high = (center + half_width < 1.0) ? center + half_width : 1.0;
+}
+
+bool sim_should_stop(sim_result_t * result, sim_options_t * options) {
+    assert(NULL != result);
+    assert(NULL != options);
+    if (result->num_trials < options->stop_min_trials) {
+        return false;
+    }
+    if (0.0 >= options->stop_width && 0.0 >= options->stop_threshold) {
+        return false;
+    }
+    double low, high;
+    sim_wilson_interval(result->num_failures, result->num_trials, SIM_WILSON_Z, &low, &high);
+    if (0.0 < options->stop_width && high - low < options->stop_width) {
+        return true;
+    }
+    if (0.0 < options->stop_threshold && (high < options->stop_threshold || low > options->stop_threshold)) {
+        return true;
+    }
+    return false;
+}
+
+static bool sim_params_equal_except_seed(sim_params_t * a, sim_params_t * b) {
+    return a->num_keys == b->num_keys
+           && a->num_messages == b->num_messages
+           && a->block_size == b->block_size
+           && a->block_weight == b->block_weight
+           && a->num_errors == b->num_errors
+           && a->num_iterations == b->num_iterations
+           && a->decoder == b->decoder
+           && a->opt == b->opt
+           && a->rerun_failures == b->rerun_failures;
+}
+
+bool sim_run(sim_params_t * params, sim_options_t * options, sim_result_t * result) {
+    assert(NULL != params);
+    assert(NULL != options);
+    assert(NULL != result);
+    assert(!options->resume || NULL != options->checkpoint_filename);
+
+    sim_decode_function_t decode_function;
+    long (*threshold_function)(long);
+    if (!sim_select_decoder(params->decoder, params->opt, &decode_function, &threshold_function)) {
+        fprintf(stderr, "%s: Unsupported decoder %zu with opt %zu!\n", __func__, params->decoder, params->opt);
+        exit(-1);
+    }
+
+    uint64_t trial = result->trial_begin;
+    bool continue_stream = false; // the next attempt repeats a failed trial using the current stream
+    random_state_t stream_state;
+    if (options->resume) {
+        sim_result_t checkpoint;
+        sim_checkpoint_load(options->checkpoint_filename, &checkpoint, &trial, &continue_stream, &stream_state);
+        if (!sim_params_equal_except_seed(params, &checkpoint.params)
+            || params->shard_index != checkpoint.params.shard_index
+            || params->shard_count != checkpoint.params.shard_count) {
+            fprintf(stderr, "%s: Checkpoint %s belongs to a different simulation!\n", __func__, options->checkpoint_filename);
+            exit(-1);
+        }
+        params->seed = checkpoint.params.seed;
+        sim_result_deinit(result);
+        *result = checkpoint;
+        fprintf(stderr, "resuming from trial %zu, seed %llu\n", (size_t)trial, (unsigned long long)params->seed);
+    }
+
+    gf4_arena_t arena;
+    gf4_arena_init(&arena, 0);
+    gf4_array_t plaintext = gf4_array_init_in(&arena, params->block_size, true);
+    gf4_array_t ciphertext = gf4_array_init_in(&arena, 2 * params->block_size, true);
+    gf4_array_t error = gf4_array_init_in(&arena, 2 * params->block_size, true);
+    gf4_array_t decrypted = gf4_array_init_in(&arena, 2 * params->block_size, true);
+
+    uint64_t num_shard_trials = result->trial_end - result->trial_begin;
+    double last_checkpoint = report_now();
+    report_progress_t progress;
+    keypool_t pool;
+    bool use_pool = 0 < options->keygen_threads && trial < result->trial_end && !result->stopped_early;
+    if (use_pool) {
+        keypool_init(&pool, params->seed, trial / params->num_messages, (result->trial_end - 1) / params->num_messages + 1,
+                     params->block_size, params->block_weight, options->key_cache_dirname,
+                     options->keygen_threads, options->keygen_queue_size);
+    }
+    // without a pool, key pairs batch_next, ..., batch_end - 1 are expanded together and taken from batch_*_ctx
+    uint64_t key_end = (result->trial_end + params->num_messages - 1) / params->num_messages;
+    uint64_t batch_begin = 0, batch_next = 0, batch_end = 0;
+    encoding_context_t batch_enc_ctx[CONTEXTS_BATCH_SIZE];
+    decoding_context_t batch_dec_ctx[CONTEXTS_BATCH_SIZE];
+    report_progress_init(&progress, num_shard_trials, trial - result->trial_begin, result->num_failures, options->progress_interval);
+    while (trial < result->trial_end && !result->stopped_early) {
+        size_t key = trial / params->num_messages;
+        encoding_context_t ec;
+        decoding_context_t dc;
+        if (use_pool) {
+            keypool_take(&pool, key, &ec, &dc);
+        } else {
+            if (key >= batch_end) {
+                contexts_seed_t key_seeds[CONTEXTS_BATCH_SIZE];
+                batch_begin = key;
+                batch_next = key;
+                batch_end = UTILS_MIN(key + CONTEXTS_BATCH_SIZE, key_end);
+                for (uint64_t k = batch_begin; k < batch_end; ++k) {
+                    contexts_seed_from_u64(&key_seeds[k - batch_begin], random_derive_seed(params->seed, k, SIM_KEY_STREAM));
+                }
+                contexts_init_from_seeds(batch_enc_ctx, batch_dec_ctx, key_seeds, batch_end - batch_begin,
+                                         params->block_size, params->block_weight, options->key_cache_dirname);
+            }
+            assert(key == batch_next);
+            ec = batch_enc_ctx[key - batch_begin];
+            dc = batch_dec_ctx[key - batch_begin];
+            ++batch_next;
+        }
+
+        if (3 == params->decoder) {
+            dc.threshold = threshold_function;
+        } else {
+            dc.delta_setting = (long)params->opt;
+        }
+        // the temporaries of enc_encrypt and the decoders come from the run's arena
+        ec.arena = &arena;
+        dc.arena = &arena;
+
+        size_t msg = trial % params->num_messages;
+        while (msg < params->num_messages && trial < result->trial_end && !result->stopped_early) {
+            if (continue_stream) {
+                random_set_state(&stream_state);
+            } else {
+                random_seed(random_derive_seed(params->seed, key, msg));
+            }
+            gf4_arena_mark_t trial_mark = gf4_arena_mark(&arena);
+            // same as enc_encrypt, but the error vector is kept for the corpus
+            random_gf4_array(&plaintext, params->block_size);
+            enc_encode(&ciphertext, &plaintext, &ec);
+            random_weighted_gf4_array(&error, 2 * params->block_size, params->num_errors);
+            enc_add_error(&ciphertext, &ciphertext, &error, &ec);
+            double decryption_start = report_now();
+            bool decryption_success = dec_decrypt(&decrypted, &ciphertext, decode_function, params->num_iterations, &dc);
+            double decryption_time = report_now() - decryption_start;
+            result->num_trials += 1;
+            if (decryption_success) {
+                result->iterations[dc.elapsed_iterations] += 1;
+            } else {
+                result->num_failures += 1;
+                if (NULL != options->corpus) {
+                    corpus_entry_t entry = {params->seed, key, msg, params->block_size, params->num_errors,
+                                            params->decoder, params->opt, params->num_iterations, error};
+                    corpus_add(options->corpus, &entry, &ec, &dc);
+                }
+            }
+            if (NULL != options->sink) {
+                report_record_t record = {key, msg, params->num_errors, params->decoder, params->opt, dc.elapsed_iterations,
+                                          decryption_success, (uint64_t)(1e9 * decryption_time)};
+                report_sink_write(options->sink, &record);
+            }
+            continue_stream = !decryption_success && params->rerun_failures;
+            report_progress_update(&progress, continue_stream ? 0 : 1, decryption_success ? 0 : 1);
+            if (!continue_stream) {
+                ++msg;
+                ++trial;
+                result->num_run_trials += 1;
+                if (trial < result->trial_end && sim_should_stop(result, options)) {
+                    fprintf(stderr, "stopping rule satisfied after %zu / %zu trials\n", (size_t)(trial - result->trial_begin), (size_t)num_shard_trials);
+                    result->stopped_early = true;
+                }
+            }
+            gf4_arena_release(&arena, trial_mark);
+            random_get_state(&stream_state);
+            gf4_array_zero_out(&plaintext);
+            gf4_array_zero_out(&ciphertext);
+            gf4_array_zero_out(&error);
+            gf4_array_zero_out(&decrypted);
+
+            if (NULL != options->checkpoint_filename && report_now() - last_checkpoint >= options->checkpoint_interval) {
+                if (NULL != options->sink) {
+                    report_sink_flush(options->sink);
+                }
+                sim_checkpoint_save(options->checkpoint_filename, result, trial, continue_stream, &stream_state);
+                last_checkpoint = report_now();
+            }
+        }
+        contexts_deinit(&ec, &dc);
+    }
+    // key pairs of the last batch that were not needed because a stopping rule ended the run
+    for (uint64_t k = batch_next; k < batch_end; ++k) {
+        contexts_deinit(&batch_enc_ctx[k - batch_begin], &batch_dec_ctx[k - batch_begin]);
+    }
+    gf4_arena_deinit(&arena);
+    report_progress_finish(&progress);
+    if (use_pool) {
+        keypool_print_metrics(stderr, &pool);
+        keypool_deinit(&pool);
+    }
+
+    if (NULL != options->sink) {
+        report_sink_flush(options->sink);
+    }
+    if (NULL != options->checkpoint_filename) {
+        random_get_state(&stream_state);
+        sim_checkpoint_save(options->checkpoint_filename, result, trial, false, &stream_state);
+    }
+    return result->stopped_early;
+}
+
+bool sim_result_merge(sim_result_t * result, sim_result_t * other) {
+    assert(NULL != result);
+    assert(NULL != other);
+    sim_params_t * a = &result->params;
+    sim_params_t * b = &other->params;
+    if (!sim_params_equal_except_seed(a, b) || a->seed != b->seed) {
+        return false;
+    }
+    if (result->trial_end != other->trial_begin) {
+        return false;
+    }
+    result->trial_end = other->trial_end;
+    result->num_trials += other->num_trials;
+    result->num_failures += other->num_failures;
+    result->num_run_trials += other->num_run_trials;
+    result->stopped_early = result->stopped_early || other->stopped_early;
+    for (size_t i = 0; i <= a->num_iterations; ++i) {
+        result->iterations[i] += other->iterations[i];
+    }
+    return true;
+}
+
+static void sim_write_u64(FILE * file, uint64_t value) {
+    if (1 != fwrite(&value, sizeof(uint64_t), 1, file)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+}
+
+static uint64_t sim_read_u64(FILE * file) {
+    uint64_t value;
+    if (1 != fread(&value, sizeof(uint64_t), 1, file)) {
+        fprintf(stderr, "%s: Read error! The file is truncated!\n", __func__);
+        exit(-1);
+    }
+    return value;
+}
+
+static void sim_write_magic(FILE * file, const char * magic, uint64_t version) {
+    assert(strlen(magic) < 8);
+    char buffer[8] = {0};
+    memcpy(buffer, magic, strlen(magic));
+    if (1 != fwrite(buffer, sizeof(buffer), 1, file)) {
+        fprintf(stderr, "%s: Write error!\n", __func__);
+        exit(-1);
+    }
+    sim_write_u64(file, version);
+}
+
+static void sim_read_magic(FILE * file, const char * filename, const char * magic, uint64_t version) {
+    char buffer[8] = {0};
+    if (1 != fread(buffer, sizeof(buffer), 1, file) || 0 != strncmp(buffer, magic, sizeof(buffer))) {
+        fprintf(stderr, "%s: %s is not a %s file!\n", __func__, filename, magic);
+        exit(-1);
+    }
+    if (version != sim_read_u64(file)) {
+        fprintf(stderr, "%s: %s has unsupported version!\n", __func__, filename);
+        exit(-1);
+    }
+}
+
+static void sim_result_write(FILE * output, sim_result_t * result) {
+    // header
+    sim_params_t * params = &result->params;
+    sim_write_u64(output, params->num_keys);
+    sim_write_u64(output, params->num_messages);
+    sim_write_u64(output, params->block_size);
+    sim_write_u64(output, params->block_weight);
+    sim_write_u64(output, params->num_errors);
+    sim_write_u64(output, params->num_iterations);
+    sim_write_u64(output, params->decoder);
+    sim_write_u64(output, params->opt);
+    sim_write_u64(output, params->seed);
+    sim_write_u64(output, params->shard_index);
+    sim_write_u64(output, params->shard_count);
+    sim_write_u64(output, params->rerun_failures);
+
+    // counters
+    sim_write_u64(output, result->trial_begin);
+    sim_write_u64(output, result->trial_end);
+    sim_write_u64(output, result->num_trials);
+    sim_write_u64(output, result->num_failures);
+    sim_write_u64(output, result->num_run_trials);
+    sim_write_u64(output, result->stopped_early);
+    for (size_t i = 0; i <= params->num_iterations; ++i) {
+        sim_write_u64(output, result->iterations[i]);
+    }
+}
+
+static void sim_result_read(FILE * input, const char * filename, sim_result_t * result) {
+    // header
+    sim_params_t params;
+    params.num_keys = sim_read_u64(input);
+    params.num_messages = sim_read_u64(input);
+    params.block_size = sim_read_u64(input);
+    params.block_weight = sim_read_u64(input);
+    params.num_errors = sim_read_u64(input);
+    params.num_iterations = sim_read_u64(input);
+    params.decoder = sim_read_u64(input);
+    params.opt = sim_read_u64(input);
+    params.seed = sim_read_u64(input);
+    params.shard_index = sim_read_u64(input);
+    params.shard_count = sim_read_u64(input);
+    params.rerun_failures = (0 != sim_read_u64(input));
+    if (params.shard_index >= params.shard_count) {
+        fprintf(stderr, "%s: %s has invalid shard %zu/%zu!\n", __func__, filename, params.shard_index, params.shard_count);
+        exit(-1);
+    }
+
+    // counters
+    sim_result_init(result, &params);
+    result->trial_begin = sim_read_u64(input);
+    result->trial_end = sim_read_u64(input);
+    result->num_trials = sim_read_u64(input);
+    result->num_failures = sim_read_u64(input);
+    result->num_run_trials = sim_read_u64(input);
+    result->stopped_early = (0 != sim_read_u64(input));
+    if (result->trial_end < result->trial_begin || result->num_run_trials > result->trial_end - result->trial_begin) {
+        fprintf(stderr, "%s: %s has invalid range of trials!\n", __func__, filename);
+        exit(-1);
+    }
+    for (size_t i = 0; i <= params.num_iterations; ++i) {
+        result->iterations[i] = sim_read_u64(input);
+    }
+}
+
+void sim_result_save(const char * filename, sim_result_t * result) {
+    assert(NULL != filename);
+    assert(NULL != result);
+
+    FILE * output = fopen(filename, "wb");
+    if (NULL == output) {
+        fprintf(stderr, "%s: Output file couldn't be created!\n", __func__);
+        exit(-1);
+    }
+    sim_write_magic(output, SIM_RESULT_MAGIC, SIM_RESULT_VERSION);
+    sim_result_write(output, result);
+    fclose(output);
+}
+
+void sim_result_load(const char * filename, sim_result_t * result) {
+    assert(NULL != filename);
+    assert(NULL != result);
+
+    FILE * input = fopen(filename, "rb");
+    if (NULL == input) {
+        fprintf(stderr, "%s: Input file %s doesn't exist!\n", __func__, filename);
+        exit(-1);
+    }
+    sim_read_magic(input, filename, SIM_RESULT_MAGIC, SIM_RESULT_VERSION);
+    sim_result_read(input, filename, result);
+    fclose(input);
+}
+
+void sim_checkpoint_save(const char * filename, sim_result_t * result, uint64_t next_trial, bool continue_stream, random_state_t * stream_state) {
+    assert(NULL != filename);
+    assert(NULL != result);
+    assert(NULL != stream_state);
+
+    size_t tmp_length = strlen(filename) + 5;
+    char * tmp_filename = malloc(tmp_length);
+    if (NULL == tmp_filename) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    snprintf(tmp_filename, tmp_length, "%s.tmp", filename);
+
+    FILE * output = fopen(tmp_filename, "wb");
+    if (NULL == output) {
+        fprintf(stderr, "%s: Checkpoint file %s couldn't be created!\n", __func__, tmp_filename);
+        exit(-1);
+    }
+    sim_write_magic(output, SIM_CHECKPOINT_MAGIC, SIM_CHECKPOINT_VERSION);
+    sim_result_write(output, result);
+    sim_write_u64(output, next_trial);
+    sim_write_u64(output, continue_stream);
+    for (size_t i = 0; i < 4; ++i) {
+        sim_write_u64(output, stream_state->s[i]);
+    }
+    if (0 != fflush(output) || 0 != fsync(fileno(output))) {
+        fprintf(stderr, "%s: Checkpoint file %s couldn't be written!\n", __func__, tmp_filename);
+        exit(-1);
+    }
+    fclose(output);
+    if (0 != rename(tmp_filename, filename)) {
+        fprintf(stderr, "%s: Checkpoint file %s couldn't be replaced!\n", __func__, filename);
+        exit(-1);
+    }
+    free(tmp_filename);
+}
+
+void sim_checkpoint_load(const char * filename, sim_result_t * result, uint64_t * out_next_trial, bool * out_continue_stream, random_state_t * out_stream_state) {
+    assert(NULL != filename);
+    assert(NULL != result);
+    assert(NULL != out_next_trial);
+    assert(NULL != out_continue_stream);
+    assert(NULL != out_stream_state);
+
+    FILE * input = fopen(filename, "rb");
+    if (NULL == input) {
+        fprintf(stderr, "%s: Checkpoint file %s doesn't exist!\n", __func__, filename);
+        exit(-1);
+    }
+    sim_read_magic(input, filename, SIM_CHECKPOINT_MAGIC, SIM_CHECKPOINT_VERSION);
+    sim_result_read(input, filename, result);
+    *out_next_trial = sim_read_u64(input);
+    *out_continue_stream = (0 != sim_read_u64(input));
+    for (size_t i = 0; i < 4; ++i) {
+        out_stream_state->s[i] = sim_read_u64(input);
+    }
+    fclose(input);
+    if (*out_next_trial < result->trial_begin || *out_next_trial > result->trial_end) {
+        fprintf(stderr, "%s: Checkpoint file %s is corrupted!\n", __func__, filename);
+        exit(-1);
+    }
+}
+
+void sim_replay(const char * dirname, size_t decoder, size_t opt, size_t num_iterations, report_sink_t * sink, sim_replay_result_t * out_result) {
+    assert(NULL != dirname);
+    assert(NULL != out_result);
+    sim_decode_function_t decode_function;
+    long (*threshold_function)(long);
+    if (!sim_select_decoder(decoder, opt, &decode_function, &threshold_function)) {
+        fprintf(stderr, "%s: Unsupported decoder %zu with opt %zu!\n", __func__, decoder, opt);
+        exit(-1);
+    }
+    out_result->num_entries = 0;
+    out_result->num_successes = 0;
+    out_result->iterations_sum = 0;
+
+    corpus_reader_t reader;
+    corpus_reader_open(&reader, dirname);
+    encoding_context_t ec;
+    decoding_context_t dc;
+    bool key_loaded = false;
+    uint64_t loaded_seed = 0, loaded_key = 0;
+    corpus_entry_t entry;
+    gf4_arena_t arena;
+    gf4_arena_init(&arena, 0);
+    while (corpus_reader_next(&reader, &entry)) {
+        // consecutive failures usually share the key pair
+        if (!key_loaded || loaded_seed != entry.seed || loaded_key != entry.key) {
+            if (key_loaded) {
+                contexts_deinit(&ec, &dc);
+            }
+            char path[CORPUS_PATH_LENGTH];
+            corpus_key_path(path, dirname, entry.seed, entry.key);
+            contexts_load(path, &ec, &dc);
+            if (dc.block_size != entry.block_size) {
+                fprintf(stderr, "%s: Key file %s doesn't match the failure!\n", __func__, path);
+                exit(-1);
+            }
+            dc.elapsed_iterations = 0;
+            dc.threshold = threshold_function;
+            dc.delta_setting = (long)opt;
+            dc.arena = &arena;
+            key_loaded = true;
+            loaded_seed = entry.seed;
+            loaded_key = entry.key;
+        }
+        size_t iterations = (0 == num_iterations) ? entry.num_iterations : num_iterations;
+        gf4_arena_mark_t mark = gf4_arena_mark(&arena);
+        gf4_array_t decrypted = gf4_array_init_in(&arena, 2 * entry.block_size, true);
+        double decryption_start = report_now();
+        bool decryption_success = dec_decrypt(&decrypted, &entry.error, decode_function, iterations, &dc);
+        double decryption_time = report_now() - decryption_start;
+        out_result->num_entries += 1;
+        if (decryption_success) {
+            out_result->num_successes += 1;
+            out_result->iterations_sum += dc.elapsed_iterations;
+        }
+        if (NULL != sink) {
+            report_record_t record = {entry.key, entry.message, entry.num_errors, decoder, opt, dc.elapsed_iterations,
+                                      decryption_success, (uint64_t)(1e9 * decryption_time)};
+            report_sink_write(sink, &record);
+        }
+        gf4_arena_release(&arena, mark);
+        corpus_entry_deinit(&entry);
+    }
+    gf4_arena_deinit(&arena);
+    if (key_loaded) {
+        contexts_deinit(&ec, &dc);
+    }
+    corpus_reader_close(&reader);
+}
+
+void sim_result_print(FILE * stream, sim_result_t * result) {
+    assert(NULL != stream);
+    assert(NULL != result);
+    fprintf(stream, "num failures: %zu / %zu\n", (size_t)result->num_failures, (size_t)result->num_trials);
+    if (result->stopped_early) {
+        fprintf(stream, "stopped early by a stopping rule, %zu of %zu trials were run\n",
+                (size_t)result->num_run_trials, (size_t)(result->trial_end - result->trial_begin));
+    }
+    if (result->params.rerun_failures) {
+        fprintf(stream, "failed trials were repeated, completed trials: %zu\n", (size_t)(result->num_trials - result->num_failures));
+    }
+    if (0 == result->num_trials) {
+        return;
+    }
+    fprintf(stream, "DFR: %e\n", (double)result->num_failures / (double)result->num_trials);
+    double low, high;
+    sim_wilson_interval(result->num_failures, result->num_trials, SIM_WILSON_Z, &low, &high);
+    fprintf(stream, "DFR 95%% confidence interval (Wilson): [%e, %e]\n", low, high);
+
+    uint64_t num_successes = result->num_trials - result->num_failures;
+    if (0 == num_successes) {
+        return;
+    }
+    double sum = 0.0, sum_squares = 0.0;
+    size_t min = result->params.num_iterations, max = 0;
+    for (size_t i = 0; i <= result->params.num_iterations; ++i) {
+        if (0 == result->iterations[i]) {
+            continue;
+        }
+        sum += (double)i * (double)result->iterations[i];
+        sum_squares += (double)i * (double)i * (double)result->iterations[i];
+        min = (i < min) ? i : min;
+        max = (i > max) ? i : max;
+    }
+    double mean = sum / (double)num_successes;
+    double variance = sum_squares / (double)num_successes - mean * mean;
+    fprintf(stream, "iterations of successful decodings: mean %.3f, std %.3f, min %zu, max %zu\n",
+            mean, sqrt(variance > 0.0 ? variance : 0.0), min, max);
+}
@@ -0,0 +1,313 @@
+/**
+ *  @file   sim.h
+ *  @brief  DFR simulations and their results.
+ *  @author Tomáš Vavro
+ *  @date   2026-10-19
+ ***********************************************/
+
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDPC_GF4_SIM_H
+#define MDPC_GF4_SIM_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "gf4_array.h"
+#include "contexts.h"
+#include "enc.h"
+#include "dec.h"
+#include "random.h"
+#include "report.h"
+#include "corpus.h"
+
+#define SIM_KEY_STREAM UINT64_MAX ///< message index used to derive the seed of a key, see random_derive_seed
+#define SIM_WILSON_Z 1.959963984540054 ///< quantile of the standard normal distribution for 95% confidence intervals
+
+/**
+ * @brief Pointer to a decoder function, e.g. dec_decode_symbol_flipping.
+ */
+typedef bool (*sim_decode_function_t)(gf4_array_t *, gf4_array_t *, size_t, decoding_context_t *);
+
+/**
+ * @brief Parameters of a DFR simulation.
+ *
+ * The simulation consists of num_keys * num_messages trials. Trial t uses key t / num_messages
+ * and message t % num_messages. Every key and every message is generated from its own random stream
+ * derived from seed, so the result of a trial does not depend on the shard that runs it.
+ */
+typedef struct {
+    size_t num_keys; ///< number of key pairs
+    size_t num_messages; ///< number of messages per key pair
+    size_t block_size; ///< size of the circulant block
+    size_t block_weight; ///< hamming weight of the circulant block
+    size_t num_errors; ///< hamming weight of the error vector
+    size_t num_iterations; ///< maximum number of decoding iterations
+    size_t decoder; ///< index of the decoder, see sim_select_decoder
+    size_t opt; ///< decoder option (delta or index of the threshold function)
+    uint64_t seed; ///< base seed of the whole simulation
+    size_t shard_index; ///< index of this shard, 0 <= shard_index < shard_count
+    size_t shard_count; ///< number of shards the simulation is split into
+    bool rerun_failures; ///< if true, a failed trial is repeated with a new message until it succeeds
+} sim_params_t;
+
+/**
+ * @brief Settings of a simulation run that do not influence its result.
+ */
+typedef struct {
+    const char * checkpoint_filename; ///< file to write checkpoints to, NULL disables checkpoints
+    double checkpoint_interval; ///< minimum number of seconds between two checkpoints
+    bool resume; ///< continue from the checkpoint stored in checkpoint_filename
+    uint64_t stop_min_trials; ///< stopping rules are not evaluated before this many decoding attempts
+    double stop_width; ///< stop when the width of the DFR confidence interval is below this value, 0 disables the rule
+    double stop_threshold; ///< stop when the DFR confidence interval excludes this value, 0 disables the rule
+    report_sink_t * sink; ///< opened sink to write a record of every decoding attempt to, NULL disables the records
+    double progress_interval; ///< minimum number of seconds between two progress lines
+    corpus_t * corpus; ///< opened corpus to save every decoding failure to, NULL disables the capture
+    const char * key_cache_dirname; ///< directory to cache expanded key pairs in, NULL disables the cache, see contexts_init_from_seed
+    size_t keygen_threads; ///< number of background threads generating key pairs ahead, 0 generates them in the simulation loop
+    size_t keygen_queue_size; ///< maximum number of key pairs generated ahead by the background threads
+} sim_options_t;
+
+/**
+ * @brief Result of a (possibly partial) DFR simulation.
+ *
+ * A result covers the trials trial_begin, ..., trial_end - 1.
+ * Results of adjacent ranges can be merged using sim_result_merge.
+ * If a stopping rule ended a shard early, only num_run_trials trials of its range were run
+ * and stopped_early is set (also in every result merged from it).
+ */
+typedef struct {
+    sim_params_t params; ///< parameters of the simulation
+    uint64_t trial_begin; ///< first covered trial (inclusive)
+    uint64_t trial_end; ///< last covered trial (exclusive)
+    uint64_t num_trials; ///< number of decoding attempts (including repeated attempts if params.rerun_failures is set)
+    uint64_t num_failures; ///< number of decoding failures
+    uint64_t num_run_trials; ///< number of covered trials that were run, smaller than trial_end - trial_begin if stopped early
+    bool stopped_early; ///< true if a stopping rule ended the run (or one of the merged runs) before trial_end
+    uint64_t * iterations; ///< histogram of elapsed iterations of successful decodings, params.num_iterations + 1 bins
+} sim_result_t;
+
+/**
+ * @brief Summary of a replay of a failure corpus.
+ */
+typedef struct {
+    uint64_t num_entries; ///< number of replayed failures
+    uint64_t num_successes; ///< number of failures decoded successfully by the replaying decoder
+    uint64_t iterations_sum; ///< sum of elapsed iterations of the successful decodings
+} sim_replay_result_t;
+
+/**
+ * @brief Select decoder and threshold function.
+ *
+ * 0 --> SF, 2 --> SF with delta, 3 --> SF with threshold (opt is the index of the threshold function).
+ * Decoders 1 (SF v2) and 4 (SF BG) are not available in this build.
+ *
+ * @param decoder index of the decoder
+ * @param opt decoder option
+ * @param out_decode memory location to store the decoder function to
+ * @param out_threshold memory location to store the threshold function to, NULL is stored if not relevant
+ * @return true if the combination is supported, false otherwise
+ */
+bool sim_select_decoder(size_t decoder, size_t opt, sim_decode_function_t * out_decode, long (**out_threshold)(long));
+
+/**
+ * @brief Parse shard specification of the form "i/N".
+ *
+ * @param str string to parse
+ * @param out_index memory location to store i to
+ * @param out_count memory location to store N to
+ * @return true if str is a valid specification with 0 <= i < N, false otherwise
+ */
+bool sim_parse_shard(const char * str, size_t * out_index, size_t * out_count);
+
+/**
+ * @brief Find the range of trials owned by the shard given in params.
+ *
+ * Trials are split into params->shard_count contiguous, disjoint ranges of (almost) equal size.
+ *
+ * @param params simulation parameters
+ * @param out_begin memory location to store the first trial (inclusive) to
+ * @param out_end memory location to store the last trial (exclusive) to
+ */
+void sim_shard_range(sim_params_t * params, uint64_t * out_begin, uint64_t * out_end);
+
+/**
+ * @brief Initialize an empty result.
+ *
+ * Initialized result must be cleaned up using sim_result_deinit function if no longer needed!
+ *
+ * @param result memory location of the result
+ * @param params simulation parameters
+ */
+void sim_result_init(sim_result_t * result, sim_params_t * params);
+
+/**
+ * @brief Destroy a result.
+ *
+ * @param result an initialized result
+ */
+void sim_result_deinit(sim_result_t * result);
+
+/**
+ * @brief Compute the Wilson score interval of a failure rate.
+ *
+ * Unlike the normal approximation, the interval is meaningful also for 0 failures.
+ *
+ * @param num_failures number of observed failures
+ * @param num_trials number of trials
+ * @param z quantile of the standard normal distribution, e.g. SIM_WILSON_Z
+ * @param out_low memory location to store the lower bound to
+ * @param out_high memory location to store the upper bound to
+ */
+void sim_wilson_interval(uint64_t num_failures, uint64_t num_trials, double z, double * out_low, double * out_high);
+
+/**
+ * @brief Decide whether the simulation can stop before running all its trials.
+ *
+ * The run stops if the 95% Wilson interval of the DFR is narrower than options->stop_width
+ * or if it lies entirely above or below options->stop_threshold.
+ *
+ * @param result current result
+ * @param options run options with the stopping rules
+ * @return true if a stopping rule is satisfied, false otherwise
+ */
+bool sim_should_stop(sim_result_t * result, sim_options_t * options);
+
+/**
+ * @brief Set default options: no checkpoints, no early stopping, no records, no corpus, no key cache, key pairs generated in the simulation loop, progress every second.
+ *
+ * @param options memory location of the options
+ */
+void sim_options_init(sim_options_t * options);
+
+/**
+ * @brief Run the trials of the shard given in params.
+ *
+ * result must be initialized beforehand using the same params.
+ *
+ * If options->checkpoint_filename is set, the progress, the result and the state of the random generator
+ * are periodically written to it. The checkpoint is first written to a temporary file which then replaces
+ * the previous checkpoint, so a killed job always leaves a complete checkpoint behind.
+ * If options->resume is set, the run continues from the checkpoint. All parameters except for the seed
+ * must match the checkpoint, the seed is taken from it. The final result is identical to that
+ * of an uninterrupted run.
+ *
+ * If a stopping rule of options is satisfied (see sim_should_stop), the run stops early
+ * and result->stopped_early is set. The range of the result is kept, so it can still be merged
+ * with the results of the other shards.
+ *
+ * @param params simulation parameters, params->seed is updated when resuming
+ * @param options run options
+ * @param result an initialized result to accumulate to
+ * @return true if the run stopped early, false otherwise
+ */
+bool sim_run(sim_params_t * params, sim_options_t * options, sim_result_t * result);
+
+/**
+ * @brief Merge other into result.
+ *
+ * Both results must come from the same simulation (same parameters and seed)
+ * and other must cover the trials directly following the ones covered by result.
+ * Shards stopped early are merged as well, the counts are summed and the merged result is flagged as stopped early.
+ * Its confidence interval then comes from shards of different sizes, each stopped by its own rule.
+ *
+ * @param result an initialized result
+ * @param other an initialized result
+ * @return true on success, false if the results cannot be merged
+ */
+bool sim_result_merge(sim_result_t * result, sim_result_t * other);
+
+/**
+ * @brief Save a result to a binary file.
+ *
+ * The file contains a header with the parameters followed by the counters and the histogram,
+ * all stored as 64-bit integers in the native byte order.
+ *
+ * @param filename savefile path
+ * @param result an initialized result
+ */
+void sim_result_save(const char * filename, sim_result_t * result);
+
+/**
+ * @brief Load a result from a binary file created by sim_result_save.
+ *
+ * Allocates all the necessary memory for result. Do not initialize it yourself!
+ *
+ * @see sim_result_deinit
+ *
+ * @param filename savefile path
+ * @param result memory location of the result
+ */
+void sim_result_load(const char * filename, sim_result_t * result);
+
+/**
+ * @brief Save a checkpoint of a running simulation.
+ *
+ * The checkpoint is written to filename.tmp first and then atomically renamed to filename.
+ *
+ * @param filename checkpoint path
+ * @param result an initialized result
+ * @param next_trial first trial that is not finished yet
+ * @param continue_stream true if the next decoding attempt continues the stream of the random generator
+ * instead of reseeding it (a repeated attempt after a failure)
+ * @param stream_state state of the random generator after the last decoding attempt
+ */
+void sim_checkpoint_save(const char * filename, sim_result_t * result, uint64_t next_trial, bool continue_stream, random_state_t * stream_state);
+
+/**
+ * @brief Load a checkpoint created by sim_checkpoint_save.
+ *
+ * Allocates all the necessary memory for result. Do not initialize it yourself!
+ *
+ * @see sim_result_deinit
+ *
+ * @param filename checkpoint path
+ * @param result memory location of the result
+ * @param out_next_trial memory location to store the first unfinished trial to
+ * @param out_continue_stream memory location to store the continue_stream flag to
+ * @param out_stream_state memory location to store the state of the random generator to
+ */
+void sim_checkpoint_load(const char * filename, sim_result_t * result, uint64_t * out_next_trial, bool * out_continue_stream, random_state_t * out_stream_state);
+
+/**
+ * @brief Decode every failure of a corpus again.
+ *
+ * Only the error vector of every failure is decoded, the syndrome of a ciphertext does not depend on the message.
+ * Key pairs are loaded from the corpus directory.
+ *
+ * @param dirname path of the corpus directory
+ * @param decoder index of the decoder to use, see sim_select_decoder
+ * @param opt decoder option
+ * @param num_iterations maximum number of decoding iterations, 0 means the value stored with every failure
+ * @param sink opened sink to write a record of every decoding to, may be NULL
+ * @param out_result memory location to store the summary to
+ */
+void sim_replay(const char * dirname, size_t decoder, size_t opt, size_t num_iterations, report_sink_t * sink, sim_replay_result_t * out_result);
+
+/**
+ * @brief Print DFR and iteration statistics.
+ *
+ * @param stream stream to be used (e.g. stdout, stderr...)
+ * @param result an initialized result
+ */
+void sim_result_print(FILE * stream, sim_result_t * result);
+
+#endif //MDPC_GF4_SIM_H
@@ -0,0 +1,256 @@
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sweep.h"
+#include "utils.h"
+
+static size_t sweep_count_items(const char * str) {
+    size_t count = 1;
+    for (const char * c = str; '\0' != *c; ++c) {
+        if (',' == *c) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static bool sweep_parse_size(const char ** str, size_t * out_value) {
+    char * end;
+    unsigned long long value = strtoull(*str, &end, 10);
+    if (end == *str || '-' == **str) {
+        return false;
+    }
+    *str = end;
+    *out_value = (size_t)value;
+    return true;
+}
+
+bool sweep_parse_error_counts(const char * str, size_t ** out_values, size_t * out_count) {
+    assert(NULL != str);
+    assert(NULL != out_values);
+    assert(NULL != out_count);
+    size_t count = sweep_count_items(str);
+    size_t * values = malloc(count * sizeof(size_t));
+    if (NULL == values) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!sweep_parse_size(&str, &values[i]) || 0 == values[i] || (',' != *str && '\0' != *str)) {
+            free(values);
+            return false;
+        }
+        ++str;
+    }
+    *out_values = values;
+    *out_count = count;
+    return true;
+}
+
+bool sweep_parse_configs(const char * str, sweep_config_t ** out_configs, size_t * out_count) {
+    assert(NULL != str);
+    assert(NULL != out_configs);
+    assert(NULL != out_count);
+    size_t count = sweep_count_items(str);
+    sweep_config_t * configs = malloc(count * sizeof(sweep_config_t));
+    if (NULL == configs) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        bool valid = sweep_parse_size(&str, &configs[i].decoder) && ':' == *str;
+        if (valid) {
+            ++str;
+            valid = sweep_parse_size(&str, &configs[i].opt) && (',' == *str || '\0' == *str);
+        }
+        sim_decode_function_t decode;
+        long (*threshold)(long);
+        if (!valid || !sim_select_decoder(configs[i].decoder, configs[i].opt, &decode, &threshold)) {
+            free(configs);
+            return false;
+        }
+        ++str;
+    }
+    *out_configs = configs;
+    *out_count = count;
+    return true;
+}
+
+void sweep_result_init(sweep_result_t * result, sweep_params_t * params) {
+    assert(NULL != result);
+    assert(NULL != params);
+    assert(0 < params->num_error_counts && 0 < params->num_configs);
+    result->params = *params;
+    result->cells = calloc(params->num_error_counts * params->num_configs, sizeof(sweep_cell_t));
+    if (NULL == result->cells) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+}
+
+void sweep_result_deinit(sweep_result_t * result) {
+    assert(NULL != result);
+    free(result->cells);
+    result->cells = NULL;
+}
+
+sweep_cell_t * sweep_result_cell(sweep_result_t * result, size_t error_index, size_t config_index) {
+    assert(NULL != result);
+    assert(error_index < result->params.num_error_counts);
+    assert(config_index < result->params.num_configs);
+    return &result->cells[error_index * result->params.num_configs + config_index];
+}
+
+void sweep_run(sweep_params_t * params, report_sink_t * sink, double progress_interval, sweep_result_t * result) {
+    assert(NULL != params);
+    assert(NULL != result);
+
+    // resolve decoders up front
+    size_t num_configs = params->num_configs;
+    sim_decode_function_t * decoders = malloc(num_configs * sizeof(sim_decode_function_t));
+    long (**thresholds)(long) = malloc(num_configs * sizeof(*thresholds));
+    bool * success = malloc(num_configs * sizeof(bool));
+    if (NULL == decoders || NULL == thresholds || NULL == success) {
+        fprintf(stderr, "%s: Allocation error!\n", __func__);
+        exit(-1);
+    }
+    for (size_t c = 0; c < num_configs; ++c) {
+        if (!sim_select_decoder(params->configs[c].decoder, params->configs[c].opt, &decoders[c], &thresholds[c])) {
+            fprintf(stderr, "%s: Unsupported decoder %zu with opt %zu!\n", __func__, params->configs[c].decoder, params->configs[c].opt);
+            exit(-1);
+        }
+    }
+    size_t max_errors = 0;
+    for (size_t e = 0; e < params->num_error_counts; ++e) {
+        max_errors = (params->error_counts[e] > max_errors) ? params->error_counts[e] : max_errors;
+    }
+    assert(max_errors <= 2 * params->block_size);
+
+    // buffers of the sweep and the temporaries of the decoders share one arena
+    gf4_arena_t arena;
+    gf4_arena_init(&arena, 0);
+    size_t * positions = gf4_arena_alloc(&arena, UTILS_MAX(max_errors, 1) * sizeof(size_t), false);
+    gf4_t * values = gf4_arena_alloc(&arena, UTILS_MAX(max_errors, 1) * sizeof(gf4_t), false);
+    gf4_array_t plaintext = gf4_array_init_in(&arena, params->block_size, true);
+    gf4_array_t encoded = gf4_array_init_in(&arena, 2 * params->block_size, true);
+    gf4_array_t error = gf4_array_init_in(&arena, 2 * params->block_size, true);
+    gf4_array_t ciphertext = gf4_array_init_in(&arena, 2 * params->block_size, true);
+    gf4_array_t decrypted = gf4_array_init_in(&arena, 2 * params->block_size, true);
+
+    report_progress_t progress;
+    report_progress_init(&progress, (uint64_t)params->num_keys * params->num_messages * params->num_error_counts * num_configs,
+                         0, 0, progress_interval);
+    encoding_context_t batch_enc_ctx[CONTEXTS_BATCH_SIZE];
+    decoding_context_t batch_dec_ctx[CONTEXTS_BATCH_SIZE];
+    for (size_t key = 0; key < params->num_keys; ++key) {
+        // key pairs are expanded in batches sharing one inversion
+        if (0 == key % CONTEXTS_BATCH_SIZE) {
+            contexts_seed_t key_seeds[CONTEXTS_BATCH_SIZE];
+            size_t batch_count = UTILS_MIN((size_t)CONTEXTS_BATCH_SIZE, params->num_keys - key);
+            for (size_t i = 0; i < batch_count; ++i) {
+                contexts_seed_from_u64(&key_seeds[i], random_derive_seed(params->seed, key + i, SIM_KEY_STREAM));
+            }
+            contexts_init_from_seeds(batch_enc_ctx, batch_dec_ctx, key_seeds, batch_count, params->block_size, params->block_weight, NULL);
+        }
+        encoding_context_t ec = batch_enc_ctx[key % CONTEXTS_BATCH_SIZE];
+        decoding_context_t dc = batch_dec_ctx[key % CONTEXTS_BATCH_SIZE];
+        dc.arena = &arena;
+
+        for (size_t msg = 0; msg < params->num_messages; ++msg) {
+            random_seed(random_derive_seed(params->seed, key, msg));
+            random_gf4_array(&plaintext, params->block_size);
+            enc_encode(&encoded, &plaintext, &ec);
+            random_error_positions(positions, values, 2 * params->block_size, max_errors);
+
+            for (size_t e = 0; e < params->num_error_counts; ++e) {
+                gf4_array_zero_out(&error);
+                for (size_t i = 0; i < params->error_counts[e]; ++i) {
+                    error.array[positions[i]] = values[i];
+                }
+                enc_add_error(&ciphertext, &encoded, &error, &ec);
+
+                for (size_t c = 0; c < num_configs; ++c) {
+                    dc.delta_setting = (long)params->configs[c].opt;
+                    dc.threshold = thresholds[c];
+                    double decryption_start = report_now();
+                    success[c] = dec_decrypt(&decrypted, &ciphertext, decoders[c], params->num_iterations, &dc);
+                    double decryption_time = report_now() - decryption_start;
+                    if (NULL != sink) {
+                        report_record_t record = {key, msg, params->error_counts[e], params->configs[c].decoder, params->configs[c].opt,
+                                                  dc.elapsed_iterations, success[c], (uint64_t)(1e9 * decryption_time)};
+                        report_sink_write(sink, &record);
+                    }
+                    report_progress_update(&progress, 1, success[c] ? 0 : 1);
+                    sweep_cell_t * cell = sweep_result_cell(result, e, c);
+                    cell->num_trials += 1;
+                    if (success[c]) {
+                        cell->iterations_sum += dc.elapsed_iterations;
+                    } else {
+                        cell->num_failures += 1;
+                    }
+                    if (success[c] != success[0]) {
+                        if (success[c]) {
+                            cell->only_baseline_failed += 1;
+                        } else {
+                            cell->only_this_failed += 1;
+                        }
+                    }
+                    gf4_array_zero_out(&decrypted);
+                }
+            }
+            gf4_array_zero_out(&plaintext);
+            gf4_array_zero_out(&encoded);
+        }
+        contexts_deinit(&ec, &dc);
+    }
+    report_progress_finish(&progress);
+    if (NULL != sink) {
+        report_sink_flush(sink);
+    }
+    gf4_arena_deinit(&arena);
+    free(decoders);
+    free(thresholds);
+    free(success);
+}
+
+void sweep_result_print(FILE * stream, sweep_result_t * result) {
+    assert(NULL != stream);
+    assert(NULL != result);
+    sweep_params_t * params = &result->params;
+    fprintf(stream, "baseline: decoder %zu, opt %zu\n", params->configs[0].decoder, params->configs[0].opt);
+    fprintf(stream, "%10s %7s %4s %10s %10s %12s %12s %12s %10s %10s %10s %10s\n",
+            "num_errors", "decoder", "opt", "trials", "failures", "DFR", "DFR_low", "DFR_high",
+            "mean_iter", "only_this", "only_base", "mcnemar");
+    for (size_t e = 0; e < params->num_error_counts; ++e) {
+        for (size_t c = 0; c < params->num_configs; ++c) {
+            sweep_cell_t * cell = sweep_result_cell(result, e, c);
+            double dfr = (0 == cell->num_trials) ? 0.0 : (double)cell->num_failures / (double)cell->num_trials;
+            double low, high;
+            sim_wilson_interval(cell->num_failures, cell->num_trials, SIM_WILSON_Z, &low, &high);
+            uint64_t num_successes = cell->num_trials - cell->num_failures;
+            double mean = (0 == num_successes) ? 0.0 : (double)cell->iterations_sum / (double)num_successes;
+            uint64_t discordant = cell->only_this_failed + cell->only_baseline_failed;
+            double difference = (double)cell->only_this_failed - (double)cell->only_baseline_failed;
+            double mcnemar = (0 == discordant) ? 0.0 : difference * difference / (double)discordant;
+            fprintf(stream, "%10zu %7zu %4zu %10zu %10zu %12e %12e %12e %10.3f %10zu %10zu %10.3f\n",
+                    params->error_counts[e], params->configs[c].decoder, params->configs[c].opt,
+                    (size_t)cell->num_trials, (size_t)cell->num_failures, dfr, low, high, mean,
+                    (size_t)cell->only_this_failed, (size_t)cell->only_baseline_failed, mcnemar);
+        }
+    }
+}
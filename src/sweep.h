@@ -0,0 +1,154 @@
+/**
+ *  @file   sweep.h
+ *  @brief  Decoding of the same keys and error vectors under a grid of decoder settings.
+ *  @author Tomáš Vavro
+ *  @date   2026-10-19
+ ***********************************************/
+
+/*
+ This file is part of QC-MDPC McEliece over GF(4) implementation.
+ Copyright (C) 2023 Tomáš Vavro
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDPC_GF4_SWEEP_H
+#define MDPC_GF4_SWEEP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "sim.h"
+
+/**
+ * @brief One decoder configuration of the grid.
+ */
+typedef struct {
+    size_t decoder; ///< index of the decoder, see sim_select_decoder
+    size_t opt; ///< decoder option (delta or index of the threshold function)
+} sweep_config_t;
+
+/**
+ * @brief Parameters of a sweep.
+ *
+ * Every key pair is generated once and every message is encoded once. Its error vectors for all
+ * error_counts are nested (a vector of weight w is a prefix of the one of the largest weight)
+ * and every ciphertext is decoded under all configs. Keys and messages use the same random streams
+ * as sim_run with the same seed.
+ */
+typedef struct {
+    size_t num_keys; ///< number of key pairs
+    size_t num_messages; ///< number of messages per key pair
+    size_t block_size; ///< size of the circulant block
+    size_t block_weight; ///< hamming weight of the circulant block
+    size_t num_iterations; ///< maximum number of decoding iterations
+    uint64_t seed; ///< base seed of the sweep
+    size_t num_error_counts; ///< number of items in error_counts
+    size_t * error_counts; ///< hamming weights of the error vectors, not owned by the params
+    size_t num_configs; ///< number of items in configs
+    sweep_config_t * configs; ///< decoder configurations, configs[0] is the baseline of paired comparisons, not owned by the params
+} sweep_params_t;
+
+/**
+ * @brief Counters of one (error count, config) point of the grid.
+ */
+typedef struct {
+    uint64_t num_trials; ///< number of decoded ciphertexts
+    uint64_t num_failures; ///< number of decoding failures
+    uint64_t iterations_sum; ///< sum of elapsed iterations of successful decodings
+    uint64_t only_this_failed; ///< ciphertexts that failed with this config but not with the baseline
+    uint64_t only_baseline_failed; ///< ciphertexts that failed with the baseline but not with this config
+} sweep_cell_t;
+
+/**
+ * @brief Result of a sweep, one cell per (error count, config) pair.
+ */
+typedef struct {
+    sweep_params_t params; ///< parameters of the sweep
+    sweep_cell_t * cells; ///< num_error_counts * num_configs cells, see sweep_result_cell
+} sweep_result_t;
+
+/**
+ * @brief Parse a comma separated list of positive integers, e.g. "84,86,88".
+ *
+ * @param str string to parse
+ * @param out_values memory location to store a newly allocated array to, must be freed by the caller
+ * @param out_count memory location to store the number of values to
+ * @return true on success, false if str is not a valid list (nothing is allocated)
+ */
+bool sweep_parse_error_counts(const char * str, size_t ** out_values, size_t * out_count);
+
+/**
+ * @brief Parse a comma separated list of DECODER:OPT configurations, e.g. "2:3,3:0,3:1".
+ *
+ * Every configuration must be supported by sim_select_decoder.
+ *
+ * @param str string to parse
+ * @param out_configs memory location to store a newly allocated array to, must be freed by the caller
+ * @param out_count memory location to store the number of configurations to
+ * @return true on success, false if str is not a valid list (nothing is allocated)
+ */
+bool sweep_parse_configs(const char * str, sweep_config_t ** out_configs, size_t * out_count);
+
+/**
+ * @brief Initialize an empty result.
+ *
+ * Initialized result must be cleaned up using sweep_result_deinit function if no longer needed!
+ *
+ * @param result memory location of the result
+ * @param params sweep parameters, the arrays must outlive the result
+ */
+void sweep_result_init(sweep_result_t * result, sweep_params_t * params);
+
+/**
+ * @brief Destroy a result.
+ *
+ * @param result an initialized result
+ */
+void sweep_result_deinit(sweep_result_t * result);
+
+/**
+ * @brief Get the cell of an (error count, config) pair.
+ *
+ * @param result an initialized result
+ * @param error_index index into params.error_counts
+ * @param config_index index into params.configs
+ * @return pointer to the cell
+ */
+sweep_cell_t * sweep_result_cell(sweep_result_t * result, size_t error_index, size_t config_index);
+
+/**
+ * @brief Run the sweep.
+ *
+ * @param params sweep parameters
+ * @param sink opened sink to write a record of every decoding to, may be NULL
+ * @param progress_interval minimum number of seconds between two progress lines
+ * @param result an initialized result to accumulate to
+ */
+void sweep_run(sweep_params_t * params, report_sink_t * sink, double progress_interval, sweep_result_t * result);
+
+/**
+ * @brief Print the result as a table with one row per (error count, config) pair.
+ *
+ * Besides DFR, its 95% Wilson interval and mean iterations, every row contains the discordant pairs
+ * against the baseline configuration and McNemar's statistic (b - c)^2 / (b + c),
+ * values above 3.84 mean a significant difference at the 5% level.
+ *
+ * @param stream stream to be used (e.g. stdout, stderr...)
+ * @param result an initialized result
+ */
+void sweep_result_print(FILE * stream, sweep_result_t * result);
+
+#endif //MDPC_GF4_SWEEP_H
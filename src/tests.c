@@ -40,6 +40,15 @@ bool test_compare_coeffs(gf4_t * coeffs1, gf4_t * coeffs2, size_t size) {
     return ret;
 }
 
+bool test_compare_matrix_row(gf4_matrix_t * matrix, size_t row, gf4_t * expected) {
+    gf4_t * unpacked = malloc(matrix->num_cols * sizeof(gf4_t));
+    assert(NULL != unpacked);
+    gf4_matrix_get_row(matrix, row, unpacked);
+    bool ret = test_compare_coeffs(unpacked, expected, matrix->num_cols);
+    free(unpacked);
+    return ret;
+}
+
 // gf4
 void test_gf4_is_in_range() {
     fprintf(stderr, "%s: \n", __func__);
@@ -165,6 +174,54 @@ void test_gf4_array_hamming_weight() {
     }
 }
 
+void test_gf4_array_init_in() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        gf4_arena_t arena;
+        gf4_arena_init(&arena, 256);
+
+        // test: aligned, padded and zeroed arrays
+        gf4_array_t a = gf4_array_init_in(&arena, 10, true);
+        gf4_array_t b = gf4_array_init_in(&arena, 65, true);
+        assert(10 == a.capacity && 65 == b.capacity);
+        assert(0 == (uintptr_t)a.array % GF4_ARENA_ALIGNMENT);
+        assert(0 == (uintptr_t)b.array % GF4_ARENA_ALIGNMENT);
+        assert(b.array >= a.array + GF4_ARENA_ALIGNMENT || a.array >= b.array + 2 * GF4_ARENA_ALIGNMENT);
+        for (size_t i = 0; i < 2 * GF4_ARENA_ALIGNMENT; ++i) {
+            assert(0 == b.array[i]);
+        }
+        assert(0 == gf4_array_hamming_weight(&a));
+
+        // test: scopes, memory after a mark is reused
+        gf4_arena_mark_t outer = gf4_arena_mark(&arena);
+        gf4_array_t c = gf4_array_init_in(&arena, 100, false);
+        gf4_arena_mark_t inner = gf4_arena_mark(&arena);
+        gf4_array_t d = gf4_array_init_in(&arena, 1000, true); // larger than a block
+        assert(0 == (uintptr_t)d.array % GF4_ARENA_ALIGNMENT);
+        assert(0 == gf4_array_hamming_weight(&d));
+        gf4_arena_release(&arena, inner);
+        gf4_arena_release(&arena, outer);
+        gf4_array_t e = gf4_array_init_in(&arena, 100, true);
+        assert(e.array == c.array);
+        assert(0 == gf4_array_hamming_weight(&e));
+#ifdef _DEBUG
+        assert(3 == arena.num_allocations);
+        assert(5 == arena.total_allocations);
+        assert(GF4_ARENA_ALIGNMENT + 2 * GF4_ARENA_ALIGNMENT + 2 * GF4_ARENA_ALIGNMENT == arena.bytes_in_use);
+        assert(arena.peak_bytes >= arena.bytes_in_use + 1024);
+#endif
+        gf4_array_t f = gf4_array_init_in(&arena, 1000, false); // reuses the large block
+        assert(f.array == d.array);
+        (void)a; (void)b; (void)c; (void)d; (void)e; (void)f;
+
+        // cleanup
+        gf4_arena_deinit(&arena);
+        test_print_OK();
+    }
+}
+
 // gf4_poly
 void test_gf4_poly_init_zero(){
     fprintf(stderr, "%s: \n", __func__);
@@ -833,16 +890,207 @@ void test_gf4_poly_div_x_to_deg_inplace(){
     }
 }
 
+// a = q * b + r for random q and r with deg r < deg b, check that div_rem(a, b) = (q, r)
+static void test_div_rem_random(gf4_poly_t * b, size_t div_degree) {
+    size_t capacity = div_degree + b->degree + 1;
+    gf4_poly_t q = gf4_poly_init_zero(capacity);
+    gf4_poly_t r = gf4_poly_init_zero(capacity);
+    gf4_poly_t a = gf4_poly_init_zero(capacity);
+    gf4_poly_t div = gf4_poly_init_zero(capacity);
+    gf4_poly_t rem = gf4_poly_init_zero(capacity);
+    random_gf4_array(&q.coefficients, div_degree + 1);
+    gf4_poly_set_coefficient(&q, div_degree, 1);
+    gf4_poly_adjust_degree(&q, div_degree);
+    random_gf4_array(&r.coefficients, b->degree);
+    gf4_poly_adjust_degree(&r, b->degree - 1);
+    gf4_poly_mul(&a, &q, b);
+    gf4_poly_add_inplace(&a, &r);
+    gf4_poly_div_rem(&div, &rem, &a, b);
+    assert(gf4_poly_equal(&div, &q));
+    assert(gf4_poly_equal(&rem, &r));
+    gf4_poly_deinit(&q);
+    gf4_poly_deinit(&r);
+    gf4_poly_deinit(&a);
+    gf4_poly_deinit(&div);
+    gf4_poly_deinit(&rem);
+}
+
 void test_gf4_poly_div_rem(){
     fprintf(stderr, "%s: \n", __func__);
-    // test_print_OK();
-    fprintf(stderr, "\tNOT YET IMPLEMENTED!\n");
+    random_seed(37);
+    {
+        test_print_test_number_str("1");
+        // test: long division, 1 + x + 3x^2 + 2x^5 + x^9
+        gf4_poly_t b = gf4_poly_init_zero(10);
+        gf4_poly_set_coefficient(&b, 0, 1);
+        gf4_poly_set_coefficient(&b, 1, 1);
+        gf4_poly_set_coefficient(&b, 2, 3);
+        gf4_poly_set_coefficient(&b, 5, 2);
+        gf4_poly_set_coefficient(&b, 9, 1);
+        for (size_t i = 0; i < 20; ++i) {
+            test_div_rem_random(&b, i);
+        }
+        gf4_poly_deinit(&b);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // test: binomial divisors x^13 + 1 and 2x^7 + 3, also quotients of degree >= deg b
+        gf4_poly_t b = gf4_poly_init_zero(14);
+        gf4_poly_set_coefficient(&b, 0, 1);
+        gf4_poly_set_coefficient(&b, 13, 1);
+        for (size_t i = 0; i < 40; ++i) {
+            test_div_rem_random(&b, i);
+        }
+        gf4_poly_zero_out(&b);
+        gf4_poly_set_coefficient(&b, 0, 3);
+        gf4_poly_set_coefficient(&b, 7, 2);
+        for (size_t i = 0; i < 40; ++i) {
+            test_div_rem_random(&b, i);
+        }
+        gf4_poly_deinit(&b);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("3");
+        // test: dividend of lower degree than the binomial divisor
+        gf4_poly_t b = gf4_poly_init_zero(6);
+        gf4_poly_set_coefficient(&b, 0, 1);
+        gf4_poly_set_coefficient(&b, 5, 1);
+        gf4_poly_t a = gf4_poly_init_zero(6);
+        gf4_poly_set_coefficient(&a, 3, 2);
+        gf4_poly_t div = gf4_poly_init_zero(6);
+        gf4_poly_t rem = gf4_poly_init_zero(6);
+        gf4_poly_div_rem(&div, &rem, &a, &b);
+        assert(gf4_poly_is_zero(&div));
+        assert(gf4_poly_equal(&rem, &a));
+        gf4_poly_deinit(&a);
+        gf4_poly_deinit(&b);
+        gf4_poly_deinit(&div);
+        gf4_poly_deinit(&rem);
+        test_print_OK();
+    }
 }
 
 void test_gf4_poly_invert_slow(){
     fprintf(stderr, "%s: \n", __func__);
-    // test_print_OK();
-    fprintf(stderr, "\tNOT YET IMPLEMENTED!\n");
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t r = 101;
+        gf4_poly_t modulus = gf4_poly_init_zero(r + 1);
+        gf4_poly_set_coefficient(&modulus, 0, 1);
+        gf4_poly_set_coefficient(&modulus, r, 1);
+        gf4_poly_t poly = gf4_poly_init_zero(r + 1);
+        gf4_poly_t inverse = gf4_poly_init_zero(r + 1);
+        gf4_poly_t product = gf4_poly_init_zero(2 * r + 2);
+        gf4_poly_t div = gf4_poly_init_zero(2 * r + 2);
+        gf4_poly_t rem = gf4_poly_init_zero(2 * r + 2);
+        random_seed(101);
+        random_weighted_gf4_array(&poly.coefficients, r, 15);
+        gf4_poly_adjust_degree(&poly, r - 1);
+        if (0 == gf4_array_sum(&poly.coefficients)) {
+            poly.coefficients.array[poly.degree] ^= 1;
+        }
+
+        // test: poly * inverse = 1 (mod x^r + 1), 2 + 2x is not invertible
+        bool inverted = gf4_poly_invert_slow(&inverse, &poly, &modulus);
+        assert(inverted);
+        gf4_poly_mul(&product, &poly, &inverse);
+        gf4_poly_div_rem(&div, &rem, &product, &modulus);
+        assert(0 == rem.degree && 1 == rem.coefficients.array[0]);
+        gf4_poly_zero_out(&poly);
+        gf4_poly_set_coefficient(&poly, 0, 2);
+        gf4_poly_set_coefficient(&poly, 1, 2);
+        inverted = gf4_poly_invert_slow(&inverse, &poly, &modulus);
+        assert(!inverted);
+        (void)inverted;
+        assert(gf4_poly_is_zero(&inverse));
+
+        // cleanup
+        gf4_poly_deinit(&modulus);
+        gf4_poly_deinit(&poly);
+        gf4_poly_deinit(&inverse);
+        gf4_poly_deinit(&product);
+        gf4_poly_deinit(&div);
+        gf4_poly_deinit(&rem);
+        test_print_OK();
+    }
+}
+
+void test_gf4_poly_workspace(){
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        gf4_poly_workspace_t ws;
+        gf4_poly_workspace_init(&ws, 3, 10);
+
+        // test: taken polynomials are zero and distinct, release returns them
+        size_t mark = gf4_poly_workspace_mark(&ws);
+        gf4_poly_t * p1 = gf4_poly_workspace_take(&ws);
+        gf4_poly_set_coefficient(p1, 4, 2);
+        gf4_poly_t * p2 = gf4_poly_workspace_take(&ws);
+        assert(p1 != p2);
+        assert(gf4_poly_is_zero(p2));
+        assert(10 == p2->coefficients.capacity);
+        assert(2 == ws.used);
+        gf4_poly_workspace_release(&ws, mark);
+        assert(0 == ws.used);
+        gf4_poly_t * p3 = gf4_poly_workspace_take(&ws);
+        assert(p3 == p1);
+        assert(gf4_poly_is_zero(p3));
+        (void)p2; (void)p3;
+
+        // cleanup
+        gf4_poly_workspace_deinit(&ws);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // setup
+        const size_t r = 211;
+        gf4_poly_workspace_t ws;
+        gf4_poly_workspace_init(&ws, GF4_POLY_INVERT_WS_POLYS, 2 * r);
+        gf4_poly_t modulus = gf4_poly_init_zero(r + 1);
+        gf4_poly_set_coefficient(&modulus, 0, 1);
+        gf4_poly_set_coefficient(&modulus, r, 1);
+        gf4_poly_t poly = gf4_poly_init_zero(2 * r);
+        gf4_poly_t inverse_slow = gf4_poly_init_zero(2 * r);
+        gf4_poly_t inverse_ws = gf4_poly_init_zero(2 * r);
+        gf4_poly_t div = gf4_poly_init_zero(2 * r);
+        random_seed(211);
+
+        // test: invert_ws equals invert_slow and leaves the workspace free
+        for (size_t i = 0; i < 10; ++i) {
+            gf4_poly_zero_out(&poly);
+            random_weighted_gf4_array(&poly.coefficients, r, 21);
+            gf4_poly_adjust_degree(&poly, r - 1);
+            bool inverted_slow = gf4_poly_invert_slow(&inverse_slow, &poly, &modulus);
+            bool inverted_ws = gf4_poly_invert_ws(&inverse_ws, &poly, &modulus, &ws);
+            assert(inverted_slow == inverted_ws);
+            assert(gf4_poly_equal(&inverse_slow, &inverse_ws));
+            assert(0 == ws.used);
+            (void)inverted_slow; (void)inverted_ws;
+        }
+
+        // test: in-place mul_ws and div_rem_ws, (poly * inverse) mod (x^r + 1) = 1
+        gf4_poly_mul_ws(&inverse_ws, &inverse_ws, &poly, &ws);
+        gf4_poly_div_rem_ws(&div, &inverse_ws, &inverse_ws, &modulus, &ws);
+        assert(0 == ws.used);
+        if (0 != gf4_array_sum(&poly.coefficients)) {
+            assert(0 == inverse_ws.degree && 1 == inverse_ws.coefficients.array[0]);
+        }
+
+        // cleanup
+        gf4_poly_workspace_deinit(&ws);
+        gf4_poly_deinit(&modulus);
+        gf4_poly_deinit(&poly);
+        gf4_poly_deinit(&inverse_slow);
+        gf4_poly_deinit(&inverse_ws);
+        gf4_poly_deinit(&div);
+        test_print_OK();
+    }
 }
 
 void test_gf4_poly_is_zero(){
@@ -1142,12 +1390,188 @@ void test_gf4_square_matrix_init_cyclic_matrix() {
         gf4_matrix_t matrix = gf4_matrix_init_cyclic_matrix(&first_row, 5);
         assert(5 == matrix.num_rows);
         for (size_t i = 0; i < 5; ++i) {
-            assert(test_compare_coeffs(matrix.rows[i], expected_matrix[i], 5));
+            assert(test_compare_matrix_row(&matrix, i, expected_matrix[i]));
+        }
+
+        // cleanup
+        gf4_poly_deinit(&first_row);
+        gf4_matrix_deinit(&matrix);
+        test_print_OK();
+    }
+}
+
+void test_gf4_matrix_storage() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t num_rows = 5, num_cols = 150;
+        gf4_matrix_t matrix = gf4_matrix_init_zero(num_rows, num_cols);
+        gf4_t expected[5][150] = {0};
+        random_seed(42);
+        for (size_t row = 0; row < num_rows; ++row) {
+            for (size_t col = 0; col < num_cols; ++col) {
+                expected[row][col] = (gf4_t)random_from_range(0, GF4_MAX_VALUE);
+                gf4_matrix_set(&matrix, row, col, expected[row][col]);
+            }
+        }
+
+        // test: layout
+        assert(0 == (uintptr_t)matrix.data % GF4_MATRIX_ALIGNMENT);
+        assert(3 == matrix.num_words);
+        assert(0 == matrix.stride % (GF4_MATRIX_ALIGNMENT / sizeof(uint64_t)));
+        for (size_t row = 0; row < num_rows; ++row) {
+            assert(test_compare_matrix_row(&matrix, row, expected[row]));
+        }
+
+        // test: swap, remove a row, remove columns in the first and in the last word
+        gf4_matrix_swap_rows(&matrix, 0, 4);
+        assert(test_compare_matrix_row(&matrix, 0, expected[4]));
+        assert(test_compare_matrix_row(&matrix, 4, expected[0]));
+        gf4_matrix_swap_rows(&matrix, 0, 4);
+        gf4_matrix_remove_row_inplace(&matrix, 1);
+        gf4_matrix_remove_col_inplace(&matrix, 149);
+        gf4_matrix_remove_col_inplace(&matrix, 63);
+        gf4_matrix_remove_col_inplace(&matrix, 0);
+        assert(4 == matrix.num_rows);
+        assert(147 == matrix.num_cols);
+        size_t kept_rows[4] = {0, 2, 3, 4};
+        for (size_t row = 0; row < 4; ++row) {
+            for (size_t col = 0; col < 147; ++col) {
+                size_t original_col = col + 1 + (col >= 62);
+                assert(expected[kept_rows[row]][original_col] == gf4_matrix_get(&matrix, row, col));
+                (void)original_col;
+            }
+        }
+        (void)kept_rows;
+
+        // test: clone and realloc keep the logical rows
+        gf4_matrix_t clone = gf4_matrix_clone(&matrix);
+        gf4_matrix_realloc_to_match_dimensions_inplace(&matrix);
+        for (size_t row = 0; row < 4; ++row) {
+            assert(matrix.row_index[row] == row);
+            for (size_t col = 0; col < 147; ++col) {
+                assert(gf4_matrix_get(&clone, row, col) == gf4_matrix_get(&matrix, row, col));
+            }
+        }
+
+        // cleanup
+        gf4_matrix_deinit(&clone);
+        gf4_matrix_deinit(&matrix);
+        test_print_OK();
+    }
+}
+
+void test_gf4_matrix_select() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t N = 131;
+        gf4_poly_t first_row = gf4_poly_init_zero(N);
+        random_seed(43);
+        random_gf4_array(&first_row.coefficients, N);
+        gf4_matrix_t matrix = gf4_matrix_init_cyclic_matrix(&first_row, N);
+        bool * row_mask = calloc(N, sizeof(bool));
+        bool * col_mask = calloc(N, sizeof(bool));
+        assert(NULL != row_mask && NULL != col_mask);
+        for (size_t i = 0; i < N; ++i) {
+            row_mask[i] = (0 != random_from_range(0, 2));
+            col_mask[i] = (0 != random_from_range(0, 3));
+        }
+        row_mask[0] = true;
+        col_mask[0] = true;
+
+        // test: same as removing the rows and columns one by one
+        gf4_matrix_t expected = gf4_matrix_clone(&matrix);
+        size_t idx = N;
+        do {
+            --idx;
+            if (!row_mask[idx]) {
+                gf4_matrix_remove_row_inplace(&expected, idx);
+            }
+            if (!col_mask[idx]) {
+                gf4_matrix_remove_col_inplace(&expected, idx);
+            }
+        } while (0 != idx);
+        gf4_matrix_t selected = gf4_matrix_select(&matrix, row_mask, col_mask);
+        assert(expected.num_rows == selected.num_rows);
+        assert(expected.num_cols == selected.num_cols);
+        for (size_t row = 0; row < selected.num_rows; ++row) {
+            for (size_t col = 0; col < selected.num_cols; ++col) {
+                assert(gf4_matrix_get(&expected, row, col) == gf4_matrix_get(&selected, row, col));
+            }
+        }
+
+        // test: NULL masks keep everything
+        gf4_matrix_t all = gf4_matrix_select(&matrix, NULL, NULL);
+        assert(N == all.num_rows && N == all.num_cols);
+        for (size_t row = 0; row < N; ++row) {
+            for (size_t col = 0; col < N; ++col) {
+                assert(gf4_matrix_get(&matrix, row, col) == gf4_matrix_get(&all, row, col));
+            }
         }
 
         // cleanup
+        gf4_matrix_deinit(&all);
+        gf4_matrix_deinit(&selected);
+        gf4_matrix_deinit(&expected);
+        gf4_matrix_deinit(&matrix);
         gf4_poly_deinit(&first_row);
+        free(row_mask);
+        free(col_mask);
+        test_print_OK();
+    }
+}
+
+void test_gf4_circulant_select() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t N = 197;
+        gf4_poly_t first_row = gf4_poly_init_zero(N);
+        random_seed(44);
+        random_gf4_array(&first_row.coefficients, N);
+        gf4_matrix_t matrix = gf4_matrix_init_cyclic_matrix(&first_row, N);
+        gf4_circulant_t circulant = gf4_circulant_init_view(&first_row, N);
+        bool * row_mask = calloc(N, sizeof(bool));
+        bool * col_mask = calloc(N, sizeof(bool));
+        assert(NULL != row_mask && NULL != col_mask);
+        for (size_t i = 0; i < N; ++i) {
+            row_mask[i] = (0 != random_from_range(0, 3));
+            col_mask[i] = (0 != random_from_range(0, 2));
+        }
+        row_mask[N - 1] = true;
+        col_mask[N - 1] = true;
+
+        // test: elements and selections match the materialized cyclic matrix
+        for (size_t row = 0; row < N; ++row) {
+            for (size_t col = 0; col < N; ++col) {
+                assert(gf4_matrix_get(&matrix, row, col) == gf4_circulant_get(&circulant, row, col));
+            }
+        }
+        const bool * row_masks[2] = {row_mask, NULL};
+        const bool * col_masks[2] = {col_mask, NULL};
+        for (size_t m = 0; m < 4; ++m) {
+            gf4_matrix_t expected = gf4_matrix_select(&matrix, row_masks[m / 2], col_masks[m % 2]);
+            gf4_matrix_t selected = gf4_circulant_select(&circulant, row_masks[m / 2], col_masks[m % 2]);
+            assert(expected.num_rows == selected.num_rows);
+            assert(expected.num_cols == selected.num_cols);
+            for (size_t row = 0; row < selected.num_rows; ++row) {
+                for (size_t col = 0; col < selected.num_cols; ++col) {
+                    assert(gf4_matrix_get(&expected, row, col) == gf4_matrix_get(&selected, row, col));
+                }
+            }
+            gf4_matrix_deinit(&expected);
+            gf4_matrix_deinit(&selected);
+        }
+
+        // cleanup
         gf4_matrix_deinit(&matrix);
+        gf4_poly_deinit(&first_row);
+        free(row_mask);
+        free(col_mask);
         test_print_OK();
     }
 }
@@ -1173,7 +1597,7 @@ void test_gf4_matrix_gaussian_elimination_inplace() {
         assert(4 == matrix.num_rows);
         assert(4 == matrix.num_cols);
         for (size_t i = 0; i < 4; ++i) {
-            assert(test_compare_coeffs(matrix.rows[i], expected_matrix[i], 4));
+            assert(test_compare_matrix_row(&matrix, i, expected_matrix[i]));
         }
         gf4_poly_deinit(&first_row);
         test_print_OK();
@@ -1195,11 +1619,233 @@ void test_gf4_matrix_gaussian_elimination_inplace() {
         assert(4 == matrix.num_rows);
         assert(4 == matrix.num_cols);
         for (size_t i = 0; i < 4; ++i) {
-            assert(test_compare_coeffs(matrix.rows[i], expected_matrix[i], 4));
+            assert(test_compare_matrix_row(&matrix, i, expected_matrix[i]));
+        }
+        gf4_poly_deinit(&first_row);
+        test_print_OK();
+    }
+}
+
+static gf4_matrix_t test_random_matrix(size_t num_rows, size_t num_cols, size_t rank) {
+    // product of random num_rows x rank and rank x num_cols matrices, its rank is at most rank
+    gf4_matrix_t matrix = gf4_matrix_init_zero(num_rows, num_cols);
+    gf4_t * basis = malloc(rank * num_cols * sizeof(gf4_t));
+    gf4_t * row_values = calloc(num_cols, sizeof(gf4_t));
+    assert(NULL != basis && NULL != row_values);
+    for (size_t i = 0; i < rank * num_cols; ++i) {
+        basis[i] = (gf4_t)random_from_range(0, GF4_MAX_VALUE);
+    }
+    for (size_t row = 0; row < num_rows; ++row) {
+        memset(row_values, 0, num_cols * sizeof(gf4_t));
+        for (size_t i = 0; i < rank; ++i) {
+            gf4_t coefficient = (gf4_t)random_from_range(0, GF4_MAX_VALUE);
+            for (size_t col = 0; col < num_cols; ++col) {
+                row_values[col] ^= gf4_mul(coefficient, basis[i * num_cols + col]);
+            }
+        }
+        for (size_t col = 0; col < num_cols; ++col) {
+            gf4_matrix_set(&matrix, row, col, row_values[col]);
+        }
+    }
+    free(row_values);
+    free(basis);
+    return matrix;
+}
+
+void test_gf4_matrix_gaussian_elimination_m4rm_inplace() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        gf4_poly_t first_row = gf4_poly_init_zero(4);
+        gf4_poly_set_coefficient(&first_row, 0, 1);
+        gf4_poly_set_coefficient(&first_row, 2, 1);
+        gf4_matrix_t matrix = gf4_matrix_init_cyclic_matrix(&first_row, 4);
+        gf4_t expected_matrix[4][4] = {
+                {1, 0, 1, 0},
+                {0, 1, 0, 1},
+                {0, 0, 0, 0},
+                {0, 0, 0, 0}
+        };
+
+        // test
+        gf4_matrix_gaussian_elimination_m4rm_inplace(&matrix);
+        for (size_t i = 0; i < 4; ++i) {
+            assert(test_compare_matrix_row(&matrix, i, expected_matrix[i]));
         }
+        (void)expected_matrix;
+
+        // cleanup
+        gf4_matrix_deinit(&matrix);
         gf4_poly_deinit(&first_row);
         test_print_OK();
     }
+    {
+        test_print_test_number_str("2");
+        // test: same as the reference elimination with normalized pivots (the reduced form is unique)
+        random_seed(41);
+        const size_t dims[][3] = {{1, 3, 1}, {7, 5, 5}, {20, 20, 20}, {30, 70, 17}, {70, 30, 30}, {130, 150, 128}};
+        for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); ++d) {
+            gf4_matrix_t matrix = test_random_matrix(dims[d][0], dims[d][1], dims[d][2]);
+            gf4_matrix_t expected = gf4_matrix_clone(&matrix);
+            gf4_matrix_gaussian_elimination_inplace(&expected);
+            gf4_t * expected_row = malloc(expected.num_cols * sizeof(gf4_t));
+            assert(NULL != expected_row);
+            gf4_matrix_gaussian_elimination_m4rm_inplace(&matrix);
+            for (size_t row = 0; row < expected.num_rows; ++row) {
+                gf4_matrix_get_row(&expected, row, expected_row);
+                size_t col = 0;
+                while (col < expected.num_cols && 0 == expected_row[col]) {
+                    ++col;
+                }
+                if (col < expected.num_cols) {
+                    gf4_t pivot = expected_row[col];
+                    for (; col < expected.num_cols; ++col) {
+                        expected_row[col] = gf4_div(expected_row[col], pivot);
+                    }
+                }
+                assert(test_compare_matrix_row(&matrix, row, expected_row));
+            }
+            free(expected_row);
+            gf4_matrix_deinit(&matrix);
+            gf4_matrix_deinit(&expected);
+        }
+        test_print_OK();
+    }
+}
+
+void test_gf4_matrix_gaussian_elimination_parallel_inplace() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // test: identical to the single-threaded elimination for any number of threads
+        random_seed(45);
+        const size_t dims[][3] = {{3, 5, 3}, {40, 40, 33}, {150, 300, 150}, {301, 200, 180}};
+        const size_t threads[] = {2, 3, 7, 500};
+        for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); ++d) {
+            gf4_matrix_t expected = test_random_matrix(dims[d][0], dims[d][1], dims[d][2]);
+            gf4_matrix_t original = gf4_matrix_clone(&expected);
+            gf4_matrix_gaussian_elimination_m4rm_inplace(&expected);
+            gf4_t * expected_row = malloc(expected.num_cols * sizeof(gf4_t));
+            assert(NULL != expected_row);
+            for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+                gf4_matrix_t matrix = gf4_matrix_clone(&original);
+                gf4_matrix_gaussian_elimination_parallel_inplace(&matrix, threads[t]);
+                for (size_t row = 0; row < matrix.num_rows; ++row) {
+                    gf4_matrix_get_row(&expected, row, expected_row);
+                    assert(test_compare_matrix_row(&matrix, row, expected_row));
+                }
+                gf4_matrix_deinit(&matrix);
+            }
+            free(expected_row);
+            gf4_matrix_deinit(&original);
+            gf4_matrix_deinit(&expected);
+        }
+        test_print_OK();
+    }
+}
+
+void test_gf4_matrix_nullspace() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup: same system as test 4 of test_gf4_matrix_solve_homogenous_linear_system
+        gf4_matrix_t matrix = gf4_matrix_init_zero(4, 4);
+        gf4_matrix_set(&matrix, 0, 0, 1);
+        gf4_matrix_set(&matrix, 0, 1, 2);
+        gf4_matrix_set(&matrix, 1, 2, 1);
+        gf4_matrix_set(&matrix, 2, 3, 3);
+        gf4_t expected_basis[4] = {2, 1, 0, 0};
+
+        // test
+        gf4_matrix_gaussian_elimination_m4rm_inplace(&matrix);
+        gf4_matrix_t basis = gf4_matrix_nullspace(&matrix);
+        assert(1 == basis.num_rows);
+        assert(4 == basis.num_cols);
+        assert(test_compare_matrix_row(&basis, 0, expected_basis));
+        (void)expected_basis;
+
+        // cleanup
+        gf4_matrix_deinit(&basis);
+        gf4_matrix_deinit(&matrix);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // test: the basis vectors solve the original system, full rank has a trivial nullspace
+        random_seed(46);
+        const size_t dims[][3] = {{10, 10, 10}, {30, 70, 17}, {100, 130, 90}};
+        for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); ++d) {
+            gf4_matrix_t original = test_random_matrix(dims[d][0], dims[d][1], dims[d][2]);
+            gf4_matrix_t matrix = gf4_matrix_clone(&original);
+            gf4_matrix_gaussian_elimination_parallel_inplace(&matrix, 2);
+            size_t rank = 0;
+            for (size_t row = 0; row < matrix.num_rows; ++row) {
+                for (size_t col = 0; col < matrix.num_cols; ++col) {
+                    if (0 != gf4_matrix_get(&matrix, row, col)) {
+                        ++rank;
+                        break;
+                    }
+                }
+            }
+            gf4_matrix_t basis = gf4_matrix_nullspace(&matrix);
+            assert(basis.num_rows == original.num_cols - rank);
+            for (size_t i = 0; i < basis.num_rows; ++i) {
+                for (size_t row = 0; row < original.num_rows; ++row) {
+                    gf4_t sum = 0;
+                    for (size_t col = 0; col < original.num_cols; ++col) {
+                        sum ^= gf4_mul(gf4_matrix_get(&original, row, col), gf4_matrix_get(&basis, i, col));
+                    }
+                    assert(0 == sum);
+                }
+            }
+            gf4_matrix_deinit(&basis);
+            gf4_matrix_deinit(&matrix);
+            gf4_matrix_deinit(&original);
+        }
+        test_print_OK();
+    }
+}
+
+void test_gf4_matrix_kernel_solver() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // test: same basis as eliminating every column selection from scratch
+        random_seed(47);
+        const size_t dims[][3] = {{5, 8, 3}, {40, 90, 35}, {120, 100, 100}, {150, 200, 60}};
+        for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); ++d) {
+            gf4_matrix_t matrix = test_random_matrix(dims[d][0], dims[d][1], dims[d][2]);
+            gf4_matrix_kernel_solver_t solver;
+            gf4_matrix_kernel_solver_init(&solver, &matrix, 2);
+            bool * col_mask = calloc(matrix.num_cols, sizeof(bool));
+            assert(NULL != col_mask);
+            for (size_t trial = 0; trial < 5; ++trial) {
+                for (size_t col = 0; col < matrix.num_cols; ++col) {
+                    col_mask[col] = (0 != random_from_range(0, trial + 1));
+                }
+                col_mask[trial] = true;
+                gf4_matrix_t selected = gf4_matrix_select(&matrix, NULL, col_mask);
+                gf4_matrix_gaussian_elimination_m4rm_inplace(&selected);
+                gf4_matrix_t expected = gf4_matrix_nullspace(&selected);
+                gf4_matrix_t basis = gf4_matrix_kernel_solver_nullspace(&solver, col_mask, 2);
+                assert(expected.num_rows == basis.num_rows);
+                assert(expected.num_cols == basis.num_cols);
+                for (size_t row = 0; row < basis.num_rows; ++row) {
+                    for (size_t col = 0; col < basis.num_cols; ++col) {
+                        assert(gf4_matrix_get(&expected, row, col) == gf4_matrix_get(&basis, row, col));
+                    }
+                }
+                gf4_matrix_deinit(&basis);
+                gf4_matrix_deinit(&expected);
+                gf4_matrix_deinit(&selected);
+            }
+            free(col_mask);
+            gf4_matrix_kernel_solver_deinit(&solver);
+            gf4_matrix_deinit(&matrix);
+        }
+        test_print_OK();
+    }
 }
 
 void test_gf4_matrix_solve_homogenous_linear_system() {
@@ -1208,23 +1854,17 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
     // test 1
     {
         test_print_test_number_str("1");
-        gf4_matrix_t matrix;
-        matrix.num_rows = 1;
-        matrix.num_cols = 3;
-        matrix.rows = malloc(sizeof(gf4_t *));
-        assert(NULL != matrix.rows);
-        matrix.rows[0] = malloc(3 * sizeof(gf4_t));
-        assert(NULL != matrix.rows[0]);
-        matrix.rows[0][0] = 2;
-        matrix.rows[0][1] = 1;
-        matrix.rows[0][2] = 0;
+        gf4_matrix_t matrix = gf4_matrix_init_zero(1, 3);
+        gf4_matrix_set(&matrix, 0, 0, 2);
+        gf4_matrix_set(&matrix, 0, 1, 1);
+        gf4_matrix_set(&matrix, 0, 2, 0);
 
         gf4_matrix_gaussian_elimination_inplace(&matrix);
         assert(1 == matrix.num_rows);
         assert(3 == matrix.num_cols);
-        assert(2 == matrix.rows[0][0]);
-        assert(1 == matrix.rows[0][1]);
-        assert(0 == matrix.rows[0][2]);
+        assert(2 == gf4_matrix_get(&matrix, 0, 0));
+        assert(1 == gf4_matrix_get(&matrix, 0, 1));
+        assert(0 == gf4_matrix_get(&matrix, 0, 2));
 
         gf4_matrix_t solutions = gf4_matrix_solve_homogenous_linear_system(&matrix);
         gf4_t expected_solutions[16][3] = {
@@ -1248,7 +1888,7 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
         assert(16 == solutions.num_rows);
         assert(3 == solutions.num_cols);
         for (size_t i = 0; i < 16; ++i) {
-            assert(test_compare_coeffs(solutions.rows[i], expected_solutions[i], 3));
+            assert(test_compare_matrix_row(&solutions, i, expected_solutions[i]));
         }
 
         gf4_matrix_deinit(&matrix);
@@ -1272,21 +1912,21 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
         assert(3 == equations.num_cols);
         assert(3 == equations.num_rows);
         for (size_t i = 0; i < 3; ++i) {
-            assert(test_compare_coeffs(equations.rows[i], expected_equations[i], 3));
+            assert(test_compare_matrix_row(&equations, i, expected_equations[i]));
         }
 
         gf4_matrix_gaussian_elimination_inplace(&equations);
         assert(3 == equations.num_cols);
         assert(3 == equations.num_rows);
         for (size_t i = 0; i < 3; ++i) {
-            assert(test_compare_coeffs(equations.rows[i], expected_equations[i], 3));
+            assert(test_compare_matrix_row(&equations, i, expected_equations[i]));
         }
 
         gf4_matrix_t solutions = gf4_matrix_solve_homogenous_linear_system(&equations);
         gf4_t expected_solution[3] = {0, 0, 0};
         assert(1 == solutions.num_rows);
         assert(3 == solutions.num_cols);
-        assert(test_compare_coeffs(solutions.rows[0], expected_solution, 3));
+        assert(test_compare_matrix_row(&solutions, 0, expected_solution));
 
         gf4_matrix_deinit(&solutions);
         gf4_matrix_deinit(&equations);
@@ -1297,23 +1937,17 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
     // test 3
     {
         test_print_test_number_str("3");
-        gf4_matrix_t matrix;
-        matrix.num_rows = 1;
-        matrix.num_cols = 3;
-        matrix.rows = malloc(sizeof(gf4_t *));
-        assert(NULL != matrix.rows);
-        matrix.rows[0] = malloc(3 * sizeof(gf4_t));
-        assert(NULL != matrix.rows[0]);
-        matrix.rows[0][0] = 0;
-        matrix.rows[0][1] = 1;
-        matrix.rows[0][2] = 0;
+        gf4_matrix_t matrix = gf4_matrix_init_zero(1, 3);
+        gf4_matrix_set(&matrix, 0, 0, 0);
+        gf4_matrix_set(&matrix, 0, 1, 1);
+        gf4_matrix_set(&matrix, 0, 2, 0);
 
         gf4_matrix_gaussian_elimination_inplace(&matrix);
         assert(1 == matrix.num_rows);
         assert(3 == matrix.num_cols);
-        assert(0 == matrix.rows[0][0]);
-        assert(1 == matrix.rows[0][1]);
-        assert(0 == matrix.rows[0][2]);
+        assert(0 == gf4_matrix_get(&matrix, 0, 0));
+        assert(1 == gf4_matrix_get(&matrix, 0, 1));
+        assert(0 == gf4_matrix_get(&matrix, 0, 2));
 
         gf4_matrix_t solutions = gf4_matrix_solve_homogenous_linear_system(&matrix);
         gf4_t expected_solutions[16][3] = {
@@ -1337,7 +1971,7 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
         assert(16 == solutions.num_rows);
         assert(3 == solutions.num_cols);
         for (size_t i = 0; i < 16; ++i) {
-            assert(test_compare_coeffs(solutions.rows[i], expected_solutions[i], 3));
+            assert(test_compare_matrix_row(&solutions, i, expected_solutions[i]));
         }
 
         gf4_matrix_deinit(&matrix);
@@ -1348,27 +1982,19 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
     // test 4
     {
         test_print_test_number_str("4");
-        gf4_matrix_t matrix;
-        matrix.num_rows = 4;
-        matrix.num_cols = 4;
-        matrix.rows = malloc(4* sizeof(gf4_t *));
-        assert(NULL != matrix.rows);
-        for (size_t i = 0; i < 4; ++i) {
-            matrix.rows[i] = calloc(4, sizeof(gf4_t));
-            assert(NULL != matrix.rows[0]);
-        }
-        matrix.rows[0][0] = 1;
-        matrix.rows[0][1] = 2;
-        matrix.rows[1][2] = 1;
-        matrix.rows[2][3] = 3;
+        gf4_matrix_t matrix = gf4_matrix_init_zero(4, 4);
+        gf4_matrix_set(&matrix, 0, 0, 1);
+        gf4_matrix_set(&matrix, 0, 1, 2);
+        gf4_matrix_set(&matrix, 1, 2, 1);
+        gf4_matrix_set(&matrix, 2, 3, 3);
 
         gf4_matrix_gaussian_elimination_inplace(&matrix);
         assert(4 == matrix.num_rows);
         assert(4 == matrix.num_cols);
-        assert(1 == matrix.rows[0][0]);
-        assert(2 == matrix.rows[0][1]);
-        assert(1 == matrix.rows[1][2]);
-        assert(3 == matrix.rows[2][3]);
+        assert(1 == gf4_matrix_get(&matrix, 0, 0));
+        assert(2 == gf4_matrix_get(&matrix, 0, 1));
+        assert(1 == gf4_matrix_get(&matrix, 1, 2));
+        assert(3 == gf4_matrix_get(&matrix, 2, 3));
 
         gf4_matrix_t solutions = gf4_matrix_solve_homogenous_linear_system(&matrix);
         gf4_t expected_solutions[4][4] = {
@@ -1380,7 +2006,7 @@ void test_gf4_matrix_solve_homogenous_linear_system() {
         assert(4 == solutions.num_rows);
         assert(4 == solutions.num_cols);
         for (size_t i = 0; i < 4; ++i) {
-            assert(test_compare_coeffs(solutions.rows[i], expected_solutions[i], 4));
+            assert(test_compare_matrix_row(&solutions, i, expected_solutions[i]));
         }
 
         gf4_matrix_deinit(&matrix);
@@ -1469,51 +2095,463 @@ void test_contexts_save_load() {
     }
 }
 
-// enc
-void test_enc_encode() {
+void test_contexts_binary() {
     fprintf(stderr, "%s: \n", __func__);
-    // test 1 - encode empty vector
     {
         test_print_test_number_str("1");
-        encoding_context_t ec;
-        ec.block_size = 3;
-        ec.second_block_G = gf4_poly_init_zero(ec.block_size);
-        gf4_array_t msg = gf4_array_init(ec.block_size, true);
-        gf4_array_t encoded = gf4_array_init(2 * ec.block_size, true);
-        gf4_poly_set_coefficient(&ec.second_block_G, 0, 2);
-        gf4_poly_set_coefficient(&ec.second_block_G, 1, 1);
-        gf4_poly_set_coefficient(&ec.second_block_G, 2, 3);
+        // setup
+        const size_t block_size = 2339;
+        const size_t block_weight = 37;
+        encoding_context_t ec_gen, ec_load;
+        decoding_context_t dc_gen, dc_load;
+        contexts_init(&ec_gen, &dc_gen, block_size, block_weight);
+        char filename[100] = {0};
+        sprintf(filename, "test-file-%lu.bin", (unsigned long) time(NULL));
 
-        enc_encode(&encoded, &msg, &ec);
-        assert(2 == ec.second_block_G.coefficients.array[0]);
-        assert(1 == ec.second_block_G.coefficients.array[1]);
-        assert(3 == ec.second_block_G.coefficients.array[2]);
-        assert(3 == ec.block_size);
-        assert(3 == ec.second_block_G.coefficients.capacity);
-        assert(6 == encoded.capacity);
-        for (size_t i = 0; i < 6; ++i) assert(0 == encoded.array[i]);
+        // test: save binary, load with auto-detection, compare to the original
+        contexts_save_binary(filename, &ec_gen, &dc_gen, false);
+        assert(contexts_is_binary(filename));
+        contexts_load(filename, &ec_load, &dc_load);
+        assert(ec_gen.block_size == ec_load.block_size);
+        assert(dc_gen.block_size == dc_load.block_size);
+        assert(gf4_poly_equal(&ec_gen.second_block_G, &ec_load.second_block_G));
+        assert(gf4_poly_equal(&dc_gen.h0, &dc_load.h0));
+        assert(gf4_poly_equal(&dc_gen.h1, &dc_load.h1));
 
-        gf4_array_deinit(&msg);
-        gf4_array_deinit(&encoded);
+        // cleanup
+        contexts_deinit(&ec_gen, &dc_gen);
+        contexts_deinit(&ec_load, &dc_load);
+        remove(filename);
         test_print_OK();
     }
-
-    // test 2
     {
         test_print_test_number_str("2");
+        // setup
+        const size_t block_size = 211;
+        encoding_context_t ec_gen[3], ec_load;
+        decoding_context_t dc_gen[3], dc_load;
+        char filename[100] = {0};
+        sprintf(filename, "test-file-%lu.bin", (unsigned long) time(NULL));
+        for (size_t i = 0; i < 3; ++i) {
+            contexts_init(&ec_gen[i], &dc_gen[i], block_size, 11);
+            contexts_save_binary(filename, &ec_gen[i], &dc_gen[i], 0 != i);
+        }
 
-        encoding_context_t ec;
-        ec.block_size = 3;
-        ec.second_block_G = gf4_poly_init_zero(ec.block_size);
-        gf4_array_t msg = gf4_array_init(ec.block_size, true);
-        gf4_array_t encoded = gf4_array_init(2 * ec.block_size, true);
-        gf4_poly_set_coefficient(&ec.second_block_G, 0, 2);
-        gf4_poly_set_coefficient(&ec.second_block_G, 1, 1);
-        gf4_poly_set_coefficient(&ec.second_block_G, 2, 3);
+        // test: every record of a multi-key store
+        contexts_store_t store;
+        contexts_store_open(&store, filename);
+        assert(3 == store.num_keys);
+        for (size_t i = 0; i < 3; ++i) {
+            contexts_view_t view;
+            contexts_store_get(&store, i, &view);
+            assert(block_size == view.block_size);
+            assert(view.h0_weight == gf4_array_hamming_weight(&dc_gen[i].h0.coefficients));
+            assert(view.h1_weight == gf4_array_hamming_weight(&dc_gen[i].h1.coefficients));
+            contexts_load_view(&view, &ec_load, &dc_load);
+            assert(gf4_poly_equal(&ec_gen[i].second_block_G, &ec_load.second_block_G));
+            assert(gf4_poly_equal(&dc_gen[i].h0, &dc_load.h0));
+            assert(gf4_poly_equal(&dc_gen[i].h1, &dc_load.h1));
+            contexts_deinit(&ec_load, &dc_load);
+        }
 
-        msg.array[0] = 1;
-        msg.array[2] = 2;
-        enc_encode(&encoded, &msg, &ec);
+        // cleanup
+        contexts_store_close(&store);
+        for (size_t i = 0; i < 3; ++i) {
+            contexts_deinit(&ec_gen[i], &dc_gen[i]);
+        }
+        remove(filename);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("3");
+        // setup
+        const size_t block_size = 2339;
+        const size_t block_weight = 37;
+        encoding_context_t ec_gen, ec_load;
+        decoding_context_t dc_gen, dc_load;
+        contexts_init(&ec_gen, &dc_gen, block_size, block_weight);
+        char txt_filename[100] = {0};
+        char bin_filename[100] = {0};
+        sprintf(txt_filename, "test-file-%lu.txt", (unsigned long) time(NULL));
+        sprintf(bin_filename, "test-file-%lu.bin", (unsigned long) time(NULL));
+
+        // test: text --> binary conversion keeps the key pair
+        contexts_save(txt_filename, &ec_gen, &dc_gen);
+        assert(!contexts_is_binary(txt_filename));
+        contexts_convert_to_binary(txt_filename, bin_filename, false);
+        contexts_load(bin_filename, &ec_load, &dc_load);
+        assert(gf4_poly_equal(&ec_gen.second_block_G, &ec_load.second_block_G));
+        assert(gf4_poly_equal(&dc_gen.h0, &dc_load.h0));
+        assert(gf4_poly_equal(&dc_gen.h1, &dc_load.h1));
+
+        // test: appended conversion adds a second record
+        contexts_convert_to_binary(txt_filename, bin_filename, true);
+        contexts_store_t store;
+        contexts_store_open(&store, bin_filename);
+        assert(2 == store.num_keys);
+        contexts_store_close(&store);
+
+        // cleanup
+        contexts_deinit(&ec_gen, &dc_gen);
+        contexts_deinit(&ec_load, &dc_load);
+        remove(txt_filename);
+        remove(bin_filename);
+        test_print_OK();
+    }
+}
+
+void test_contexts_seed() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 2339;
+        const size_t block_weight = 37;
+        encoding_context_t ec_ref, ec_seed;
+        decoding_context_t dc_ref, dc_seed;
+        random_seed(42);
+        contexts_init(&ec_ref, &dc_ref, block_size, block_weight);
+        contexts_seed_t seed;
+        contexts_seed_from_u64(&seed, 42);
+
+        // test: expansion of the seed gives the same key pair as contexts_init after random_seed,
+        // the random stream of the caller is not affected
+        random_seed(7);
+        uint64_t expected = random_u64();
+        random_seed(7);
+        contexts_init_from_seed(&ec_seed, &dc_seed, &seed, block_size, block_weight, NULL);
+        assert(expected == random_u64());
+        (void)expected;
+        assert(gf4_poly_equal(&ec_ref.second_block_G, &ec_seed.second_block_G));
+        assert(gf4_poly_equal(&dc_ref.h0, &dc_seed.h0));
+        assert(gf4_poly_equal(&dc_ref.h1, &dc_seed.h1));
+
+        // cleanup
+        contexts_deinit(&ec_ref, &dc_ref);
+        contexts_deinit(&ec_seed, &dc_seed);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // setup
+        contexts_seed_t seed, parsed_seed;
+        contexts_seed_random(&seed);
+        char hex[2 * CONTEXTS_SEED_SIZE + 1];
+
+        // test: hex roundtrip, invalid strings
+        contexts_seed_to_hex(&seed, hex);
+        assert(2 * CONTEXTS_SEED_SIZE == strlen(hex));
+        bool parsed = contexts_seed_from_hex(hex, &parsed_seed);
+        assert(parsed);
+        assert(0 == memcmp(seed.bytes, parsed_seed.bytes, CONTEXTS_SEED_SIZE));
+        hex[5] = 'x';
+        parsed = contexts_seed_from_hex(hex, &parsed_seed);
+        assert(!parsed);
+        parsed = contexts_seed_from_hex("0123", &parsed_seed);
+        assert(!parsed);
+        (void)parsed;
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("3");
+        // setup
+        const size_t block_size = 211;
+        const size_t block_weight = 11;
+        contexts_seed_t seeds[3];
+        for (size_t i = 0; i < 3; ++i) {
+            contexts_seed_from_u64(&seeds[i], i + 1);
+        }
+        char filename[100] = {0};
+        char dirname[100] = {0};
+        sprintf(filename, "test-file-%lu.txt", (unsigned long) time(NULL));
+        sprintf(dirname, "test-dir-%lu", (unsigned long) time(NULL));
+
+        // test: seed file roundtrip
+        contexts_seeds_save(filename, seeds, 3, block_size, block_weight);
+        contexts_seed_t * loaded = NULL;
+        size_t num_loaded = 0, loaded_size = 0, loaded_weight = 0;
+        contexts_seeds_load(filename, &loaded, &num_loaded, &loaded_size, &loaded_weight);
+        assert(3 == num_loaded);
+        assert(block_size == loaded_size);
+        assert(block_weight == loaded_weight);
+        assert(0 == memcmp(seeds, loaded, sizeof(seeds)));
+
+        // test: the second expansion is read from the cache and is identical
+        encoding_context_t ec_first, ec_cached;
+        decoding_context_t dc_first, dc_cached;
+        contexts_init_from_seed(&ec_first, &dc_first, &loaded[1], block_size, block_weight, dirname);
+        char hex[2 * CONTEXTS_SEED_SIZE + 1];
+        char cache_filename[300];
+        contexts_seed_to_hex(&loaded[1], hex);
+        sprintf(cache_filename, "%s/seed_%s_%zu_%zu.bin", dirname, hex, block_size, block_weight);
+        assert(contexts_is_binary(cache_filename));
+        contexts_init_from_seed(&ec_cached, &dc_cached, &loaded[1], block_size, block_weight, dirname);
+        assert(gf4_poly_equal(&ec_first.second_block_G, &ec_cached.second_block_G));
+        assert(gf4_poly_equal(&dc_first.h0, &dc_cached.h0));
+        assert(gf4_poly_equal(&dc_first.h1, &dc_cached.h1));
+
+        // cleanup
+        contexts_deinit(&ec_first, &dc_first);
+        contexts_deinit(&ec_cached, &dc_cached);
+        free(loaded);
+        remove(cache_filename);
+        remove(dirname);
+        remove(filename);
+        test_print_OK();
+    }
+}
+
+void test_contexts_invertibility_precheck() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // test: block sizes with exact precheck
+        assert(contexts_has_exact_precheck(2339));
+        assert(contexts_has_exact_precheck(2293));
+        assert(contexts_has_exact_precheck(11));
+        assert(!contexts_has_exact_precheck(7)); // 2 has order 3 modulo 7
+        assert(!contexts_has_exact_precheck(2340));
+        assert(!contexts_has_exact_precheck(1));
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // setup: over GF(4), x^11 + 1 = (x + 1) * f * conj(f) with deg f = 5, so a noticeable part
+        // of random polynomials is divisible by f or conj(f)
+        const size_t block_sizes[2] = {11, 13};
+        random_seed(11);
+
+        // test: the precheck agrees with the inversion
+        for (size_t b = 0; b < 2; ++b) {
+            size_t block_size = block_sizes[b];
+            gf4_poly_t modulus = gf4_poly_init_zero(block_size + 1);
+            gf4_poly_set_coefficient(&modulus, 0, 1);
+            gf4_poly_set_coefficient(&modulus, block_size, 1);
+            gf4_poly_t poly = gf4_poly_init_zero(block_size + 1);
+            gf4_poly_t inverse = gf4_poly_init_zero(2 * (block_size + 1));
+            size_t num_not_invertible = 0;
+            for (size_t i = 0; i < 3000; ++i) {
+                gf4_poly_zero_out(&poly);
+                gf4_poly_zero_out(&inverse);
+                random_gf4_array(&poly.coefficients, block_size);
+                gf4_poly_adjust_degree(&poly, block_size - 1);
+                bool invertible = gf4_poly_invert_slow(&inverse, &poly, &modulus);
+                bool precheck = contexts_invertibility_precheck(&poly, block_size);
+                assert(invertible == precheck);
+                (void)precheck;
+                if (0 != gf4_array_sum(&poly.coefficients) && !invertible) {
+                    ++num_not_invertible;
+                }
+            }
+            assert(0 < num_not_invertible);
+            gf4_poly_deinit(&modulus);
+            gf4_poly_deinit(&poly);
+            gf4_poly_deinit(&inverse);
+        }
+        test_print_OK();
+    }
+}
+
+void test_contexts_init_batch() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 2339;
+        const size_t block_weight = 37;
+        encoding_context_t ec_batch[4];
+        decoding_context_t dc_batch[4];
+        contexts_seed_t seeds[4];
+        for (size_t i = 0; i < 4; ++i) {
+            contexts_seed_from_u64(&seeds[i], 100 + i);
+        }
+
+        // test: the batch gives the same key pairs as expanding every seed separately
+        contexts_init_batch(ec_batch, dc_batch, seeds, 4, block_size, block_weight);
+        for (size_t i = 0; i < 4; ++i) {
+            encoding_context_t ec_ref;
+            decoding_context_t dc_ref;
+            contexts_init_from_seed(&ec_ref, &dc_ref, &seeds[i], block_size, block_weight, NULL);
+            assert(gf4_poly_equal(&ec_ref.second_block_G, &ec_batch[i].second_block_G));
+            assert(gf4_poly_equal(&dc_ref.h0, &dc_batch[i].h0));
+            assert(gf4_poly_equal(&dc_ref.h1, &dc_batch[i].h1));
+            contexts_deinit(&ec_ref, &dc_ref);
+            contexts_deinit(&ec_batch[i], &dc_batch[i]);
+        }
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // setup: block size 7, x^7 + 1 has many factors over GF(4), so some candidates are not invertible
+        const size_t block_size = 7;
+        encoding_context_t ec_batch[16];
+        decoding_context_t dc_batch[16];
+        gf4_poly_t modulus = gf4_poly_init_zero(block_size + 1);
+        gf4_poly_set_coefficient(&modulus, 0, 1);
+        gf4_poly_set_coefficient(&modulus, block_size, 1);
+        random_seed(5);
+
+        // test: G * h1 = h0 mod (x^r + 1) for every key pair
+        contexts_init_batch(ec_batch, dc_batch, NULL, 16, block_size, 3);
+        for (size_t i = 0; i < 16; ++i) {
+            gf4_poly_t product = gf4_poly_init_zero(4 * block_size);
+            gf4_poly_t div = gf4_poly_init_zero(4 * block_size);
+            gf4_poly_t rem = gf4_poly_init_zero(4 * block_size);
+            gf4_poly_mul(&product, &ec_batch[i].second_block_G, &dc_batch[i].h1);
+            gf4_poly_div_rem(&div, &rem, &product, &modulus);
+            assert(gf4_poly_equal(&rem, &dc_batch[i].h0));
+            gf4_poly_deinit(&product);
+            gf4_poly_deinit(&div);
+            gf4_poly_deinit(&rem);
+            contexts_deinit(&ec_batch[i], &dc_batch[i]);
+        }
+        gf4_poly_deinit(&modulus);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("3");
+        // setup: key pair 1 is cached already
+        const size_t block_size = 211;
+        const size_t block_weight = 11;
+        char dirname[100] = {0};
+        sprintf(dirname, "test-dir-%lu", (unsigned long) time(NULL));
+        contexts_seed_t seeds[3];
+        for (size_t i = 0; i < 3; ++i) {
+            contexts_seed_from_u64(&seeds[i], 200 + i);
+        }
+        encoding_context_t ec_batch[3];
+        decoding_context_t dc_batch[3];
+        contexts_init_from_seed(&ec_batch[0], &dc_batch[0], &seeds[1], block_size, block_weight, dirname);
+        contexts_deinit(&ec_batch[0], &dc_batch[0]);
+
+        // test: cached and expanded key pairs equal the ones of contexts_init_from_seed, all of them are cached
+        contexts_init_from_seeds(ec_batch, dc_batch, seeds, 3, block_size, block_weight, dirname);
+        for (size_t i = 0; i < 3; ++i) {
+            encoding_context_t ec_ref;
+            decoding_context_t dc_ref;
+            contexts_init_from_seed(&ec_ref, &dc_ref, &seeds[i], block_size, block_weight, NULL);
+            assert(gf4_poly_equal(&ec_ref.second_block_G, &ec_batch[i].second_block_G));
+            assert(gf4_poly_equal(&dc_ref.h0, &dc_batch[i].h0));
+            assert(gf4_poly_equal(&dc_ref.h1, &dc_batch[i].h1));
+            char hex[2 * CONTEXTS_SEED_SIZE + 1];
+            contexts_seed_to_hex(&seeds[i], hex);
+            char cache_filename[300];
+            sprintf(cache_filename, "%s/seed_%s_%zu_%zu.bin", dirname, hex, block_size, block_weight);
+            assert(contexts_is_binary(cache_filename));
+            remove(cache_filename);
+            contexts_deinit(&ec_ref, &dc_ref);
+            contexts_deinit(&ec_batch[i], &dc_batch[i]);
+        }
+
+        // cleanup
+        remove(dirname);
+        test_print_OK();
+    }
+}
+
+// keypool
+void test_keypool() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 211;
+        const size_t block_weight = 11;
+        const uint64_t seed = 17;
+        keypool_t pool;
+        keypool_init(&pool, seed, 1, 6, block_size, block_weight, NULL, 3, 2);
+
+        // test: key pairs come in order and equal to the ones generated directly
+        for (uint64_t key = 1; key < 6; ++key) {
+            encoding_context_t ec_pool, ec_ref;
+            decoding_context_t dc_pool, dc_ref;
+            keypool_take(&pool, key, &ec_pool, &dc_pool);
+            contexts_seed_t key_seed;
+            contexts_seed_from_u64(&key_seed, random_derive_seed(seed, key, SIM_KEY_STREAM));
+            contexts_init_from_seed(&ec_ref, &dc_ref, &key_seed, block_size, block_weight, NULL);
+            assert(gf4_poly_equal(&ec_ref.second_block_G, &ec_pool.second_block_G));
+            assert(gf4_poly_equal(&dc_ref.h0, &dc_pool.h0));
+            assert(gf4_poly_equal(&dc_ref.h1, &dc_pool.h1));
+            contexts_deinit(&ec_pool, &dc_pool);
+            contexts_deinit(&ec_ref, &dc_ref);
+        }
+        keypool_metrics_t metrics;
+        keypool_get_metrics(&pool, &metrics);
+        assert(5 == metrics.num_generated);
+        assert(5 == metrics.num_taken);
+        assert(0 == metrics.depth);
+        assert(metrics.mean_depth <= 2.0);
+
+        // cleanup
+        keypool_deinit(&pool);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // setup
+        keypool_t pool;
+        keypool_init(&pool, 3, 0, 100, 211, 11, NULL, 2, 4);
+
+        // test: stopping with key pairs left in the queue
+        encoding_context_t ec;
+        decoding_context_t dc;
+        keypool_take(&pool, 0, &ec, &dc);
+        contexts_deinit(&ec, &dc);
+        keypool_metrics_t metrics;
+        keypool_get_metrics(&pool, &metrics);
+        assert(metrics.num_generated <= 1 + 4 + 2);
+        keypool_deinit(&pool);
+        test_print_OK();
+    }
+}
+
+// enc
+void test_enc_encode() {
+    fprintf(stderr, "%s: \n", __func__);
+    // test 1 - encode empty vector
+    {
+        test_print_test_number_str("1");
+        encoding_context_t ec;
+        ec.block_size = 3;
+        ec.arena = NULL;
+        ec.second_block_G = gf4_poly_init_zero(ec.block_size);
+        gf4_array_t msg = gf4_array_init(ec.block_size, true);
+        gf4_array_t encoded = gf4_array_init(2 * ec.block_size, true);
+        gf4_poly_set_coefficient(&ec.second_block_G, 0, 2);
+        gf4_poly_set_coefficient(&ec.second_block_G, 1, 1);
+        gf4_poly_set_coefficient(&ec.second_block_G, 2, 3);
+
+        enc_encode(&encoded, &msg, &ec);
+        assert(2 == ec.second_block_G.coefficients.array[0]);
+        assert(1 == ec.second_block_G.coefficients.array[1]);
+        assert(3 == ec.second_block_G.coefficients.array[2]);
+        assert(3 == ec.block_size);
+        assert(3 == ec.second_block_G.coefficients.capacity);
+        assert(6 == encoded.capacity);
+        for (size_t i = 0; i < 6; ++i) assert(0 == encoded.array[i]);
+
+        gf4_array_deinit(&msg);
+        gf4_array_deinit(&encoded);
+        test_print_OK();
+    }
+
+    // test 2
+    {
+        test_print_test_number_str("2");
+
+        encoding_context_t ec;
+        ec.block_size = 3;
+        ec.arena = NULL;
+        ec.second_block_G = gf4_poly_init_zero(ec.block_size);
+        gf4_array_t msg = gf4_array_init(ec.block_size, true);
+        gf4_array_t encoded = gf4_array_init(2 * ec.block_size, true);
+        gf4_poly_set_coefficient(&ec.second_block_G, 0, 2);
+        gf4_poly_set_coefficient(&ec.second_block_G, 1, 1);
+        gf4_poly_set_coefficient(&ec.second_block_G, 2, 3);
+
+        msg.array[0] = 1;
+        msg.array[2] = 2;
+        enc_encode(&encoded, &msg, &ec);
         assert(2 == ec.second_block_G.coefficients.array[0]);
         assert(1 == ec.second_block_G.coefficients.array[1]);
         assert(3 == ec.second_block_G.coefficients.array[2]);
@@ -1540,6 +2578,7 @@ void test_enc_encrypt() {
     // setup
     encoding_context_t ec;
     ec.block_size = 3;
+    ec.arena = NULL;
     ec.second_block_G = gf4_poly_init_zero(ec.block_size);
     gf4_array_t msg = gf4_array_init(ec.block_size, true);
     gf4_array_t encoded = gf4_array_init(2 * ec.block_size, true);
@@ -1576,6 +2615,34 @@ void test_enc_encrypt() {
     gf4_array_deinit(&encrypted);
 }
 
+void test_enc_add_error() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        encoding_context_t ec;
+        ec.block_size = 3;
+        ec.arena = NULL;
+        gf4_array_t encoded = gf4_array_init(2 * ec.block_size, true);
+        gf4_array_t error = gf4_array_init(2 * ec.block_size, true);
+        gf4_array_t encrypted = gf4_array_init(2 * ec.block_size, true);
+        gf4_t encoded_values[] = {1, 2, 3, 0, 1, 2};
+        gf4_t error_values[] = {0, 3, 0, 2, 0, 0};
+        gf4_t expected[] = {1, 1, 3, 2, 1, 2};
+        memcpy(encoded.array, encoded_values, 6);
+        memcpy(error.array, error_values, 6);
+        enc_add_error(&encrypted, &encoded, &error, &ec);
+        assert(test_compare_coeffs(encrypted.array, expected, 6));
+        // inplace
+        enc_add_error(&encoded, &encoded, &error, &ec);
+        assert(test_compare_coeffs(encoded.array, expected, 6));
+        (void)expected;
+        gf4_array_deinit(&encoded);
+        gf4_array_deinit(&error);
+        gf4_array_deinit(&encrypted);
+        test_print_OK();
+    }
+}
+
 
 // dec
 void test_dec_calculate_syndrome() {
@@ -1586,6 +2653,7 @@ void test_dec_calculate_syndrome() {
         test_print_test_number_str("1");
         decoding_context_t dc;
         dc.block_size = 3;
+        dc.arena = NULL;
         dc.h0 = gf4_poly_init_zero(dc.block_size);
         dc.h1 = gf4_poly_init_zero(dc.block_size);
         gf4_poly_set_coefficient(&dc.h0, 0, 1);
@@ -1625,6 +2693,7 @@ void test_dec_calculate_syndrome() {
         test_print_test_number_str("2");
         decoding_context_t dc;
         dc.block_size = 3;
+        dc.arena = NULL;
         dc.h0 = gf4_poly_init_zero(dc.block_size);
         dc.h1 = gf4_poly_init_zero(dc.block_size);
         gf4_poly_set_coefficient(&dc.h0, 0, 1);
@@ -1667,6 +2736,1052 @@ void test_dec_calculate_syndrome() {
     }
 }
 
+void test_dec_arena() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 2339;
+        const size_t block_weight = 37;
+        const size_t num_errors = 20;
+        const size_t num_iterations = 5;
+        encoding_context_t ec;
+        decoding_context_t dc;
+        contexts_seed_t seed;
+        contexts_seed_from_u64(&seed, 11);
+        contexts_init_from_seed(&ec, &dc, &seed, block_size, block_weight, NULL);
+        gf4_arena_t arena;
+        gf4_arena_init(&arena, 0);
+        gf4_array_t message = gf4_array_init(block_size, true);
+        gf4_array_t encrypted = gf4_array_init(2 * block_size, true);
+        gf4_array_t encrypted_arena = gf4_array_init(2 * block_size, true);
+        gf4_array_t decoded = gf4_array_init(2 * block_size, true);
+        gf4_array_t decoded_arena = gf4_array_init(2 * block_size, true);
+        bool (*decoders[3])(gf4_array_t *, gf4_array_t *, size_t, decoding_context_t *) = {
+            &dec_decode_symbol_flipping, &dec_decode_symbol_flipping_delta, &dec_decode_symbol_flipping_threshold
+        };
+        dc.delta_setting = 0;
+        dc.threshold = &dec_calculate_threshold_0;
+        random_seed(3);
+        random_gf4_array(&message, block_size);
+
+        // test: the encoder and the decoders give the same results with and without an arena,
+        // and release their temporaries
+        random_seed(5);
+        ec.arena = NULL;
+        enc_encrypt(&encrypted, &message, num_errors, &ec);
+        random_seed(5);
+        ec.arena = &arena;
+        gf4_arena_mark_t mark = gf4_arena_mark(&arena);
+        enc_encrypt(&encrypted_arena, &message, num_errors, &ec);
+        assert(0 == memcmp(encrypted.array, encrypted_arena.array, 2 * block_size));
+        for (size_t d = 0; d < 3; ++d) {
+            dc.arena = NULL;
+            bool success = decoders[d](&decoded, &encrypted, num_iterations, &dc);
+            size_t elapsed_iterations = dc.elapsed_iterations;
+            dc.arena = &arena;
+            bool success_arena = decoders[d](&decoded_arena, &encrypted, num_iterations, &dc);
+            assert(success == success_arena);
+            assert(elapsed_iterations == dc.elapsed_iterations);
+            assert(0 == memcmp(decoded.array, decoded_arena.array, 2 * block_size));
+            gf4_arena_mark_t after = gf4_arena_mark(&arena);
+            assert(mark.block == after.block && mark.used == after.used);
+            (void)success; (void)elapsed_iterations; (void)success_arena; (void)after;
+        }
+        (void)mark;
+
+        // cleanup
+        gf4_array_deinit(&message);
+        gf4_array_deinit(&encrypted);
+        gf4_array_deinit(&encrypted_arena);
+        gf4_array_deinit(&decoded);
+        gf4_array_deinit(&decoded_arena);
+        gf4_arena_deinit(&arena);
+        contexts_deinit(&ec, &dc);
+        test_print_OK();
+    }
+}
+
+// random
+void test_random_seed() {
+    fprintf(stderr, "%s: \n", __func__);
+    // test 1 - same seed, same sequence
+    {
+        test_print_test_number_str("1");
+        gf4_array_t first = gf4_array_init(100, true);
+        gf4_array_t second = gf4_array_init(100, true);
+        random_seed(42);
+        random_weighted_gf4_array(&first, 100, 10);
+        random_seed(42);
+        random_weighted_gf4_array(&second, 100, 10);
+        assert(test_compare_coeffs(first.array, second.array, 100));
+        assert(10 == gf4_array_hamming_weight(&first));
+        gf4_array_deinit(&first);
+        gf4_array_deinit(&second);
+        test_print_OK();
+    }
+    // test 2 - derived seeds
+    {
+        test_print_test_number_str("2");
+        assert(random_derive_seed(1, 2, 3) == random_derive_seed(1, 2, 3));
+        assert(random_derive_seed(1, 2, 3) != random_derive_seed(1, 3, 2));
+        assert(random_derive_seed(1, 2, 3) != random_derive_seed(2, 2, 3));
+        assert(random_derive_seed(1, 0, 0) != random_derive_seed(1, 0, 1));
+        test_print_OK();
+    }
+    // test 3 - restored state continues the same sequence
+    {
+        test_print_test_number_str("3");
+        random_state_t state;
+        random_seed(7);
+        random_u64();
+        random_get_state(&state);
+        uint64_t first = random_u64();
+        uint64_t second = random_u64();
+        random_seed(8);
+        random_set_state(&state);
+        assert(first == random_u64());
+        assert(second == random_u64());
+        (void)first; (void)second;
+        test_print_OK();
+    }
+}
+
+void test_random_error_positions() {
+    fprintf(stderr, "%s: \n", __func__);
+    for (size_t t = 0; t < 5; ++t) {
+        test_print_test_number_int(t);
+        size_t positions[20];
+        gf4_t values[20];
+        random_error_positions(positions, values, 20, 20);
+        bool seen[20] = {false};
+        for (size_t i = 0; i < 20; ++i) {
+            assert(positions[i] < 20);
+            assert(!seen[positions[i]]);
+            assert(0 != values[i] && GF4_MAX_VALUE >= values[i]);
+            seen[positions[i]] = true;
+        }
+        (void)seen;
+        // prefix of a longer sequence with the same seed
+        size_t prefix[5];
+        gf4_t prefix_values[5];
+        random_seed(t);
+        random_error_positions(positions, values, 100, 20);
+        random_seed(t);
+        random_error_positions(prefix, prefix_values, 100, 5);
+        for (size_t i = 0; i < 5; ++i) {
+            assert(prefix[i] == positions[i]);
+        }
+        test_print_OK();
+    }
+}
+
+// sim
+void test_sim_parse_shard() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        size_t index = 0, count = 0;
+        assert(sim_parse_shard("0/1", &index, &count));
+        assert(0 == index && 1 == count);
+        assert(sim_parse_shard("3/8", &index, &count));
+        assert(3 == index && 8 == count);
+        assert(!sim_parse_shard("8/8", &index, &count));
+        assert(!sim_parse_shard("0/0", &index, &count));
+        assert(!sim_parse_shard("1", &index, &count));
+        assert(!sim_parse_shard("1/", &index, &count));
+        assert(!sim_parse_shard("/2", &index, &count));
+        assert(!sim_parse_shard("1/2x", &index, &count));
+        (void)index; (void)count;
+        test_print_OK();
+    }
+}
+
+void test_sim_shard_range() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        sim_params_t params;
+        params.num_keys = 7;
+        params.num_messages = 13;
+        params.shard_count = 5;
+        uint64_t expected_begin = 0;
+        for (size_t i = 0; i < params.shard_count; ++i) {
+            uint64_t begin, end;
+            params.shard_index = i;
+            sim_shard_range(&params, &begin, &end);
+            assert(expected_begin == begin);
+            assert(begin <= end);
+            assert(end - begin >= 18 && end - begin <= 19);
+            expected_begin = end;
+        }
+        assert(7 * 13 == expected_begin);
+        (void)expected_begin;
+        test_print_OK();
+    }
+}
+
+void test_sim_result_save_load_merge() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        sim_params_t params;
+        params.num_keys = 2;
+        params.num_messages = 3;
+        params.block_size = 11;
+        params.block_weight = 3;
+        params.num_errors = 2;
+        params.num_iterations = 5;
+        params.decoder = 3;
+        params.opt = 2;
+        params.seed = 1234;
+        params.shard_count = 2;
+        params.rerun_failures = false;
+
+        sim_result_t first, second, loaded;
+        params.shard_index = 0;
+        sim_result_init(&first, &params);
+        params.shard_index = 1;
+        sim_result_init(&second, &params);
+        assert(0 == first.trial_begin && 3 == first.trial_end);
+        assert(3 == second.trial_begin && 6 == second.trial_end);
+        // the first shard was stopped early after 2 of its 3 trials
+        first.num_trials = 2;
+        first.num_failures = 1;
+        first.num_run_trials = 2;
+        first.stopped_early = true;
+        first.iterations[2] = 1;
+        second.num_trials = 3;
+        second.num_failures = 0;
+        second.num_run_trials = 3;
+        second.iterations[2] = 1;
+        second.iterations[5] = 2;
+
+        char filename[100] = {0};
+        sprintf(filename, "test-sim-%lu.bin", (unsigned long) time(NULL));
+        sim_result_save(filename, &second);
+        sim_result_load(filename, &loaded);
+        remove(filename);
+        assert(3 == loaded.trial_begin && 6 == loaded.trial_end);
+        assert(1 == loaded.params.shard_index && 2 == loaded.params.shard_count);
+        assert(1234 == loaded.params.seed);
+        assert(3 == loaded.num_trials && 0 == loaded.num_failures);
+        assert(3 == loaded.num_run_trials && !loaded.stopped_early);
+        assert(1 == loaded.iterations[2] && 2 == loaded.iterations[5]);
+
+        // second shard must follow the first one, the shard stopped early flags the merged result
+        assert(!sim_result_merge(&loaded, &first));
+        assert(sim_result_merge(&first, &loaded));
+        assert(0 == first.trial_begin && 6 == first.trial_end);
+        assert(5 == first.num_trials && 1 == first.num_failures);
+        assert(5 == first.num_run_trials && first.stopped_early);
+        assert(2 == first.iterations[2] && 2 == first.iterations[5]);
+
+        // the flag survives saving
+        sim_result_t merged;
+        sim_result_save(filename, &first);
+        sim_result_load(filename, &merged);
+        remove(filename);
+        assert(5 == merged.num_run_trials && merged.stopped_early);
+        sim_result_deinit(&merged);
+
+        // results of a different simulation can't be merged
+        second.params.seed = 4321;
+        second.trial_begin = 6;
+        assert(!sim_result_merge(&first, &second));
+
+        sim_result_deinit(&first);
+        sim_result_deinit(&second);
+        sim_result_deinit(&loaded);
+        test_print_OK();
+    }
+}
+
+void test_sim_checkpoint_resume() {
+    fprintf(stderr, "%s: \n", __func__);
+    sim_params_t params;
+    params.num_keys = 1;
+    params.num_messages = 2;
+    params.block_size = 2339;
+    params.block_weight = 37;
+    params.num_errors = 84;
+    params.num_iterations = 20;
+    params.decoder = 2;
+    params.opt = 3;
+    params.seed = 99;
+    params.shard_index = 0;
+    params.shard_count = 1;
+    params.rerun_failures = false;
+    char filename[100] = {0};
+    sprintf(filename, "test-checkpoint-%lu.bin", (unsigned long) time(NULL));
+    // test 1 - checkpoint save, load
+    {
+        test_print_test_number_str("1");
+        sim_result_t result, loaded;
+        sim_result_init(&result, &params);
+        result.num_trials = 2;
+        result.num_failures = 1;
+        result.iterations[3] = 1;
+        random_state_t state = {{1, 2, 3, 4}};
+        random_state_t loaded_state;
+        uint64_t next_trial;
+        bool continue_stream;
+        sim_checkpoint_save(filename, &result, 2, true, &state);
+        sim_checkpoint_load(filename, &loaded, &next_trial, &continue_stream, &loaded_state);
+        assert(2 == next_trial && continue_stream);
+        assert(0 == memcmp(&state, &loaded_state, sizeof(random_state_t)));
+        assert(99 == loaded.params.seed);
+        assert(2 == loaded.num_trials && 1 == loaded.num_failures && 1 == loaded.iterations[3]);
+        sim_result_deinit(&result);
+        sim_result_deinit(&loaded);
+        test_print_OK();
+    }
+    // test 2 - resumed run gives the same result as an uninterrupted one
+    {
+        test_print_test_number_str("2");
+        sim_options_t options;
+        sim_options_init(&options);
+        sim_result_t full, half, resumed;
+        sim_result_init(&full, &params);
+        sim_run(&params, &options, &full);
+
+        // first half of the trials, as if the run was killed after trial 1
+        params.shard_count = 2;
+        sim_result_init(&half, &params);
+        sim_run(&params, &options, &half);
+        params.shard_count = 1;
+        sim_result_t checkpoint;
+        sim_result_init(&checkpoint, &params);
+        checkpoint.num_trials = half.num_trials;
+        checkpoint.num_failures = half.num_failures;
+        memcpy(checkpoint.iterations, half.iterations, (params.num_iterations + 1) * sizeof(uint64_t));
+        random_state_t state;
+        random_get_state(&state);
+        sim_checkpoint_save(filename, &checkpoint, half.trial_end, false, &state);
+
+        // resume with a different seed, the one from the checkpoint must be used
+        params.seed = 100;
+        options.checkpoint_filename = filename;
+        options.resume = true;
+        sim_result_init(&resumed, &params);
+        sim_run(&params, &options, &resumed);
+        remove(filename);
+        assert(99 == params.seed);
+        assert(full.num_trials == resumed.num_trials);
+        assert(full.num_failures == resumed.num_failures);
+        assert(0 == memcmp(full.iterations, resumed.iterations, (params.num_iterations + 1) * sizeof(uint64_t)));
+        sim_result_deinit(&full);
+        sim_result_deinit(&half);
+        sim_result_deinit(&checkpoint);
+        sim_result_deinit(&resumed);
+        test_print_OK();
+    }
+}
+
+void test_sim_wilson_interval() {
+    fprintf(stderr, "%s: \n", __func__);
+    double low, high;
+    // test 1 - no failures, the upper bound is z^2 / (n + z^2)
+    {
+        test_print_test_number_str("1");
+        sim_wilson_interval(0, 100, SIM_WILSON_Z, &low, &high);
+        assert(low < 1e-12);
+        assert(fabs(high - 0.036994) < 1e-5);
+        test_print_OK();
+    }
+    // test 2 - 10 failures out of 100
+    {
+        test_print_test_number_str("2");
+        sim_wilson_interval(10, 100, SIM_WILSON_Z, &low, &high);
+        assert(fabs(low - 0.055229) < 1e-5);
+        assert(fabs(high - 0.174366) < 1e-5);
+        test_print_OK();
+    }
+    // test 3 - stopping rules
+    {
+        test_print_test_number_str("3");
+        sim_params_t params;
+        params.num_keys = 10;
+        params.num_messages = 100;
+        params.num_iterations = 1;
+        params.shard_index = 0;
+        params.shard_count = 1;
+        sim_result_t result;
+        sim_result_init(&result, &params);
+        sim_options_t options;
+        sim_options_init(&options);
+        result.num_trials = 200;
+        result.num_failures = 100;
+        assert(!sim_should_stop(&result, &options));
+        options.stop_threshold = 0.1;
+        assert(sim_should_stop(&result, &options));
+        options.stop_threshold = 0.5;
+        assert(!sim_should_stop(&result, &options));
+        options.stop_width = 0.1;
+        assert(!sim_should_stop(&result, &options));
+        result.num_trials = 1000;
+        result.num_failures = 500;
+        assert(sim_should_stop(&result, &options));
+        options.stop_min_trials = 2000;
+        assert(!sim_should_stop(&result, &options));
+        sim_result_deinit(&result);
+        test_print_OK();
+    }
+}
+
+// sweep
+void test_sweep_parse() {
+    fprintf(stderr, "%s: \n", __func__);
+    // test 1 - error counts
+    {
+        test_print_test_number_str("1");
+        size_t * values = NULL;
+        size_t count = 0;
+        bool parsed = sweep_parse_error_counts("84,86,88", &values, &count);
+        assert(parsed);
+        assert(3 == count && 84 == values[0] && 86 == values[1] && 88 == values[2]);
+        free(values);
+        parsed = sweep_parse_error_counts("84", &values, &count);
+        assert(parsed);
+        assert(1 == count && 84 == values[0]);
+        free(values);
+        assert(!sweep_parse_error_counts("", &values, &count));
+        assert(!sweep_parse_error_counts("84,", &values, &count));
+        assert(!sweep_parse_error_counts("84;86", &values, &count));
+        assert(!sweep_parse_error_counts("0", &values, &count));
+        (void)parsed;
+        test_print_OK();
+    }
+    // test 2 - configurations
+    {
+        test_print_test_number_str("2");
+        sweep_config_t * configs = NULL;
+        size_t count = 0;
+        bool parsed = sweep_parse_configs("2:3,3:0,0:0", &configs, &count);
+        assert(parsed);
+        assert(3 == count);
+        assert(2 == configs[0].decoder && 3 == configs[0].opt);
+        assert(3 == configs[1].decoder && 0 == configs[1].opt);
+        assert(0 == configs[2].decoder && 0 == configs[2].opt);
+        free(configs);
+        assert(!sweep_parse_configs("2", &configs, &count));
+        assert(!sweep_parse_configs("2:3,", &configs, &count));
+        assert(!sweep_parse_configs("3:6", &configs, &count));
+        assert(!sweep_parse_configs("1:0", &configs, &count));
+        (void)parsed;
+        test_print_OK();
+    }
+}
+
+// report
+void test_report_sink() {
+    fprintf(stderr, "%s: \n", __func__);
+    char filename[100] = {0};
+    sprintf(filename, "test-records-%lu.bin", (unsigned long) time(NULL));
+    report_record_t first = {1, 2, 84, 3, 5, 7, true, 1500};
+    report_record_t second = {1, 3, 84, 3, 5, 200, false, 2000000000};
+    // test 1 - formats
+    {
+        test_print_test_number_str("1");
+        report_format_t format;
+        assert(report_parse_format("csv", &format) && REPORT_FORMAT_CSV == format);
+        assert(report_parse_format("jsonl", &format) && REPORT_FORMAT_JSONL == format);
+        assert(report_parse_format("binary", &format) && REPORT_FORMAT_BINARY == format);
+        assert(!report_parse_format("json", &format));
+        (void)format;
+        test_print_OK();
+    }
+    // test 2 - binary records, appending does not repeat the header
+    {
+        test_print_test_number_str("2");
+        report_sink_t sink;
+        report_sink_open(&sink, filename, REPORT_FORMAT_BINARY, false);
+        report_sink_write(&sink, &first);
+        report_sink_close(&sink);
+        report_sink_open(&sink, filename, REPORT_FORMAT_BINARY, true);
+        report_sink_write(&sink, &second);
+        report_sink_close(&sink);
+
+        FILE * file = fopen(filename, "rb");
+        report_record_t record;
+        assert(report_read_binary_header(file));
+        assert(report_read_binary_record(file, &record));
+        assert(1 == record.key && 2 == record.message && 84 == record.num_errors && 3 == record.decoder);
+        assert(5 == record.opt && 7 == record.iterations && record.success && 1500 == record.nanoseconds);
+        assert(report_read_binary_record(file, &record));
+        assert(3 == record.message && 200 == record.iterations && !record.success && 2000000000 == record.nanoseconds);
+        assert(!report_read_binary_record(file, &record));
+        (void)record;
+        fclose(file);
+        remove(filename);
+        test_print_OK();
+    }
+    // test 3 - CSV and JSON lines
+    {
+        test_print_test_number_str("3");
+        report_format_t formats[] = {REPORT_FORMAT_CSV, REPORT_FORMAT_JSONL};
+        const char * expected[] = {
+                "key,message,num_errors,decoder,opt,iterations,success,seconds\n"
+                "1,2,84,3,5,7,1,0.000001500\n"
+                "1,3,84,3,5,200,0,2.000000000\n",
+                "{\"key\":1,\"message\":2,\"num_errors\":84,\"decoder\":3,\"opt\":5,\"iterations\":7,\"success\":true,\"seconds\":0.000001500}\n"
+                "{\"key\":1,\"message\":3,\"num_errors\":84,\"decoder\":3,\"opt\":5,\"iterations\":200,\"success\":false,\"seconds\":2.000000000}\n"
+        };
+        for (size_t i = 0; i < 2; ++i) {
+            report_sink_t sink;
+            report_sink_open(&sink, filename, formats[i], false);
+            report_sink_write(&sink, &first);
+            report_sink_write(&sink, &second);
+            report_sink_close(&sink);
+            char content[1000] = {0};
+            FILE * file = fopen(filename, "r");
+            size_t length = fread(content, 1, sizeof(content) - 1, file);
+            fclose(file);
+            remove(filename);
+            assert(strlen(expected[i]) == length);
+            assert(0 == strcmp(expected[i], content));
+            (void)length;
+        }
+        (void)expected;
+        test_print_OK();
+    }
+}
+
+// corpus
+void test_corpus() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        char dirname[100] = {0};
+        sprintf(dirname, "test-corpus-%lu", (unsigned long) time(NULL));
+        encoding_context_t ec;
+        decoding_context_t dc;
+        random_seed(3);
+        contexts_init(&ec, &dc, 2339, 37);
+
+        // a trivially decodable error vector and one with all symbols
+        corpus_entry_t first = {7, 1, 2, 2339, 1, 2, 3, 20, gf4_array_init(2 * 2339, true)};
+        first.error.array[5] = 2;
+        corpus_entry_t second = {7, 1, 3, 2339, 2 * 2339, 0, 0, 20, gf4_array_init(2 * 2339, true)};
+        random_gf4_array(&second.error, 2 * 2339);
+        corpus_t corpus;
+        corpus_open(&corpus, dirname);
+        corpus_add(&corpus, &first, &ec, &dc);
+        corpus_add(&corpus, &second, &ec, &dc);
+        assert(2 == corpus.num_entries);
+        corpus_close(&corpus);
+
+        corpus_reader_t reader;
+        corpus_entry_t entry;
+        corpus_reader_open(&reader, dirname);
+        bool read = corpus_reader_next(&reader, &entry);
+        assert(read);
+        assert(7 == entry.seed && 1 == entry.key && 2 == entry.message && 2339 == entry.block_size);
+        assert(1 == entry.num_errors && 2 == entry.decoder && 3 == entry.opt && 20 == entry.num_iterations);
+        assert(test_compare_coeffs(entry.error.array, first.error.array, 2 * 2339));
+        corpus_entry_deinit(&entry);
+        read = corpus_reader_next(&reader, &entry);
+        assert(read);
+        assert(3 == entry.message);
+        assert(test_compare_coeffs(entry.error.array, second.error.array, 2 * 2339));
+        corpus_entry_deinit(&entry);
+        read = corpus_reader_next(&reader, &entry);
+        assert(!read);
+        (void)read;
+        corpus_reader_close(&reader);
+
+        // a single error is always corrected
+        sim_replay_result_t result;
+        sim_replay(dirname, 2, 3, 0, NULL, &result);
+        assert(2 == result.num_entries);
+        assert(1 == result.num_successes);
+
+        char path[CORPUS_PATH_LENGTH];
+        corpus_key_path(path, dirname, 7, 1);
+        remove(path);
+        snprintf(path, CORPUS_PATH_LENGTH, "%s/%s", dirname, CORPUS_FAILURES_FILENAME);
+        remove(path);
+        remove(dirname);
+        gf4_array_deinit(&first.error);
+        gf4_array_deinit(&second.error);
+        contexts_deinit(&ec, &dc);
+        test_print_OK();
+    }
+}
+
+// gjs
+static void test_gjs_random_key(decoding_context_t * dc, size_t block_size, size_t block_weight) {
+    dc->block_size = block_size;
+    dc->h0 = gf4_poly_init_zero(block_size);
+    dc->h1 = gf4_poly_init_zero(block_size);
+    random_weighted_gf4_array(&dc->h0.coefficients, block_size, block_weight);
+    random_weighted_gf4_array(&dc->h1.coefficients, block_size, block_weight);
+}
+
+void test_gjs_syndrome() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 37;
+        const size_t num_errors = 12;
+        decoding_context_t dc;
+        test_gjs_random_key(&dc, block_size, 7);
+        gjs_support_t h0 = gjs_support_init(block_size);
+        gjs_support_t h1 = gjs_support_init(block_size);
+        gjs_support_from_array(&h0, &dc.h0.coefficients, 0, block_size);
+        gjs_support_from_array(&h1, &dc.h1.coefficients, 0, block_size);
+        assert(7 == h0.weight && 7 == h1.weight);
+        gjs_support_t e0 = gjs_support_init(num_errors);
+        gjs_support_t e1 = gjs_support_init(num_errors);
+        size_t positions[12];
+        gf4_t values[12];
+        gf4_array_t error = gf4_array_init(2 * block_size, true);
+        gf4_array_t expected = gf4_array_init(block_size, true);
+        gf4_array_t syndrome = gf4_array_init(block_size, true);
+
+        // test: same syndrome and weight as dec_calculate_syndrome, sorted supports
+        for (size_t trial = 0; trial < 100; ++trial) {
+            random_error_positions(positions, values, 2 * block_size, num_errors);
+            gjs_support_split(&e0, &e1, positions, values, num_errors, block_size);
+            assert(num_errors == e0.weight + e1.weight);
+            for (size_t i = 1; i < e0.weight; ++i) {
+                assert(e0.positions[i - 1] < e0.positions[i]);
+            }
+            for (size_t i = 1; i < e1.weight; ++i) {
+                assert(e1.positions[i - 1] < e1.positions[i]);
+            }
+            gf4_array_zero_out(&error);
+            for (size_t i = 0; i < num_errors; ++i) {
+                error.array[positions[i]] = values[i];
+            }
+            dec_calculate_syndrome(&expected, &error, &dc);
+            gf4_array_zero_out(&syndrome);
+            size_t weight = gjs_syndrome(&syndrome, &e0, &e1, &h0, &h1, block_size);
+            assert(gf4_array_hamming_weight(&expected) == weight);
+            for (size_t i = 0; i < block_size; ++i) {
+                assert(expected.array[i] == syndrome.array[i]);
+            }
+            (void)weight;
+        }
+
+        // cleanup
+        gf4_array_deinit(&syndrome);
+        gf4_array_deinit(&expected);
+        gf4_array_deinit(&error);
+        gjs_support_deinit(&e1);
+        gjs_support_deinit(&e0);
+        gjs_support_deinit(&h1);
+        gjs_support_deinit(&h0);
+        gf4_poly_deinit(&dc.h0);
+        gf4_poly_deinit(&dc.h1);
+        test_print_OK();
+    }
+}
+
+void test_gjs_spectrum_add_sample() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 31;
+        const size_t num_errors = 24;
+        gjs_spectrum_t spectrum;
+        gjs_spectrum_init(&spectrum, block_size, num_errors, 0);
+        assert(16 == spectrum.num_distances);
+        uint64_t expected_weights[GJS_NUM_CLASSES][16] = {{0}};
+        uint64_t expected_attempts[GJS_NUM_CLASSES][16] = {{0}};
+        uint64_t expected_squares[GJS_NUM_CLASSES][16] = {{0}};
+        bool * written_to = calloc(GJS_NUM_CLASSES * spectrum.num_distances, sizeof(bool));
+        gjs_support_t e0 = gjs_support_init(block_size);
+        gjs_support_t e1 = gjs_support_init(block_size);
+        gf4_array_t error = gf4_array_init(2 * block_size, true);
+
+        // test: pairs of the supports are counted as by the scan of all pairs of positions
+        for (size_t sample = 0; sample < 50; ++sample) {
+            gf4_array_zero_out(&error);
+            random_weighted_gf4_array(&error, 2 * block_size, num_errors);
+            gjs_support_from_array(&e0, &error, 0, block_size);
+            gjs_support_from_array(&e1, &error, block_size, block_size);
+            gjs_spectrum_add_sample(&spectrum, &e0, &e1, sample, written_to);
+            for (size_t half = 0; half < 2; ++half) {
+                bool seen[GJS_NUM_CLASSES][16] = {{false}};
+                gf4_t * e = error.array + half * block_size;
+                for (size_t i = 0; i < block_size; ++i) {
+                    for (size_t j = i + 1; j < block_size; ++j) {
+                        if (0 == e[i] || 0 == e[j]) {
+                            continue;
+                        }
+                        size_t distance = (j - i) < 16 ? (j - i) : (block_size - (j - i));
+                        size_t c;
+                        if (e[i] == e[j]) {
+                            c = gjs_class_index(GJS_RELATION_SAME, half);
+                        } else if ((1 == e[i] && 2 == e[j]) || (2 == e[i] && 3 == e[j]) || (3 == e[i] && 1 == e[j])) {
+                            c = gjs_class_index(GJS_RELATION_ALPHA_RIGHT, half);
+                        } else {
+                            c = gjs_class_index(GJS_RELATION_ALPHA_LEFT, half);
+                        }
+                        if (!seen[c][distance]) {
+                            expected_weights[c][distance] += sample;
+                            expected_attempts[c][distance] += 1;
+                            expected_squares[c][distance] += sample * sample;
+                            seen[c][distance] = true;
+                        }
+                    }
+                }
+            }
+        }
+        assert(50 == spectrum.num_samples);
+        for (size_t c = 0; c < GJS_NUM_CLASSES; ++c) {
+            assert(0 == spectrum.attempts[c * spectrum.num_distances]);
+            for (size_t d = 0; d < spectrum.num_distances; ++d) {
+                assert(expected_weights[c][d] == spectrum.weights[c * spectrum.num_distances + d]);
+                assert(expected_attempts[c][d] == spectrum.attempts[c * spectrum.num_distances + d]);
+                assert(expected_squares[c][d] == spectrum.squares[c * spectrum.num_distances + d]);
+            }
+        }
+        for (size_t i = 0; i < GJS_NUM_CLASSES * spectrum.num_distances; ++i) {
+            assert(!written_to[i]);
+        }
+
+        // cleanup
+        gf4_array_deinit(&error);
+        gjs_support_deinit(&e1);
+        gjs_support_deinit(&e0);
+        free(written_to);
+        gjs_spectrum_deinit(&spectrum);
+        test_print_OK();
+    }
+}
+
+void test_gjs_collect() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 101;
+        const size_t num_errors = 20;
+        const uint64_t seed = 5;
+        decoding_context_t dc;
+        test_gjs_random_key(&dc, block_size, 9);
+        uint64_t fingerprint = gjs_key_fingerprint(&dc);
+        gjs_spectrum_t serial, parallel, other;
+        gjs_spectrum_init(&serial, block_size, num_errors, fingerprint);
+        gjs_spectrum_init(&parallel, block_size, num_errors, fingerprint);
+        gjs_spectrum_init(&other, 103, num_errors, fingerprint);
+
+        // test: the result depends neither on the number of threads nor on the ranges
+        gjs_collect(&serial, &dc, seed, 0, 50, 1);
+        gjs_collect(&parallel, &dc, seed, 0, 20, 3);
+        gjs_collect(&parallel, &dc, seed, 20, 50, 4);
+        assert(50 == serial.num_samples);
+        assert(50 == parallel.num_samples);
+        uint64_t num_attempts = 0;
+        for (size_t i = 0; i < GJS_NUM_CLASSES * serial.num_distances; ++i) {
+            assert(serial.weights[i] == parallel.weights[i]);
+            assert(serial.attempts[i] == parallel.attempts[i]);
+            assert(serial.squares[i] == parallel.squares[i]);
+            num_attempts += serial.attempts[i];
+        }
+        assert(0 < num_attempts);
+        bool merged = gjs_spectrum_merge(&serial, &other);
+        assert(!merged);
+        (void)merged;
+
+        // cleanup
+        gjs_spectrum_deinit(&other);
+        gjs_spectrum_deinit(&parallel);
+        gjs_spectrum_deinit(&serial);
+        gf4_poly_deinit(&dc.h0);
+        gf4_poly_deinit(&dc.h1);
+        test_print_OK();
+    }
+    {
+        test_print_test_number_str("2");
+        // setup
+        const size_t block_size = 101;
+        const size_t num_errors = 20;
+        decoding_context_t dc;
+        test_gjs_random_key(&dc, block_size, 9);
+        gjs_spectrum_t spectrum, expected;
+        gjs_spectrum_init(&spectrum, block_size, num_errors, gjs_key_fingerprint(&dc));
+        gjs_spectrum_init(&expected, block_size, num_errors, gjs_key_fingerprint(&dc));
+
+        // test: sample 7 is generated from its own stream
+        gjs_collect(&spectrum, &dc, 11, 7, 8, 2);
+        random_seed(random_derive_seed(11, 7, GJS_SAMPLE_STREAM));
+        size_t positions[20];
+        gf4_t values[20];
+        random_error_positions(positions, values, 2 * block_size, num_errors);
+        gf4_array_t error = gf4_array_init(2 * block_size, true);
+        gf4_array_t syndrome = gf4_array_init(block_size, true);
+        for (size_t i = 0; i < num_errors; ++i) {
+            error.array[positions[i]] = values[i];
+        }
+        dec_calculate_syndrome(&syndrome, &error, &dc);
+        gjs_support_t e0 = gjs_support_init(block_size);
+        gjs_support_t e1 = gjs_support_init(block_size);
+        gjs_support_from_array(&e0, &error, 0, block_size);
+        gjs_support_from_array(&e1, &error, block_size, block_size);
+        bool * written_to = calloc(GJS_NUM_CLASSES * expected.num_distances, sizeof(bool));
+        gjs_spectrum_add_sample(&expected, &e0, &e1, gf4_array_hamming_weight(&syndrome), written_to);
+        assert(1 == spectrum.num_samples);
+        for (size_t i = 0; i < GJS_NUM_CLASSES * spectrum.num_distances; ++i) {
+            assert(expected.weights[i] == spectrum.weights[i]);
+            assert(expected.attempts[i] == spectrum.attempts[i]);
+        }
+
+        // cleanup
+        free(written_to);
+        gjs_support_deinit(&e1);
+        gjs_support_deinit(&e0);
+        gf4_array_deinit(&syndrome);
+        gf4_array_deinit(&error);
+        gjs_spectrum_deinit(&expected);
+        gjs_spectrum_deinit(&spectrum);
+        gf4_poly_deinit(&dc.h0);
+        gf4_poly_deinit(&dc.h1);
+        test_print_OK();
+    }
+}
+
+void test_gjs_spectrum_save_load() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        const size_t block_size = 53;
+        const size_t num_errors = 10;
+        const char * first_filename = "test_gjs_spectrum_1.bin";
+        const char * second_filename = "test_gjs_spectrum_2.bin";
+        decoding_context_t dc, other_dc;
+        test_gjs_random_key(&dc, block_size, 7);
+        test_gjs_random_key(&other_dc, block_size, 7);
+        gf4_poly_set_coefficient(&other_dc.h1, 0, gf4_poly_get_coefficient(&dc.h1, 0) ^ 1);
+        uint64_t fingerprint = gjs_key_fingerprint(&dc);
+        assert(fingerprint != gjs_key_fingerprint(&other_dc));
+        gjs_spectrum_t first, second, whole, loaded, other;
+        gjs_spectrum_init(&first, block_size, num_errors, fingerprint);
+        gjs_spectrum_init(&second, block_size, num_errors, fingerprint);
+        gjs_spectrum_init(&whole, block_size, num_errors, fingerprint);
+        gjs_spectrum_init(&other, block_size, num_errors, gjs_key_fingerprint(&other_dc));
+        gjs_collect(&first, &dc, 9, 0, 30, 2);
+        gjs_collect(&second, &dc, 9, 30, 70, 1);
+        gjs_collect(&whole, &dc, 9, 0, 70, 1);
+
+        // test: saved spectra of two sample ranges load and merge into the spectrum of the whole range
+        gjs_spectrum_save(first_filename, &first);
+        gjs_spectrum_save(second_filename, &second);
+        gjs_spectrum_load(first_filename, &loaded);
+        assert(block_size == loaded.block_size);
+        assert(num_errors == loaded.num_errors);
+        assert(fingerprint == loaded.key_fingerprint);
+        assert(30 == loaded.num_samples);
+        assert(1 == loaded.num_ranges);
+        assert(9 == loaded.ranges[0].seed && 0 == loaded.ranges[0].sample_begin && 30 == loaded.ranges[0].sample_end);
+        gjs_spectrum_t loaded_second;
+        gjs_spectrum_load(second_filename, &loaded_second);
+        bool merged = gjs_spectrum_merge(&loaded, &loaded_second);
+        assert(merged);
+        assert(70 == loaded.num_samples);
+        assert(1 == loaded.num_ranges);
+        assert(0 == loaded.ranges[0].sample_begin && 70 == loaded.ranges[0].sample_end);
+        for (size_t i = 0; i < GJS_NUM_CLASSES * whole.num_distances; ++i) {
+            assert(whole.weights[i] == loaded.weights[i]);
+            assert(whole.attempts[i] == loaded.attempts[i]);
+            assert(whole.squares[i] == loaded.squares[i]);
+        }
+
+        // test: spectra of different keys are not merged
+        merged = gjs_spectrum_merge(&loaded, &other);
+        assert(!merged);
+        assert(70 == loaded.num_samples);
+
+        // test: samples of a seed are not merged twice, samples of another seed are added as a new range
+        merged = gjs_spectrum_merge(&loaded, &second);
+        assert(!merged);
+        assert(70 == loaded.num_samples);
+        assert(1 == loaded.num_ranges);
+        gjs_spectrum_t reseeded;
+        gjs_spectrum_init(&reseeded, block_size, num_errors, fingerprint);
+        gjs_collect(&reseeded, &dc, 4, 10, 20, 1);
+        merged = gjs_spectrum_merge(&loaded, &reseeded);
+        assert(merged);
+        (void)merged;
+        assert(80 == loaded.num_samples);
+        assert(2 == loaded.num_ranges);
+        assert(4 == loaded.ranges[0].seed && 10 == loaded.ranges[0].sample_begin && 20 == loaded.ranges[0].sample_end);
+        assert(9 == loaded.ranges[1].seed);
+        gjs_spectrum_save(first_filename, &loaded);
+        gjs_spectrum_deinit(&reseeded);
+        gjs_spectrum_load(first_filename, &reseeded);
+        assert(80 == reseeded.num_samples);
+        assert(2 == reseeded.num_ranges);
+        assert(0 == memcmp(loaded.ranges, reseeded.ranges, 2 * sizeof(gjs_sample_range_t)));
+
+        // cleanup
+        remove(first_filename);
+        remove(second_filename);
+        gjs_spectrum_deinit(&reseeded);
+        gjs_spectrum_deinit(&loaded_second);
+        gjs_spectrum_deinit(&loaded);
+        gjs_spectrum_deinit(&other);
+        gjs_spectrum_deinit(&whole);
+        gjs_spectrum_deinit(&second);
+        gjs_spectrum_deinit(&first);
+        gf4_poly_deinit(&other_dc.h0);
+        gf4_poly_deinit(&other_dc.h1);
+        gf4_poly_deinit(&dc.h0);
+        gf4_poly_deinit(&dc.h1);
+        test_print_OK();
+    }
+}
+
+void test_gjs_multiplicities_h0() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup
+        decoding_context_t dc;
+        dc.block_size = 11;
+        dc.arena = NULL;
+        dc.h0 = gf4_poly_init_zero(dc.block_size);
+        dc.h1 = gf4_poly_init_zero(dc.block_size);
+        gf4_poly_set_coefficient(&dc.h0, 0, 1);
+        gf4_poly_set_coefficient(&dc.h0, 1, 1);
+        gf4_poly_set_coefficient(&dc.h0, 3, 2);
+        gf4_poly_set_coefficient(&dc.h0, 10, 3);
+        size_t same[6], different[6];
+        const size_t expected_same[6] = {0, 1, 0, 0, 0, 0};
+        // pairs (0, 10) and (1, 10) wrap around to distances 1 and 2
+        const size_t expected_different[6] = {0, 1, 2, 1, 1, 0};
+
+        // test
+        gjs_multiplicities_h0(&dc, same, different);
+        for (size_t d = 1; d < 6; ++d) {
+            assert(expected_same[d] == same[d]);
+            assert(expected_different[d] == different[d]);
+        }
+        (void)expected_same; (void)expected_different;
+
+        // cleanup
+        gf4_poly_deinit(&dc.h0);
+        gf4_poly_deinit(&dc.h1);
+        test_print_OK();
+    }
+}
+
+// store n samples with the given mean and variance 1 to a class and distance of a spectrum
+static void test_gjs_set_distance(gjs_spectrum_t * spectrum, size_t class_index, size_t distance, uint64_t n, double mean) {
+    size_t idx = class_index * spectrum->num_distances + distance;
+    spectrum->attempts[idx] = n;
+    spectrum->weights[idx] = (uint64_t)llround(mean * (double)n);
+    spectrum->squares[idx] = (uint64_t)llround(mean * mean * (double)n) + (n - 1);
+}
+
+void test_gjs_classify() {
+    fprintf(stderr, "%s: \n", __func__);
+    {
+        test_print_test_number_str("1");
+        // setup: multiplicities of distance d are d % 4 (same) and (d / 4) % 4 (different), 55 pairs in total,
+        // means are 100 - 2 * m_same - m_different (same) and 100 - 0.5 * m_same - 2 * m_different (different)
+        gjs_spectrum_t spectrum;
+        gjs_spectrum_init(&spectrum, 41, 10, 0);
+        size_t multiplicities_same[21], multiplicities_different[21];
+        size_t * multiplicities[2] = {multiplicities_same, multiplicities_different};
+        for (size_t d = 1; d < spectrum.num_distances; ++d) {
+            multiplicities_same[d] = d % 4;
+            multiplicities_different[d] = (d / 4) % 4;
+            test_gjs_set_distance(&spectrum, gjs_class_index(GJS_RELATION_SAME, 0), d, 100,
+                                  100.0 - 2.0 * (double)multiplicities_same[d] - 1.0 * (double)multiplicities_different[d]);
+            test_gjs_set_distance(&spectrum, gjs_class_index(GJS_RELATION_ALPHA_RIGHT, 0), d, 100,
+                                  100.0 - 0.5 * (double)multiplicities_same[d] - 2.0 * (double)multiplicities_different[d]);
+        }
+        gjs_classification_t classification;
+        gjs_classification_init(&classification, spectrum.num_distances);
+        double z = gjs_confidence_z(0.95);
+        assert(fabs(z - SIM_WILSON_Z) < 1e-9);
+
+        // test: levels fitted without the key are exact, standard errors 0.1 --> everything classified correctly
+        bool done = gjs_classify(&classification, &spectrum, 55, multiplicities, z);
+        assert(done);
+        assert(fabs(classification.level_zero[GJS_SERIES_SAME] - 100.0) < 1e-9);
+        assert(fabs(classification.level_step[GJS_SERIES_SAME][GJS_SERIES_SAME] - 2.0) < 1e-9);
+        assert(fabs(classification.level_step[GJS_SERIES_SAME][GJS_SERIES_DIFFERENT] - 1.0) < 1e-9);
+        assert(fabs(classification.level_zero[GJS_SERIES_DIFFERENT] - 100.0) < 1e-9);
+        assert(fabs(classification.level_step[GJS_SERIES_DIFFERENT][GJS_SERIES_SAME] - 0.5) < 1e-9);
+        assert(fabs(classification.level_step[GJS_SERIES_DIFFERENT][GJS_SERIES_DIFFERENT] - 2.0) < 1e-9);
+        for (size_t series = 0; series < 2; ++series) {
+            assert(20 == classification.num_confident[series]);
+            assert(0 == classification.num_wrong[series]);
+            for (size_t d = 1; d < spectrum.num_distances; ++d) {
+                assert(multiplicities[series][d] == classification.estimates[series][d]);
+                assert(classification.confident[series][d]);
+            }
+        }
+
+        // test: a previous fit is refined only, EM started from the lattice of half the steps ends in a worse fit,
+        // which is kept if the previous fit was not better
+        double log_likelihood = classification.log_likelihood;
+        double level_step[2][2];
+        for (size_t series = 0; series < 2; ++series) {
+            level_step[series][0] = classification.level_step[series][0] / 2.0;
+            level_step[series][1] = classification.level_step[series][1] / 2.0;
+        }
+        memcpy(classification.level_step, level_step, sizeof(level_step));
+        classification.log_likelihood = -1e6;
+        done = gjs_classify(&classification, &spectrum, 55, multiplicities, z);
+        assert(!done);
+        assert(classification.log_likelihood < 2.0 * log_likelihood);
+
+        // test: a refined fit explaining the means worse than the previous one is restarted from several steps
+        memcpy(classification.level_step, level_step, sizeof(level_step));
+        classification.log_likelihood = log_likelihood;
+        done = gjs_classify(&classification, &spectrum, 55, multiplicities, z);
+        assert(done);
+        assert(fabs(classification.level_step[GJS_SERIES_SAME][GJS_SERIES_SAME] - 2.0) < 1e-9);
+        assert(fabs(classification.level_step[GJS_SERIES_DIFFERENT][GJS_SERIES_DIFFERENT] - 2.0) < 1e-9);
+        assert(fabs(classification.log_likelihood - log_likelihood) < 1e-9);
+
+        // test: a mean close to the border is not confident, a mean of another level is confident but wrong
+        test_gjs_set_distance(&spectrum, gjs_class_index(GJS_RELATION_SAME, 0), 5, 100, 96.0);
+        test_gjs_set_distance(&spectrum, gjs_class_index(GJS_RELATION_SAME, 0), 6, 100, 93.0);
+        done = gjs_classify(&classification, &spectrum, 55, multiplicities, z);
+        assert(!done);
+        assert(!classification.confident[GJS_SERIES_SAME][5]); // on the border of classes 1 and 2
+        assert(3 == classification.estimates[GJS_SERIES_SAME][6]);
+        assert(classification.confident[GJS_SERIES_SAME][6]);
+        assert(19 == classification.num_confident[GJS_SERIES_SAME]);
+        assert(1 == classification.num_wrong[GJS_SERIES_SAME]);
+        assert(20 == classification.num_confident[GJS_SERIES_DIFFERENT]);
+        assert(0 == classification.num_wrong[GJS_SERIES_DIFFERENT]);
+
+        // test: without the key the same distances are classified, no wrong ones are counted
+        done = gjs_classify(&classification, &spectrum, 55, NULL, z);
+        assert(!done);
+        assert(3 == classification.estimates[GJS_SERIES_SAME][6]);
+        assert(19 == classification.num_confident[GJS_SERIES_SAME]);
+        assert(0 == classification.num_wrong[GJS_SERIES_SAME]);
+        assert(20 == classification.num_confident[GJS_SERIES_DIFFERENT]);
+        assert(0 == classification.num_wrong[GJS_SERIES_DIFFERENT]);
+
+        // test: no samples --> nothing classified
+        gjs_spectrum_t empty;
+        gjs_spectrum_init(&empty, 41, 10, 0);
+        done = gjs_classify(&classification, &empty, 55, multiplicities, z);
+        assert(!done);
+        (void)done;
+        assert(0 == classification.num_confident[GJS_SERIES_SAME]);
+        assert(0 == classification.num_confident[GJS_SERIES_DIFFERENT]);
+
+        // cleanup
+        gjs_spectrum_deinit(&empty);
+        gjs_classification_deinit(&classification);
+        gjs_spectrum_deinit(&spectrum);
+        test_print_OK();
+    }
+}
+
 // test runner
 void run_unit_tests() {
     void (*tests_list[])() = {
@@ -1676,6 +3791,7 @@ void run_unit_tests() {
             test_gf4_mul,
             test_gf4_div,
             test_gf4_array_hamming_weight,
+            test_gf4_array_init_in,
             test_gf4_poly_init_zero,
             test_gf4_poly_zero_out,
             test_gf4_poly_deinit,
@@ -1689,6 +3805,7 @@ void run_unit_tests() {
             test_gf4_poly_div_x_to_deg_inplace,
             test_gf4_poly_div_rem,
             test_gf4_poly_invert_slow,
+            test_gf4_poly_workspace,
             test_gf4_poly_is_zero,
             test_gf4_poly_equal,
             test_gf4_poly_cyclic_shift_right_inplace,
@@ -1697,13 +3814,43 @@ void run_unit_tests() {
             test_gf4_poly_clone,
             test_gf4_poly_copy,
             test_gf4_square_matrix_init_cyclic_matrix,
+            test_gf4_matrix_storage,
+            test_gf4_matrix_select,
+            test_gf4_circulant_select,
             test_gf4_matrix_gaussian_elimination_inplace,
+            test_gf4_matrix_gaussian_elimination_m4rm_inplace,
+            test_gf4_matrix_gaussian_elimination_parallel_inplace,
+            test_gf4_matrix_nullspace,
+            test_gf4_matrix_kernel_solver,
             test_gf4_matrix_solve_homogenous_linear_system,
             test_contexts_init,
             test_contexts_save_load,
+            test_contexts_binary,
+            test_contexts_seed,
+            test_contexts_invertibility_precheck,
+            test_contexts_init_batch,
+            test_keypool,
             test_enc_encode,
             test_enc_encrypt,
-            test_dec_calculate_syndrome
+            test_enc_add_error,
+            test_dec_calculate_syndrome,
+            test_dec_arena,
+            test_random_seed,
+            test_random_error_positions,
+            test_sim_parse_shard,
+            test_sim_shard_range,
+            test_sim_result_save_load_merge,
+            test_sim_checkpoint_resume,
+            test_sim_wilson_interval,
+            test_sweep_parse,
+            test_report_sink,
+            test_corpus,
+            test_gjs_syndrome,
+            test_gjs_spectrum_add_sample,
+            test_gjs_collect,
+            test_gjs_spectrum_save_load,
+            test_gjs_multiplicities_h0,
+            test_gjs_classify
     };
     size_t num_tests = sizeof(tests_list) / sizeof(tests_list[0]);
     for (size_t i = 0; i < num_tests; ++i) {
@@ -26,6 +26,7 @@
 #ifndef MDPC_GF4_TESTS_H
 #define MDPC_GF4_TESTS_H
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "dec.h"
@@ -36,6 +37,12 @@
 #include "gf4_poly.h"
 #include "gf4_matrix.h"
 #include "random.h"
+#include "sim.h"
+#include "sweep.h"
+#include "report.h"
+#include "corpus.h"
+#include "keypool.h"
+#include "gjs.h"
 #include "utils.h"
 
 // TESTS
@@ -48,6 +55,7 @@ void test_gf4_div();
 
 // array
 void test_gf4_array_hamming_weight();
+void test_gf4_array_init_in();
 
 // poly
 void test_gf4_poly_init_zero();
@@ -63,6 +71,7 @@ void test_gf4_poly_div_x_to_deg();
 void test_gf4_poly_div_x_to_deg_inplace();
 void test_gf4_poly_div_rem();
 void test_gf4_poly_invert_slow();
+void test_gf4_poly_workspace();
 void test_gf4_poly_is_zero();
 void test_gf4_poly_equal();
 void test_gf4_poly_cyclic_shift_right_inplace();
@@ -73,19 +82,63 @@ void test_gf4_poly_copy();
 
 // gf4_matrix
 void test_gf4_square_matrix_init_cyclic_matrix();
+void test_gf4_matrix_storage();
+void test_gf4_matrix_select();
+void test_gf4_circulant_select();
 void test_gf4_matrix_gaussian_elimination_inplace();
+void test_gf4_matrix_gaussian_elimination_m4rm_inplace();
+void test_gf4_matrix_gaussian_elimination_parallel_inplace();
+void test_gf4_matrix_nullspace();
+void test_gf4_matrix_kernel_solver();
 void test_gf4_matrix_solve_homogenous_linear_system();
 
 // contexts
 void test_contexts_init();
 void test_contexts_save_load();
+void test_contexts_binary();
+void test_contexts_seed();
+void test_contexts_invertibility_precheck();
+void test_contexts_init_batch();
+
+// keypool
+void test_keypool();
 
 // enc
 void test_enc_encode();
 void test_enc_encrypt();
+void test_enc_add_error();
 
 // dec
 void test_dec_calculate_syndrome();
+void test_dec_arena();
+
+// random
+void test_random_seed();
+void test_random_error_positions();
+
+// sim
+void test_sim_parse_shard();
+void test_sim_shard_range();
+void test_sim_result_save_load_merge();
+void test_sim_checkpoint_resume();
+void test_sim_wilson_interval();
+
+// sweep
+void test_sweep_parse();
+
+// report
+void test_report_sink();
+
+// corpus
+void test_corpus();
+
+// gjs
+void test_gjs_syndrome();
+void test_gjs_spectrum_add_sample();
+void test_gjs_collect();
+void test_gjs_spectrum_save_load();
+void test_gjs_multiplicities_h0();
+void test_gjs_classify();
 
 
 // test runner
@@ -60,6 +60,8 @@ void utils_get_distance_multiplicities_h0(size_t ** multiplicities_same_symbols,
             last_index_diff_symbols[current_diff_symbols_dist] += 1;
         }
     }
+    free(same_symbols_dists);
+    free(diff_symbols_dists);
 }
 
 size_t utils_binary_pow(size_t x, size_t n) {
@@ -34,5 +34,7 @@ void utils_get_distance_multiplicities_h0(size_t ** multiplicities_same_symbols,
 size_t utils_binary_pow(size_t x, size_t n);
 
 #define UTILS_SUBTRACT_OR_ZERO(a, b) ((a >= b) ? (a - b) : 0)
+#define UTILS_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define UTILS_MAX(a, b) (((a) > (b)) ? (a) : (b))
 
 #endif //MDPC_GF4_UTILS_H